@@ -12,7 +12,7 @@
  *        and use that to determine when to loop back over existing textures
  *      - to do this maybe use a circular linked list instead of a flat array
  *      - then have a way of querying how many frames are available for a specific point count
- * [ ]: bug: reinit cuda on hot-reload
+ * [ ]: bug: reinit external stages on hot-reload
  */
 
 #include "beamformer.h"
@@ -21,6 +21,13 @@
 global f32 dt_for_frame;
 global u32 cycle_t;
 
+/* NOTE(rnp): number of frames a running sum is updated incrementally before resumming */
+#define SUM_RUNNING_RESUM_INTERVAL 256
+
+/* NOTE(rnp): how long the compute thread waits on an in flight frame before checking
+ * for new work to submit behind it */
+#define COMPUTE_RETIRE_POLL_NS 1000000ull
+
 #ifndef _DEBUG
 #define start_renderdoc_capture(...)
 #define end_renderdoc_capture(...)
@@ -39,6 +46,34 @@ typedef struct {
 	u32 needed_frames;
 } ComputeFrameIterator;
 
+/* NOTE(rnp): spectrum of the filter delayed by one sample, the direct form filter computes
+ * y[n] = sum h[j] x[n - 1 - j]. this only runs when a filter is created so a direct DFT
+ * is plenty. the 1/N scale of the inverse transform is folded in here */
+function f32 *
+filter_fft_spectrum(Arena *arena, f32 *filter, i32 length)
+{
+	f32 *result  = push_array(arena, f32, 2 * FILTER_FFT_SIZE);
+	f32 *twiddle = push_array(arena, f32, 2 * FILTER_FFT_SIZE);
+	for (i32 i = 0; i < FILTER_FFT_SIZE; i++) {
+		f32 arg = -2.0f * PI * (f32)i / (f32)FILTER_FFT_SIZE;
+		twiddle[2 * i + 0] = cos_f32(arg);
+		twiddle[2 * i + 1] = sin_f32(arg);
+	}
+
+	f32 scale = 1.0f / (f32)FILTER_FFT_SIZE;
+	for (i32 k = 0; k < FILTER_FFT_SIZE; k++) {
+		f32 re = 0, im = 0;
+		for (i32 m = 1; m <= length; m++) {
+			i32 index = (k * m) & (FILTER_FFT_SIZE - 1);
+			re += filter[m - 1] * twiddle[2 * index + 0];
+			im += filter[m - 1] * twiddle[2 * index + 1];
+		}
+		result[2 * k + 0] = re * scale;
+		result[2 * k + 1] = im * scale;
+	}
+	return result;
+}
+
 function void
 beamformer_filter_update(BeamformerFilter *f, BeamformerFilterKind kind,
                          BeamformerFilterParameters fp, Arena arena)
@@ -63,6 +98,15 @@ beamformer_filter_update(BeamformerFilter *f, BeamformerFilterKind kind,
 	f->kind       = kind;
 	f->parameters = fp;
 	glTextureSubImage1D(f->texture, 0, 0, fp.length, GL_RED, GL_FLOAT, filter);
+
+	glDeleteTextures(1, &f->spectrum_texture);
+	f->spectrum_texture = 0;
+	if (BETWEEN(fp.length, FILTER_FFT_MIN_TAPS, FILTER_FFT_MAX_TAPS)) {
+		glCreateTextures(GL_TEXTURE_1D, 1, &f->spectrum_texture);
+		glTextureStorage1D(f->spectrum_texture, 1, GL_RG32F, FILTER_FFT_SIZE);
+		glTextureSubImage1D(f->spectrum_texture, 0, 0, FILTER_FFT_SIZE, GL_RG, GL_FLOAT,
+		                    filter_fft_spectrum(&arena, filter, fp.length));
+	}
 }
 
 function f32
@@ -116,8 +160,34 @@ frame_next(ComputeFrameIterator *bfi)
 	return result;
 }
 
+/* NOTE(rnp): internal format, pixel format, and pixel type of each output format */
+read_only global struct {
+	u32 internal_format;
+	u32 format;
+	u32 type;
+} beamformer_output_format_gl[BeamformerOutputFormat_Count] = {
+	[BeamformerOutputFormat_Complex32]   = {GL_RG32F, GL_RG,  GL_FLOAT},
+	[BeamformerOutputFormat_Complex16]   = {GL_RG16F, GL_RG,  GL_HALF_FLOAT},
+	[BeamformerOutputFormat_Magnitude32] = {GL_R32F,  GL_RED, GL_FLOAT},
+	[BeamformerOutputFormat_Magnitude16] = {GL_R16F,  GL_RED, GL_HALF_FLOAT},
+};
+
+function u32
+beamformer_output_format_voxel_size(BeamformerOutputFormat format)
+{
+	u32 result = 0;
+	switch (format) {
+	#define X(name, id, glsl, size) case BeamformerOutputFormat_##name:{ result = size; }break;
+	BEAMFORMER_OUTPUT_FORMAT_LIST
+	#undef X
+	InvalidDefaultCase;
+	}
+	return result;
+}
+
 function void
-alloc_beamform_frame(GLParams *gp, BeamformerFrame *out, iv3 out_dim, s8 name, Arena arena)
+alloc_beamform_frame(GLParams *gp, BeamformerFrame *out, iv3 out_dim, BeamformerOutputFormat format,
+                     s8 name, Arena arena)
 {
 	out->dim.x = MAX(1, out_dim.x);
 	out->dim.y = MAX(1, out_dim.y);
@@ -142,7 +212,9 @@ alloc_beamform_frame(GLParams *gp, BeamformerFrame *out, iv3 out_dim, s8 name, A
 
 	glDeleteTextures(1, &out->texture);
 	glCreateTextures(GL_TEXTURE_3D, 1, &out->texture);
-	glTextureStorage3D(out->texture, out->mips, GL_RG32F, out->dim.x, out->dim.y, out->dim.z);
+	glTextureStorage3D(out->texture, out->mips, beamformer_output_format_gl[format].internal_format,
+	                   out->dim.x, out->dim.y, out->dim.z);
+	out->format = format;
 
 	glTextureParameteri(out->texture, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
 	glTextureParameteri(out->texture, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
@@ -150,33 +222,64 @@ alloc_beamform_frame(GLParams *gp, BeamformerFrame *out, iv3 out_dim, s8 name, A
 	LABEL_GL_OBJECT(GL_TEXTURE, out->texture, stream_to_s8(&label));
 }
 
+function iv3
+beamform_frame_level_dim(BeamformerFrame *frame, i32 level)
+{
+	iv3 result;
+	result.x = MAX(1, frame->dim.x >> level);
+	result.y = MAX(1, frame->dim.y >> level);
+	result.z = MAX(1, frame->dim.z >> level);
+	return result;
+}
+
 function void
 alloc_shader_storage(BeamformerCtx *ctx, u32 rf_raw_size, Arena a)
 {
 	ComputeShaderCtx     *cs = &ctx->csctx;
 	BeamformerParameters *bp = &((BeamformerSharedMemory *)ctx->shared_memory.region)->parameters;
 
-	cs->dec_data_dim = uv4_from_u32_array(bp->dec_data_dim);
-	cs->rf_raw_size  = rf_raw_size;
+	cs->dec_data_dim    = uv4_from_u32_array(bp->dec_data_dim);
+	cs->rf_raw_size     = rf_raw_size;
+	cs->das_input_valid = 0;
 
-	glDeleteBuffers(ARRAY_COUNT(cs->rf_data_ssbos), cs->rf_data_ssbos);
-	glCreateBuffers(ARRAY_COUNT(cs->rf_data_ssbos), cs->rf_data_ssbos);
+	/* NOTE(rnp): every set is laid out contiguously; set i, buffer j is index 2 * i + j */
+	u32 *rf_data_ssbos      = cs->rf_data_ssbos[0];
+	u32  rf_data_ssbo_count = (u32)(countof(cs->rf_data_ssbos) * countof(cs->rf_data_ssbos[0]));
+	glDeleteBuffers((i32)rf_data_ssbo_count, rf_data_ssbos);
+	glCreateBuffers((i32)rf_data_ssbo_count, rf_data_ssbos);
 
-	uz rf_decoded_size = 2 * sizeof(f32) * cs->dec_data_dim.x * cs->dec_data_dim.y * cs->dec_data_dim.z;
+	uz sample_size     = cs->rf_data_half ? sizeof(u32) : 2 * sizeof(f32);
+	uz rf_decoded_size = sample_size * cs->dec_data_dim.x * cs->dec_data_dim.y * cs->dec_data_dim.z;
 	Stream label = arena_stream(a);
 	stream_append_s8(&label, s8("Decoded_RF_SSBO_"));
 	i32 s_widx = label.widx;
-	for (i32 i = 0; i < countof(cs->rf_data_ssbos); i++) {
-		glNamedBufferStorage(cs->rf_data_ssbos[i], (iz)rf_decoded_size, 0, 0);
-		stream_append_i64(&label, i);
-		LABEL_GL_OBJECT(GL_BUFFER, cs->rf_data_ssbos[i], stream_to_s8(&label));
+	for (u32 i = 0; i < rf_data_ssbo_count; i++) {
+		glNamedBufferStorage(rf_data_ssbos[i], (iz)rf_decoded_size, 0, 0);
+		stream_append_u64(&label, i);
+		LABEL_GL_OBJECT(GL_BUFFER, rf_data_ssbos[i], stream_to_s8(&label));
 		stream_reset(&label, s_widx);
 	}
 
-	/* NOTE(rnp): these are stubs when CUDA isn't supported */
+	ExternalStageLib *esl = &cs->external_stages;
+	if (esl->backend == ExternalStageBackend_CPU) {
+		glDeleteBuffers(1, &cs->external_staging_buffer);
+		glCreateBuffers(1, &cs->external_staging_buffer);
+
+		u32 flags = GL_MAP_READ_BIT|GL_MAP_WRITE_BIT|GL_MAP_PERSISTENT_BIT|GL_MAP_COHERENT_BIT;
+		iz  size  = 2 * (iz)rf_decoded_size + rf_raw_size;
+		glNamedBufferStorage(cs->external_staging_buffer, size, 0, flags|GL_CLIENT_STORAGE_BIT);
+		LABEL_GL_OBJECT(GL_BUFFER, cs->external_staging_buffer, s8("External_Stage_Staging"));
+		cs->external_staging         = glMapNamedBufferRange(cs->external_staging_buffer, 0, (i32)size, flags);
+		cs->external_staging_rf_size = rf_decoded_size;
+
+		void *rf_data[] = {cs->external_staging, cs->external_staging + rf_decoded_size};
+		esl->register_host_buffers(rf_data, countof(rf_data), cs->external_staging + 2 * rf_decoded_size);
+	}
+
+	/* NOTE(rnp): these are stubs when no external stage backend is available */
 	/* TODO(rnp): cuda should know that there is more than one raw rf ssbo */
-	cs->cuda_lib.register_buffers(cs->rf_data_ssbos, countof(cs->rf_data_ssbos), cs->rf_buffer.ssbo);
-	cs->cuda_lib.init(bp->rf_raw_dim, bp->dec_data_dim);
+	esl->register_buffers(rf_data_ssbos, rf_data_ssbo_count, cs->rf_buffer.ssbo);
+	esl->init(bp->rf_raw_dim, bp->dec_data_dim);
 
 	i32  order    = (i32)cs->dec_data_dim.z;
 	i32 *hadamard = make_hadamard_transpose(&a, order);
@@ -188,6 +291,7 @@ alloc_shader_storage(BeamformerCtx *ctx, u32 rf_raw_size, Arena a)
 		                    GL_INT, hadamard);
 		LABEL_GL_OBJECT(GL_TEXTURE, cs->hadamard_texture, s8("Hadamard_Matrix"));
 	}
+	esl->set_hadamard(hadamard, hadamard ? (u32)order : 0);
 }
 
 function void
@@ -197,6 +301,103 @@ push_compute_timing_info(ComputeTimingTable *t, ComputeTimingInfo info)
 	t->buffer[index] = info;
 }
 
+/* NOTE(rnp): pushes the timings of completed frames in submission order. queries complete
+ * in order so only the end timestamp of a frame's batch needs to be checked. block is only
+ * needed when the ring is full, which means the GPU is more than BEAMFORMER_TIMER_QUERY_FRAMES
+ * behind. frames waiting on an unflushed DAS batch are never collected */
+function void
+collect_compute_timer_queries(BeamformerCtx *ctx, b32 block)
+{
+	ComputeShaderCtx *cs = &ctx->csctx;
+	while (cs->timer_query_frames_collected != cs->timer_query_frames_submitted) {
+		u32 index = cs->timer_query_frames_collected;
+		BeamformerTimerQueryFrame *tqf = cs->timer_query_frames + index % countof(cs->timer_query_frames);
+		if (tqf->batch_count == 0) break;
+
+		u32 last_index = index + tqf->batch_count - 1 - tqf->batch_index;
+		BeamformerTimerQueryFrame *last = cs->timer_query_frames + last_index % countof(cs->timer_query_frames);
+
+		/* NOTE(rnp): nothing ran; there is no frame to record */
+		if (tqf->first_stage < last->shader_count) {
+			if (!block) {
+				u64 available = 0;
+				glGetQueryObjectui64v(last->timestamp_ids[1], GL_QUERY_RESULT_AVAILABLE, &available);
+				if (!available) break;
+			}
+
+			push_compute_timing_info(ctx->compute_timing_table,
+			                         (ComputeTimingInfo){.kind = ComputeTimingInfoKind_ComputeFrameBegin});
+			for (i32 i = tqf->first_stage; i < last->shader_count; i++) {
+				b32 shared = i >= tqf->batch_stage;
+				BeamformerTimerQueryFrame *source = shared ? last : tqf;
+				ComputeTimingInfo info = {0};
+				info.kind   = ComputeTimingInfoKind_Shader;
+				info.shader = source->shaders[i];
+				info.work   = source->stage_work[i];
+				glGetQueryObjectui64v(source->ids[i], GL_QUERY_RESULT, &info.timer_count);
+				if (shared) info.timer_count /= tqf->batch_count;
+				push_compute_timing_info(ctx->compute_timing_table, info);
+			}
+
+			u64 begin = 0, end = 0;
+			glGetQueryObjectui64v(tqf->timestamp_ids[0],  GL_QUERY_RESULT, &begin);
+			glGetQueryObjectui64v(last->timestamp_ids[1], GL_QUERY_RESULT, &end);
+			push_compute_timing_info(ctx->compute_timing_table, (ComputeTimingInfo){
+				.kind        = ComputeTimingInfoKind_ComputeFrameEnd,
+				.timer_count = end > begin ? end - begin : 0,
+			});
+		}
+
+		cs->timer_query_frames_collected++;
+		block = 0;
+	}
+}
+
+/* NOTE(rnp): frames are retired strictly in submission order. the oldest in flight frame
+ * is only retired once its fence has signalled. returns 0 if the timeout expired first */
+function b32
+retire_in_flight_frame(BeamformerCtx *ctx, u64 timeout_ns)
+{
+	ComputeShaderCtx *cs = &ctx->csctx;
+	b32 result = cs->in_flight_frames_retired != cs->in_flight_frames_submitted;
+	if (result) {
+		u32 slot = cs->in_flight_frames_retired % countof(cs->in_flight_frames);
+		BeamformerInFlightFrame *iff = cs->in_flight_frames + slot;
+
+		GLenum sync_result = glClientWaitSync(iff->fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeout_ns);
+		result = sync_result != GL_TIMEOUT_EXPIRED;
+		if (result) {
+			glDeleteSync(iff->fence);
+			collect_compute_timer_queries(ctx, 0);
+
+			for (u32 i = 0; i < iff->batch_frame_count; i++)
+				iff->batch_frames[i]->ready_to_present = 1;
+			/* NOTE(rnp): a cancelled frame was never fully beamformed. whichever of its coarse
+			 * levels was presented last stays up until the next frame replaces it */
+			iff->frame->ready_to_present = !iff->cancelled;
+			if (iff->averaged_frame) {
+				iff->averaged_frame->view_plane_tag   = iff->frame->view_plane_tag;
+				iff->averaged_frame->ready_to_present = 1;
+				atomic_store_u64((u64 *)&ctx->latest_frame, (u64)iff->averaged_frame);
+			} else if (!iff->cancelled) {
+				atomic_store_u64((u64 *)&ctx->latest_frame, (u64)iff->frame);
+			}
+
+			if (++cs->in_flight_frames_retired == cs->in_flight_frames_submitted) {
+				cs->processing_progress = 1;
+				cs->processing_compute  = 0;
+			}
+		}
+	}
+	return result;
+}
+
+function void
+retire_all_in_flight_frames(BeamformerCtx *ctx)
+{
+	while (retire_in_flight_frame(ctx, (u64)-1));
+}
+
 function b32
 fill_frame_compute_work(BeamformerCtx *ctx, BeamformWork *work, BeamformerViewPlaneTag plane, b32 indirect)
 {
@@ -215,6 +416,21 @@ fill_frame_compute_work(BeamformerCtx *ctx, BeamformWork *work, BeamformerViewPl
 	return result;
 }
 
+/* NOTE: out = out_scale * out + in_scale * in; output must already be bound to image 0 */
+function void
+do_sum_dispatch(ComputeShaderCtx *cs, u32 in_texture, f32 in_scale, f32 out_scale, iv3 out_data_dim)
+{
+	u32 program = cs->programs[BeamformerShaderKind_Sum];
+	glProgramUniform1f(program, SUM_PRESCALE_UNIFORM_LOC,  in_scale);
+	glProgramUniform1f(program, SUM_OUT_SCALE_UNIFORM_LOC, out_scale);
+	glBindImageTexture(1, in_texture, 0, GL_TRUE, 0, GL_READ_ONLY,
+	                   beamformer_output_format_gl[cs->output_format].internal_format);
+	glDispatchCompute(ORONE((u32)out_data_dim.x / 32u),
+	                  ORONE((u32)out_data_dim.y),
+	                  ORONE((u32)out_data_dim.z / 32u));
+	glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+}
+
 function void
 do_sum_shader(ComputeShaderCtx *cs, u32 *in_textures, u32 in_texture_count, f32 in_scale,
               u32 out_texture, iv3 out_data_dim)
@@ -223,15 +439,10 @@ do_sum_shader(ComputeShaderCtx *cs, u32 *in_textures, u32 in_texture_count, f32
 	glClearTexImage(out_texture, 0, GL_RED, GL_FLOAT, 0);
 	glMemoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT);
 
-	glBindImageTexture(0, out_texture, 0, GL_TRUE, 0, GL_READ_WRITE, GL_RG32F);
-	glProgramUniform1f(cs->programs[BeamformerShaderKind_Sum], SUM_PRESCALE_UNIFORM_LOC, in_scale);
-	for (u32 i = 0; i < in_texture_count; i++) {
-		glBindImageTexture(1, in_textures[i], 0, GL_TRUE, 0, GL_READ_ONLY, GL_RG32F);
-		glDispatchCompute(ORONE((u32)out_data_dim.x / 32u),
-		                  ORONE((u32)out_data_dim.y),
-		                  ORONE((u32)out_data_dim.z / 32u));
-		glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
-	}
+	glBindImageTexture(0, out_texture, 0, GL_TRUE, 0, GL_READ_WRITE,
+	                   beamformer_output_format_gl[cs->output_format].internal_format);
+	for (u32 i = 0; i < in_texture_count; i++)
+		do_sum_dispatch(cs, in_textures[i], in_scale, 1.0f, out_data_dim);
 }
 
 struct compute_cursor {
@@ -300,8 +511,193 @@ compute_cursor_finished(struct compute_cursor *cursor)
 	return result;
 }
 
+function i32
+compute_pipeline_das_stage(BeamformerComputePipeline *cp)
+{
+	i32 result = -1;
+	for (i32 i = 0; result == -1 && i < cp->shader_count; i++) {
+		switch (cp->shaders[i]) {
+		case BeamformerShaderKind_DAS:
+		case BeamformerShaderKind_DASFast:
+		case BeamformerShaderKind_DASFastDelayTables:
+		case BeamformerShaderKind_DASFastTiled:
+		{
+			result = i;
+		}break;
+		default:{}break;
+		}
+	}
+	return result;
+}
+
+/* NOTE(rnp): same orders as make_hadamard_transpose; the matrix must be a natural order
+ * Sylvester matrix, optionally kronecker'd with the 12x12 or 20x20 base matrix */
+function b32
+decode_fwht_supported(u32 order)
+{
+	b32 result = order > 0 && order <= DECODE_FWHT_MAX_TRANSMITS;
+	if (result) {
+		result = ISPOWEROF2(order) ||
+		         (order % 20 == 0 && ISPOWEROF2(order / 20)) ||
+		         (order % 12 == 0 && ISPOWEROF2(order / 12));
+	}
+	return result;
+}
+
+/* NOTE(rnp): returns the zero padded line length or 0 if the line doesn't fit */
+function u32
+hilbert_fft_size(GLParams *gl, u32 samples)
+{
+	u32 result = round_up_power_of_2(MAX(2, samples));
+	if (result > HILBERT_FFT_MAX_SIZE || HILBERT_FFT_MAX_SIZE * 2 * sizeof(f32) > (u32)gl->max_shared_memory_size)
+		result = 0;
+	return result;
+}
+
+function b32
+fft_size_supported(u32 size)
+{
+	b32 result = ISPOWEROF2(size) && BETWEEN(size, 2, FFT_MAX_SIZE);
+	return result;
+}
+
+/* NOTE(rnp): delays are 16.16 fixed point and apodization is fp16 packed in channel pairs
+ * (see shaders/das.glsl). the receive table takes 6 bytes per entry instead of 8 */
 function void
-plan_compute_pipeline(SharedMemoryRegion *os_sm, BeamformerComputePipeline *cp, BeamformerFilter *filters)
+das_delay_table_sizes(BeamformerParameters *bp, uz sizes[3])
+{
+	iv3 dim    = make_valid_test_dim(bp->output_points);
+	uz  voxels = (uz)dim.x * (uz)dim.y * (uz)dim.z;
+	sizes[0] = voxels * bp->dec_data_dim[2] * sizeof(i32);
+	sizes[1] = voxels * bp->dec_data_dim[1] * sizeof(i32);
+	sizes[2] = voxels * ((bp->dec_data_dim[1] + 1) / 2) * sizeof(u32);
+}
+
+function b32
+das_delay_tables_supported(GLParams *gl, BeamformerParameters *bp)
+{
+	b32 result = 0;
+	switch (bp->das_shader_id) {
+	case DASShaderKind_FORCES:
+	case DASShaderKind_UFORCES:
+	case DASShaderKind_FLASH:
+	case DASShaderKind_RCA_TPW:
+	case DASShaderKind_RCA_VLS:
+	{
+		/* NOTE(rnp): longer records can't be addressed by the fixed point delays */
+		uz sizes[3];
+		das_delay_table_sizes(bp, sizes);
+		result = bp->dec_data_dim[0] <= DAS_DELAY_TABLES_MAX_SAMPLES &&
+		         sizes[0] <= (uz)gl->max_ssbo_size && sizes[1] <= (uz)gl->max_ssbo_size &&
+		         sizes[2] <= (uz)gl->max_ssbo_size &&
+		         sizes[0] + sizes[1] + sizes[2] <= DAS_DELAY_TABLES_MAX_SIZE;
+	}break;
+	default:{}break;
+	}
+	return result;
+}
+
+/* NOTE(rnp): each stage is assumed to read its whole input and write its whole output
+ * exactly once. caching, the FFT passes, and the fast DAS paths' accumulator traffic are
+ * not modelled so the derived bandwidths are lower bounds */
+function void
+plan_compute_stage_work(BeamformerComputePipeline *cp, BeamformerDataKind data_kind, u32 input_samples)
+{
+	read_only local_persist u32 data_kind_size[] = {
+		[BeamformerDataKind_Int16]          = 2,
+		[BeamformerDataKind_Int16Complex]   = 4,
+		[BeamformerDataKind_Float32]        = 4,
+		[BeamformerDataKind_Float32Complex] = 8,
+	};
+
+	BeamformerParameters *bp = &cp->das_ubo_data;
+	iv3 dim = make_valid_test_dim(bp->output_points);
+
+	f32 rf_samples  = (f32)bp->dec_data_dim[0] * (f32)bp->dec_data_dim[1] * (f32)bp->dec_data_dim[2];
+	f32 samples     = (f32)input_samples;
+	f32 bytes       = samples * (f32)data_kind_size[CLAMP(data_kind, 0, countof(data_kind_size) - 1)];
+	f32 voxels      = (f32)dim.x * (f32)dim.y * (f32)dim.z;
+	f32 voxel_bytes = voxels * (f32)beamformer_output_format_voxel_size(cp->output_format);
+
+	f32 mip_voxels = 0;
+	while (dim.x > 1 || dim.y > 1 || dim.z > 1) {
+		dim.x = MAX(1, dim.x / 2);
+		dim.y = MAX(1, dim.y / 2);
+		dim.z = MAX(1, dim.z / 2);
+		mip_voxels += (f32)dim.x * (f32)dim.y * (f32)dim.z;
+	}
+
+	for (i32 i = 0; i < cp->shader_count; i++) {
+		BeamformerComputeStageMetrics *w = cp->stage_work + i;
+		mem_clear(w, 0, sizeof(*w));
+		switch (cp->shaders[i]) {
+		case BeamformerShaderKind_CudaDecode:
+		case BeamformerShaderKind_Decode:
+		case BeamformerShaderKind_DecodeInt16Complex:
+		case BeamformerShaderKind_DecodeFloat:
+		case BeamformerShaderKind_DecodeFloatComplex:
+		case BeamformerShaderKind_DecodeInt16ToFloat:
+		case BeamformerShaderKind_DecodeFWHT:
+		case BeamformerShaderKind_DecodeFWHTInt16Complex:
+		case BeamformerShaderKind_DecodeFWHTFloat:
+		case BeamformerShaderKind_DecodeFWHTFloatComplex:
+		case BeamformerShaderKind_DecodeFWHTInt16ToFloat:
+		{
+			w->samples    = samples;
+			w->bytes_read = bytes;
+			/* NOTE(rnp): decoding ahead of demodulation leaves the samples real */
+			if (samples != rf_samples) bytes = samples * (cp->rf_data_half ? 2 : 4);
+			else                       bytes = (f32)cp->rf_size;
+			w->bytes_written = bytes;
+		}break;
+		case BeamformerShaderKind_Demodulate:
+		case BeamformerShaderKind_DemodulateFloat:
+		case BeamformerShaderKind_Filter:
+		case BeamformerShaderKind_FilterFFT:
+		case BeamformerShaderKind_CudaHilbert:
+		case BeamformerShaderKind_Hilbert:
+		case BeamformerShaderKind_HilbertBatchedFFT:
+		{
+			w->samples       = samples;
+			w->bytes_read    = bytes;
+			samples          = rf_samples;
+			bytes            = (f32)cp->rf_size;
+			w->bytes_written = bytes;
+		}break;
+		case BeamformerShaderKind_DAS:
+		case BeamformerShaderKind_DASFast:
+		case BeamformerShaderKind_DASFastDelayTables:
+		case BeamformerShaderKind_DASFastTiled:
+		{
+			w->samples        = samples;
+			w->bytes_read     = bytes;
+			w->bytes_written  = voxel_bytes;
+			w->voxels         = voxels;
+			w->das_operations = voxels * (f32)bp->dec_data_dim[1] * (f32)bp->dec_data_dim[2];
+		}break;
+		case BeamformerShaderKind_MinMax:{
+			w->voxels        = voxels;
+			w->bytes_read    = voxel_bytes;
+			w->bytes_written = voxel_bytes * mip_voxels / voxels;
+		}break;
+		case BeamformerShaderKind_Sum:{
+			w->voxels        = voxels;
+			w->bytes_read    = voxel_bytes * (f32)MAX(bp->output_points[3], 1);
+			w->bytes_written = voxel_bytes;
+		}break;
+		case BeamformerShaderKind_LogCompress:{
+			w->voxels        = voxels;
+			w->bytes_read    = voxel_bytes;
+			w->bytes_written = voxels * (f32)cp->log_compress_parameters.bit_depth / 8;
+		}break;
+		default:{}break;
+		}
+	}
+}
+
+function void
+plan_compute_pipeline(SharedMemoryRegion *os_sm, GLParams *gl, BeamformerComputePipeline *cp,
+                      BeamformerFilter *filters, ExternalStageBackend external_backend)
 {
 	BeamformerSharedMemory *sm = os_sm->region;
 	BeamformerParameters   *bp = &cp->das_ubo_data;
@@ -312,10 +708,12 @@ plan_compute_pipeline(SharedMemoryRegion *os_sm, BeamformerComputePipeline *cp,
 
 	b32 decode_first = sm->shaders[0] == BeamformerShaderKind_Decode;
 	b32 cuda_hilbert = 0;
+	b32 cuda_decode  = 0;
 	b32 demodulate   = 0;
 
 	for (i32 i = 0; i < sm->shader_count; i++) {
 		switch (sm->shaders[i]) {
+		case BeamformerShaderKind_CudaDecode:{  cuda_decode  = 1; }break;
 		case BeamformerShaderKind_CudaHilbert:{ cuda_hilbert = 1; }break;
 		case BeamformerShaderKind_Demodulate:{  demodulate = 1;   }break;
 		default:{}break;
@@ -324,10 +722,44 @@ plan_compute_pipeline(SharedMemoryRegion *os_sm, BeamformerComputePipeline *cp,
 
 	if (demodulate) cuda_hilbert = 0;
 
+	cp->output_format = sm->output_format;
+	if (cp->output_format < 0 || cp->output_format >= BeamformerOutputFormat_Count)
+		cp->output_format = BeamformerOutputFormat_Complex32;
+
+	cp->das_batch_count = CLAMP(sm->das_batch_count, 1, BEAMFORMER_MAX_DAS_BATCH);
+
+	cp->log_compress_parameters = sm->log_compress_parameters;
+	if (cp->log_compress_parameters.bit_depth != 16)
+		cp->log_compress_parameters.bit_depth = 8;
+
 	os_shared_memory_region_lock(os_sm, sm->locks, params_lock, (u32)-1);
 	mem_copy(bp, &sm->parameters, sizeof(*bp));
 	os_shared_memory_region_unlock(os_sm, sm->locks, params_lock);
 
+	u32 input_samples = bp->dec_data_dim[0] * bp->dec_data_dim[1] * bp->dec_data_dim[2];
+
+	/* NOTE(rnp): CudaHilbert runs as a GLSL stage unless the CUDA library is loaded. lines
+	 * which don't fit in a single workgroup go through the batched FFT */
+	BeamformerShaderKind hilbert_shader = BeamformerShaderKind_CudaHilbert;
+	cp->hilbert_fft_size = 0;
+	if (cuda_hilbert && external_backend != ExternalStageBackend_CUDA) {
+		u32 samples = bp->dec_data_dim[0];
+		if (!(sm->pipeline_flags & BeamformerPipelineFlags_BatchedFFTHilbert))
+			cp->hilbert_fft_size = hilbert_fft_size(gl, samples);
+
+		if (cp->hilbert_fft_size) {
+			hilbert_shader = BeamformerShaderKind_Hilbert;
+		} else if (fft_size_supported(samples)) {
+			hilbert_shader       = BeamformerShaderKind_HilbertBatchedFFT;
+			cp->hilbert_fft_size = samples;
+		}
+	}
+
+	/* NOTE(rnp): external stages only understand f32 data. the batched FFT keeps its
+	 * intermediates in the RF buffers and they need the full range of f32 */
+	cp->rf_data_half = (sm->pipeline_flags & BeamformerPipelineFlags_HalfPrecisionRF) != 0 &&
+	                   !cuda_decode && !(cuda_hilbert && hilbert_shader != BeamformerShaderKind_Hilbert);
+
 	BeamformerDataKind data_kind = sm->data_kind;
 	cp->shader_count = 0;
 	for (i32 i = 0; i < sm->shader_count; i++) {
@@ -336,7 +768,10 @@ plan_compute_pipeline(SharedMemoryRegion *os_sm, BeamformerComputePipeline *cp,
 		b32 commit = 0;
 
 		switch (shader) {
-		case BeamformerShaderKind_CudaHilbert:{ commit = cuda_hilbert; }break;
+		case BeamformerShaderKind_CudaHilbert:{
+			shader = hilbert_shader;
+			commit = cuda_hilbert;
+		}break;
 		case BeamformerShaderKind_Decode:{
 			BeamformerShaderKind decode_table[] = {
 				[BeamformerDataKind_Int16]          = BeamformerShaderKind_Decode,
@@ -355,6 +790,17 @@ plan_compute_pipeline(SharedMemoryRegion *os_sm, BeamformerComputePipeline *cp,
 				else
 					shader = BeamformerShaderKind_DecodeFloatComplex;
 			}
+
+			if (bp->decode == BeamformerDecodeMode_HADAMARD && decode_fwht_supported(bp->dec_data_dim[2])) {
+				BeamformerShaderKind fwht_table[] = {
+					[BeamformerShaderKind_Decode]             = BeamformerShaderKind_DecodeFWHT,
+					[BeamformerShaderKind_DecodeInt16Complex] = BeamformerShaderKind_DecodeFWHTInt16Complex,
+					[BeamformerShaderKind_DecodeFloat]        = BeamformerShaderKind_DecodeFWHTFloat,
+					[BeamformerShaderKind_DecodeFloatComplex] = BeamformerShaderKind_DecodeFWHTFloatComplex,
+					[BeamformerShaderKind_DecodeInt16ToFloat] = BeamformerShaderKind_DecodeFWHTInt16ToFloat,
+				};
+				shader = fwht_table[shader];
+			}
 			commit = 1;
 		}break;
 		case BeamformerShaderKind_Demodulate:{
@@ -362,12 +808,23 @@ plan_compute_pipeline(SharedMemoryRegion *os_sm, BeamformerComputePipeline *cp,
 				shader = BeamformerShaderKind_DemodulateFloat;
 		} /* FALLTHROUGH */
 		case BeamformerShaderKind_Filter:{
-			bp->time_offset += beamformer_filter_time_offset(filters + sp->filter_slot);
+			BeamformerFilter *f = filters + sp->filter_slot;
+			bp->time_offset += beamformer_filter_time_offset(f);
+			if (shader == BeamformerShaderKind_Filter && f->spectrum_texture &&
+			    !(sm->pipeline_flags & BeamformerPipelineFlags_DirectFormFilter))
+			{
+				shader = BeamformerShaderKind_FilterFFT;
+			}
 			commit = 1;
 		}break;
 		case BeamformerShaderKind_DAS:{
-			if (!bp->coherency_weighting)
+			if (!bp->coherency_weighting) {
 				shader = BeamformerShaderKind_DASFast;
+				if ((sp->das_flags & BeamformerDASFlags_DelayTables) && das_delay_tables_supported(gl, bp))
+					shader = BeamformerShaderKind_DASFastDelayTables;
+				else if (sp->das_flags & BeamformerDASFlags_TiledRF)
+					shader = BeamformerShaderKind_DASFastTiled;
+			}
 			commit = 1;
 		}break;
 		default:{ commit = 1; }break;
@@ -429,8 +886,9 @@ plan_compute_pipeline(SharedMemoryRegion *os_sm, BeamformerComputePipeline *cp,
 	 *   Q[n]  = RF[n + 1]
 	 *   IQ[n] = I[n] - j*Q[n]
 	 */
+	BeamformerFilterUBO demod = {0};
 	if (demodulate) {
-		BeamformerFilterUBO *mp    = &cp->demod_ubo_data;
+		BeamformerFilterUBO *mp    = &demod;
 		mp->demodulation_frequency = bp->center_frequency;
 		mp->sampling_frequency     = bp->sampling_frequency / 2;
 		mp->decimation_rate        = bp->decimation_rate;
@@ -459,15 +917,27 @@ plan_compute_pipeline(SharedMemoryRegion *os_sm, BeamformerComputePipeline *cp,
 
 			cp->decode_dispatch.x = (u32)ceil_f32((f32)bp->dec_data_dim[0] / DECODE_LOCAL_SIZE_X);
 		}
-
-		cp->demod_dispatch.x = (u32)ceil_f32((f32)bp->dec_data_dim[0] / FILTER_LOCAL_SIZE_X);
-		cp->demod_dispatch.y = (u32)ceil_f32((f32)bp->dec_data_dim[1] / FILTER_LOCAL_SIZE_Y);
-		cp->demod_dispatch.z = (u32)ceil_f32((f32)bp->dec_data_dim[2] / FILTER_LOCAL_SIZE_Z);
 	}
-	/* TODO(rnp): if IQ (* 8) else (* 4) */
-	cp->rf_size = bp->dec_data_dim[0] * bp->dec_data_dim[1] * bp->dec_data_dim[2] * 8;
 
-	BeamformerFilterUBO *flt = &cp->filter_ubo_data;
+	/* NOTE(rnp): also used by the Filter stage, which runs on the demodulated dimensions */
+	cp->demod_dispatch.x = (u32)ceil_f32((f32)bp->dec_data_dim[0] / FILTER_LOCAL_SIZE_X);
+	cp->demod_dispatch.y = (u32)ceil_f32((f32)bp->dec_data_dim[1] / FILTER_LOCAL_SIZE_Y);
+	cp->demod_dispatch.z = (u32)ceil_f32((f32)bp->dec_data_dim[2] / FILTER_LOCAL_SIZE_Z);
+	/* TODO(rnp): if IQ (* 8) else (* 4) */
+	cp->rf_size  = bp->dec_data_dim[0] * bp->dec_data_dim[1] * bp->dec_data_dim[2];
+	cp->rf_size *= cp->rf_data_half ? 4 : 8;
+
+	/* NOTE(rnp): averaging consumes frames one at a time in order so it is never batched.
+	 * every batched frame's DAS input must also fit in a single shader storage block */
+	for (i32 i = 0; i < cp->shader_count; i++)
+		if (cp->shaders[i] == BeamformerShaderKind_Sum) cp->das_batch_count = 1;
+	if (bp->output_points[3] > 1 || compute_pipeline_das_stage(cp) <= 0)
+		cp->das_batch_count = 1;
+	while (cp->das_batch_count > 1 && (u64)cp->rf_size * cp->das_batch_count > (u64)gl->max_ssbo_size)
+		cp->das_batch_count--;
+
+	BeamformerFilterUBO filter = {0};
+	BeamformerFilterUBO *flt = &filter;
 	flt->demodulation_frequency = bp->center_frequency;
 	flt->sampling_frequency     = bp->sampling_frequency;
 	flt->decimation_rate        = 1;
@@ -478,6 +948,78 @@ plan_compute_pipeline(SharedMemoryRegion *os_sm, BeamformerComputePipeline *cp,
 	flt->input_channel_stride   = bp->dec_data_dim[0] * bp->dec_data_dim[2];
 	flt->input_sample_stride    = 1;
 	flt->input_transmit_stride  = bp->dec_data_dim[0];
+
+	cp->das_specialization.das_shader_id       = (u8)bp->das_shader_id;
+	cp->das_specialization.interpolate         = bp->interpolate != 0;
+	cp->das_specialization.coherency_weighting = bp->coherency_weighting != 0;
+	cp->das_specialization.iq_data             = bp->center_frequency > 0;
+
+	for (i32 i = 0; i < cp->shader_count; i++) {
+		BeamformerComputeStageUBO *ubo = cp->stage_ubo_data + i;
+		mem_clear(ubo, 0, sizeof(*ubo));
+		switch (cp->shaders[i]) {
+		case BeamformerShaderKind_Decode:
+		case BeamformerShaderKind_DecodeInt16Complex:
+		case BeamformerShaderKind_DecodeFloat:
+		case BeamformerShaderKind_DecodeFloatComplex:
+		case BeamformerShaderKind_DecodeInt16ToFloat:
+		case BeamformerShaderKind_DecodeFWHT:
+		case BeamformerShaderKind_DecodeFWHTInt16Complex:
+		case BeamformerShaderKind_DecodeFWHTFloat:
+		case BeamformerShaderKind_DecodeFWHTFloatComplex:
+		case BeamformerShaderKind_DecodeFWHTInt16ToFloat:
+		{
+			ubo->decode = *dp;
+		}break;
+		case BeamformerShaderKind_Demodulate:
+		case BeamformerShaderKind_DemodulateFloat:
+		{
+			ubo->filter = demod;
+		}break;
+		case BeamformerShaderKind_Filter:
+		case BeamformerShaderKind_FilterFFT:
+		{
+			ubo->filter = filter;
+		}break;
+		case BeamformerShaderKind_DAS:
+		case BeamformerShaderKind_DASFast:
+		case BeamformerShaderKind_DASFastDelayTables:
+		case BeamformerShaderKind_DASFastTiled:
+		{
+			ubo->das = *bp;
+		}break;
+		case BeamformerShaderKind_LogCompress:{
+			ubo->log_compress = cp->log_compress_parameters;
+		}break;
+		default:{}break;
+		}
+	}
+
+	/* NOTE(rnp): only parameters which are consumed by stages preceding DAS are included.
+	 * changes to anything else can reuse the previous DAS input */
+	struct {
+		BeamformerShaderKind       shaders[MAX_COMPUTE_SHADER_STAGES];
+		BeamformerShaderParameters shader_parameters[MAX_COMPUTE_SHADER_STAGES];
+		BeamformerDataKind         data_kind;
+		uv3                        decode_dispatch;
+		uv3                        demod_dispatch;
+		BeamformerComputeStageUBO  stage_ubos[MAX_COMPUTE_SHADER_STAGES];
+	} das_input;
+	mem_clear(&das_input, 0, sizeof(das_input));
+
+	i32 das_stage = compute_pipeline_das_stage(cp);
+	for (i32 i = 0; i < das_stage; i++) {
+		das_input.shaders[i]           = cp->shaders[i];
+		das_input.shader_parameters[i] = cp->shader_parameters[i];
+		das_input.stage_ubos[i]        = cp->stage_ubo_data[i];
+	}
+	das_input.data_kind       = data_kind;
+	das_input.decode_dispatch = cp->decode_dispatch;
+	das_input.demod_dispatch  = cp->demod_dispatch;
+
+	cp->das_input_hash = s8_hash((s8){.len = sizeof(das_input), .data = (u8 *)&das_input});
+
+	plan_compute_stage_work(cp, data_kind, input_samples);
 }
 
 function m4
@@ -517,16 +1059,340 @@ das_voxel_transform_matrix(BeamformerParameters *bp)
 	return result;
 }
 
+/* NOTE(rnp): maps voxels of a coarse mip level onto the centre of the block of full
+ * resolution voxels which they cover */
+function m4
+das_level_transform_matrix(iv3 full_dim, iv3 level_dim)
+{
+	v3 scale = v3_div((v3){{(f32)full_dim.x,  (f32)full_dim.y,  (f32)full_dim.z}},
+	                  (v3){{(f32)level_dim.x, (f32)level_dim.y, (f32)level_dim.z}});
+	v3 shift = v3_scale(v3_sub(scale, (v3){{1.0f, 1.0f, 1.0f}}), 0.5f);
+	m4 result = m4_mul(m4_translation(shift), m4_scale(scale));
+	return result;
+}
+
+function i32
+das_progressive_start_level(BeamformerCtx *ctx, BeamformerFrame *frame, BeamformerShaderKind shader)
+{
+	BeamformerSharedMemory    *sm = ctx->shared_memory.region;
+	BeamformerComputePipeline *cp = &ctx->csctx.compute_pipeline;
+	BeamformerParameters      *bp = &cp->das_ubo_data;
+
+	/* NOTE(rnp): intermediate results are only useful for interactive work on volumes.
+	 * averaging would sum partially refined frames so it is also excluded. the Sum stage
+	 * indexes beamform_frames which a coarse level's preview frame is not one of */
+	/* NOTE(rnp): delay tables are only valid for the full resolution output */
+	b32 sum = 0;
+	for (i32 i = 0; i < cp->shader_count; i++)
+		sum |= cp->shaders[i] == BeamformerShaderKind_Sum;
+
+	i32 result = 0;
+	b32 volume = frame->dim.x > 1 && frame->dim.y > 1 && frame->dim.z > 1;
+	if (volume && bp->output_points[3] <= 1 && !sum && !sm->live_imaging_parameters.active &&
+	    shader != BeamformerShaderKind_DASFastDelayTables)
+		result = MIN(DAS_PROGRESSIVE_LEVELS, frame->mips - 1);
+	return result;
+}
+
+function b32
+das_refinement_cancelled(BeamformerCtx *ctx)
+{
+	BeamformerSharedMemory *sm = ctx->shared_memory.region;
+	u32 mask = (1 << (BeamformerSharedMemoryLockKind_Parameters - 1)) |
+	           (1 << (BeamformerSharedMemoryLockKind_ComputePipeline - 1));
+	b32 result = (atomic_load_u32(&sm->dirty_regions) & mask) != 0;
+	return result;
+}
+
+function void
+das_progressive_discard(ComputeShaderCtx *cs)
+{
+	if (cs->progressive_pending) {
+		glDeleteSync(cs->progressive_fence);
+		cs->progressive_pending = 0;
+	}
+}
+
+/* NOTE(rnp): presents the pending coarse level once its fence has signalled. everything
+ * submitted before it has completed as well so those frames are retired first to keep
+ * presentation in order */
+function void
+das_progressive_present(BeamformerCtx *ctx, u64 timeout_ns)
+{
+	ComputeShaderCtx *cs      = &ctx->csctx;
+	BeamformerFrame  *preview = cs->progressive_pending;
+	GLenum sync_result = GL_TIMEOUT_EXPIRED;
+	if (preview)
+		sync_result = glClientWaitSync(cs->progressive_fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeout_ns);
+	if (sync_result != GL_TIMEOUT_EXPIRED) {
+		/* NOTE(rnp): retiring the last in flight frame would mark the refining frame as done */
+		f32 progress = cs->processing_progress;
+		while (retire_in_flight_frame(ctx, 0));
+		cs->processing_progress = progress;
+		cs->processing_compute  = 1;
+
+		das_progressive_discard(cs);
+		preview->ready_to_present = 1;
+		atomic_store_u64((u64 *)&ctx->latest_frame, (u64)preview);
+	}
+}
+
+/* NOTE(rnp): copies a finished coarse level of frame into the presentation frame which is
+ * not currently presented. an unpresented pending level is superseded and its frame reused */
+function BeamformerFrame *
+das_progressive_frame(BeamformerCtx *ctx, BeamformerFrame *frame, i32 level, Arena arena)
+{
+	das_progressive_discard(&ctx->csctx);
+
+	BeamformerFrame *result = ctx->progressive_frames;
+	if (ctx->latest_frame == result)
+		result++;
+
+	iv3 dim = beamform_frame_level_dim(frame, level);
+	atomic_store_u32(&result->ready_to_present, 0);
+	result->id = frame->id;
+	if (!iv3_equal(result->dim, dim) || result->format != frame->format)
+		alloc_beamform_frame(&ctx->gl, result, dim, frame->format, s8("Progressive_Frame"), arena);
+
+	glCopyImageSubData(frame->texture,  GL_TEXTURE_3D, level, 0, 0, 0,
+	                   result->texture, GL_TEXTURE_3D, 0,     0, 0, 0,
+	                   dim.x, dim.y, dim.z);
+
+	result->view_plane_tag   = frame->view_plane_tag;
+	result->min_coordinate   = frame->min_coordinate;
+	result->max_coordinate   = frame->max_coordinate;
+	result->compound_count   = frame->compound_count;
+	result->das_shader_kind  = frame->das_shader_kind;
+	result->compressed_valid = 0;
+	return result;
+}
+
+function DASSpecializedProgram *
+das_find_specialized_program(ComputeShaderCtx *cs, BeamformerShaderKind kind)
+{
+	DASSpecialization specialization = cs->compute_pipeline.das_specialization;
+	DASSpecializedProgram *result = 0;
+	for (u32 i = 0; !result && i < cs->das_program_count; i++) {
+		DASSpecializedProgram *p = cs->das_programs + i;
+		if (p->kind == kind && p->specialization.value == specialization.value)
+			result = p;
+	}
+	return result;
+}
+
+/* NOTE(rnp): falls back to the generic program if the specialized one isn't available */
+function u32
+das_program(ComputeShaderCtx *cs, BeamformerShaderKind kind)
+{
+	DASSpecializedProgram *p = das_find_specialized_program(cs, kind);
+	u32 result = (p && p->program) ? p->program : cs->programs[kind];
+	return result;
+}
+
+function void
+das_clear_specialized_programs(ComputeShaderCtx *cs)
+{
+	for (u32 i = 0; i < cs->das_program_count; i++)
+		glDeleteProgram(cs->das_programs[i].program);
+	cs->das_program_count = 0;
+	cs->das_program_next  = 0;
+}
+
+function void
+das_update_delay_tables(ComputeShaderCtx *cs, BeamformerFrame *frame, m4 voxel_transform)
+{
+	BeamformerComputePipeline *cp = &cs->compute_pipeline;
+
+	struct {
+		BeamformerParameters parameters;
+		iv3                  dim;
+	} geometry;
+	mem_clear(&geometry, 0, sizeof(geometry));
+	geometry.parameters = cp->das_ubo_data;
+	geometry.dim        = frame->dim;
+
+	u64 hash = s8_hash((s8){.len = sizeof(geometry), .data = (u8 *)&geometry});
+	if (hash != cs->delay_tables_hash) {
+		read_only local_persist s8 labels[] = {
+			s8_comp("DAS_Transmit_Delays"),
+			s8_comp("DAS_Receive_Delays"),
+			s8_comp("DAS_Receive_Apodization"),
+		};
+		static_assert(countof(labels) == countof(cs->delay_table_ssbos), "delay table labels");
+
+		uz sizes[countof(cs->delay_table_ssbos)];
+		das_delay_table_sizes(&cp->das_ubo_data, sizes);
+		for (i32 i = 0; i < countof(cs->delay_table_ssbos); i++) {
+			if (cs->delay_table_sizes[i] != sizes[i]) {
+				glDeleteBuffers(1, cs->delay_table_ssbos + i);
+				glCreateBuffers(1, cs->delay_table_ssbos + i);
+				glNamedBufferStorage(cs->delay_table_ssbos[i], (iz)sizes[i], 0, 0);
+				LABEL_GL_OBJECT(GL_BUFFER, cs->delay_table_ssbos[i], labels[i]);
+				cs->delay_table_sizes[i] = sizes[i];
+			}
+		}
+
+		u32 program = das_program(cs, BeamformerShaderKind_DASDelayTables);
+		glUseProgram(program);
+		glBindImageTexture(0, frame->texture, 0, GL_TRUE, 0, GL_WRITE_ONLY,
+		                   beamformer_output_format_gl[frame->format].internal_format);
+		for (u32 i = 0; i < countof(cs->delay_table_ssbos); i++)
+			glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3 + i, cs->delay_table_ssbos[i]);
+		glProgramUniformMatrix4fv(program, DAS_VOXEL_MATRIX_LOC, 1, 0, voxel_transform.E);
+		glDispatchCompute((u32)ceil_f32((f32)frame->dim.x / DAS_FAST_LOCAL_SIZE_X),
+		                  (u32)ceil_f32((f32)frame->dim.y / DAS_FAST_LOCAL_SIZE_Y),
+		                  (u32)ceil_f32((f32)frame->dim.z / DAS_FAST_LOCAL_SIZE_Z));
+		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+		cs->delay_tables_hash = hash;
+	}
+
+	glUseProgram(das_program(cs, BeamformerShaderKind_DASFastDelayTables));
+	for (u32 i = 0; i < countof(cs->delay_table_ssbos); i++)
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3 + i, cs->delay_table_ssbos[i]);
+}
+
+/* NOTE(rnp): DAS is split into many dispatches and each is flushed on its own so that the
+ * OS can't coalesce them into one long submission and kill it. the thread only waits for
+ * the dispatch DAS_DISPATCHES_IN_FLIGHT behind the one just issued; the queue never runs
+ * dry and the next frame's early stages can be submitted behind this frame's last DAS
+ * dispatches */
+function void
+das_dispatch_throttle(ComputeShaderCtx *cs)
+{
+	u32 slot = cs->das_dispatches_submitted++ % countof(cs->das_dispatch_fences);
+	GLsync oldest = cs->das_dispatch_fences[slot];
+	if (oldest) {
+		GLenum sync_result;
+		do {
+			sync_result = glClientWaitSync(oldest, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+		} while (sync_result == GL_TIMEOUT_EXPIRED);
+		glDeleteSync(oldest);
+	}
+	cs->das_dispatch_fences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	glFlush();
+}
+
+function void
+bind_compute_stage_ubo(BeamformerComputePipeline *cp, i32 stage)
+{
+	glBindBufferRange(GL_UNIFORM_BUFFER, 0, cp->ubo, (iz)stage * cp->ubo_stride,
+	                  sizeof(BeamformerComputeStageUBO));
+}
+
+/* NOTE(rnp): blocks until previously issued copies into the staging buffer are visible */
 function void
-do_compute_shader(BeamformerCtx *ctx, Arena arena, BeamformerFrame *frame,
-                  BeamformerShaderKind shader, BeamformerShaderParameters *sp)
+external_staging_wait(void)
 {
-	ComputeShaderCtx          *csctx = &ctx->csctx;
-	BeamformerComputePipeline *cp    = &csctx->compute_pipeline;
+	GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	GLenum sync_result;
+	do {
+		sync_result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+	} while (sync_result == GL_TIMEOUT_EXPIRED);
+	glDeleteSync(fence);
+}
+
+function void
+external_staging_upload(ComputeShaderCtx *cs, u32 ssbo_index)
+{
+	uz size = cs->external_staging_rf_size;
+	glCopyNamedBufferSubData(cs->external_staging_buffer, cs->rf_data_ssbos[cs->rf_data_set][ssbo_index],
+	                         (iz)(ssbo_index * size), 0, (iz)size);
+}
+
+function BeamformerFFTPlan *
+fft_plan_for_size(ComputeShaderCtx *cs, u32 size, Arena arena)
+{
+	BeamformerFFTPlan *result = 0;
+	for (u32 i = 0; !result && i < cs->fft_plan_count; i++)
+		if (cs->fft_plans[i].size == size) result = cs->fft_plans + i;
+
+	if (!result) {
+		u32 index;
+		if (cs->fft_plan_count < countof(cs->fft_plans)) {
+			index = cs->fft_plan_count++;
+		} else {
+			index = cs->fft_plan_next++ % countof(cs->fft_plans);
+			glDeleteBuffers(1, &cs->fft_plans[index].twiddle_ssbo);
+		}
+		result = cs->fft_plans + index;
+		mem_clear(result, 0, sizeof(*result));
+		result->size = size;
+
+		u32 log2_size = ctz_u32(size);
+		if (log2_size % 3) result->radices[result->pass_count++] = (u8)(1u << (log2_size % 3));
+		for (u32 i = 0; i < log2_size / 3; i++)
+			result->radices[result->pass_count++] = 8;
+
+		f32 *twiddles = push_array(&arena, f32, 2 * size);
+		for (u32 i = 0; i < size; i++) {
+			f32 arg = -2.0f * PI * (f32)i / (f32)size;
+			twiddles[2 * i + 0] = cos_f32(arg);
+			twiddles[2 * i + 1] = sin_f32(arg);
+		}
+
+		glCreateBuffers(1, &result->twiddle_ssbo);
+		glNamedBufferStorage(result->twiddle_ssbo, (iz)(2 * size * sizeof(f32)), twiddles, 0);
+
+		Stream label = arena_stream(arena);
+		stream_append_s8(&label, s8("FFT_Twiddles_"));
+		stream_append_u64(&label, size);
+		LABEL_GL_OBJECT(GL_BUFFER, result->twiddle_ssbo, stream_to_s8(&label));
+	}
+	return result;
+}
+
+/* NOTE(rnp): batched FFT of line_count contiguous lines of plan->size complex samples. each
+ * pass reads ssbos[*index] and writes the other buffer; *index is left at the result */
+function void
+fft_dispatch(ComputeShaderCtx *cs, BeamformerFFTPlan *plan, u32 ssbos[2], u32 *index,
+             u32 line_count, b32 inverse, BeamformerFFTFlags flags)
+{
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, plan->twiddle_ssbo);
+
+	/* NOTE(rnp): lines are split over y and z to stay under the minimum dispatch limit */
+	u32 lines_y = MIN(line_count, 65535u);
+	u32 lines_z = (line_count + lines_y - 1) / lines_y;
+
+	u32 stride = 1;
+	for (u32 pass = 0; pass < plan->pass_count; pass++) {
+		u32 radix = plan->radices[pass];
+		BeamformerShaderKind kind = BeamformerShaderKind_FFT;
+		if (radix == 4) kind = BeamformerShaderKind_FFTRadix4;
+		if (radix == 8) kind = BeamformerShaderKind_FFTRadix8;
+
+		u32 program = cs->programs[kind];
+		glUseProgram(program);
+		glProgramUniform1ui(program, FFT_SIZE_UNIFORM_LOC,       plan->size);
+		glProgramUniform1ui(program, FFT_STRIDE_UNIFORM_LOC,     stride);
+		glProgramUniform1ui(program, FFT_LINE_COUNT_UNIFORM_LOC, line_count);
+		glProgramUniform1f(program,  FFT_DIRECTION_UNIFORM_LOC,  inverse ? -1.0f : 1.0f);
+		glProgramUniform1ui(program, FFT_FLAGS_UNIFORM_LOC,      pass == 0 ? (u32)flags : 0);
+
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, ssbos[*index]);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, ssbos[!*index]);
+
+		u32 butterflies = plan->size / radix;
+		glDispatchCompute((butterflies + FFT_LOCAL_SIZE_X - 1) / FFT_LOCAL_SIZE_X, lines_y, lines_z);
+		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+		*index  = !*index;
+		stride *= radix;
+	}
+}
+
+function void
+do_compute_shader(BeamformerCtx *ctx, Arena arena, BeamformerFrame *frame, i32 stage)
+{
+	ComputeShaderCtx           *csctx  = &ctx->csctx;
+	BeamformerComputePipeline  *cp     = &csctx->compute_pipeline;
+	BeamformerShaderKind        shader = cp->shaders[stage];
+	BeamformerShaderParameters *sp     = cp->shader_parameters + stage;
 
 	u32 program = csctx->programs[shader];
 	glUseProgram(program);
 
+	u32 *rf_data_ssbos  = csctx->rf_data_ssbos[csctx->rf_data_set];
 	u32 output_ssbo_idx = !csctx->last_output_ssbo_index;
 	u32 input_ssbo_idx  = csctx->last_output_ssbo_index;
 
@@ -536,12 +1402,17 @@ do_compute_shader(BeamformerCtx *ctx, Arena arena, BeamformerFrame *frame,
 	case BeamformerShaderKind_DecodeFloat:
 	case BeamformerShaderKind_DecodeFloatComplex:
 	case BeamformerShaderKind_DecodeInt16ToFloat:
+	case BeamformerShaderKind_DecodeFWHT:
+	case BeamformerShaderKind_DecodeFWHTInt16Complex:
+	case BeamformerShaderKind_DecodeFWHTFloat:
+	case BeamformerShaderKind_DecodeFWHTFloatComplex:
+	case BeamformerShaderKind_DecodeFWHTInt16ToFloat:
 	{
-		glBindBufferBase(GL_UNIFORM_BUFFER, 0, cp->ubos[BeamformerComputeUBOKind_Decode]);
+		bind_compute_stage_ubo(cp, stage);
 		glBindImageTexture(0, csctx->hadamard_texture, 0, GL_FALSE, 0, GL_READ_ONLY, GL_R8I);
 
 		if (shader == cp->shaders[0]) {
-			glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, csctx->rf_data_ssbos[input_ssbo_idx]);
+			glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, rf_data_ssbos[input_ssbo_idx]);
 			glBindImageTexture(1, csctx->channel_mapping_texture, 0, GL_FALSE, 0, GL_READ_ONLY, GL_R16I);
 			glProgramUniform1ui(program, DECODE_FIRST_PASS_UNIFORM_LOC, 1);
 
@@ -549,39 +1420,86 @@ do_compute_shader(BeamformerCtx *ctx, Arena arena, BeamformerFrame *frame,
 			glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
 		}
 
-		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, csctx->rf_data_ssbos[input_ssbo_idx]);
-		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, csctx->rf_data_ssbos[output_ssbo_idx]);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, rf_data_ssbos[input_ssbo_idx]);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, rf_data_ssbos[output_ssbo_idx]);
 
 		glProgramUniform1ui(program, DECODE_FIRST_PASS_UNIFORM_LOC, 0);
-		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, csctx->rf_data_ssbos[output_ssbo_idx]);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, rf_data_ssbos[output_ssbo_idx]);
+
+		/* NOTE(rnp): the FWHT decode handles every transmit within a single workgroup */
+		u32 dispatch_z = cp->decode_dispatch.z;
+		if (shader >= BeamformerShaderKind_DecodeFWHT && shader <= BeamformerShaderKind_DecodeFWHTInt16ToFloat)
+			dispatch_z = 1;
 
-		glDispatchCompute(cp->decode_dispatch.x, cp->decode_dispatch.y, cp->decode_dispatch.z);
+		glDispatchCompute(cp->decode_dispatch.x, cp->decode_dispatch.y, dispatch_z);
 		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
 
 		csctx->last_output_ssbo_index = !csctx->last_output_ssbo_index;
 	}break;
 	case BeamformerShaderKind_CudaDecode:{
-		csctx->cuda_lib.decode(0, output_ssbo_idx, 0);
+		ExternalStageLib *esl = &csctx->external_stages;
+		if (esl->backend == ExternalStageBackend_CPU) {
+			BeamformerRFBuffer *rf = &csctx->rf_buffer;
+			u32 slot = (rf->compute_index - 1) % countof(rf->compute_syncs);
+			uz  raw_offset = 2 * csctx->external_staging_rf_size;
+			glCopyNamedBufferSubData(rf->ssbo, csctx->external_staging_buffer, slot * rf->rf_size,
+			                         (iz)raw_offset, MIN(rf->rf_size, csctx->rf_raw_size));
+			external_staging_wait();
+			esl->decode(0, output_ssbo_idx, 0);
+			external_staging_upload(csctx, output_ssbo_idx);
+		} else {
+			esl->decode(0, 2 * csctx->rf_data_set + output_ssbo_idx, 0);
+		}
 		csctx->last_output_ssbo_index = !csctx->last_output_ssbo_index;
 	}break;
 	case BeamformerShaderKind_CudaHilbert:{
-		csctx->cuda_lib.hilbert(input_ssbo_idx, output_ssbo_idx);
+		ExternalStageLib *esl = &csctx->external_stages;
+		if (esl->backend == ExternalStageBackend_CPU) {
+			uz size = csctx->external_staging_rf_size;
+			glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT|GL_CLIENT_MAPPED_BUFFER_BARRIER_BIT);
+			glCopyNamedBufferSubData(rf_data_ssbos[input_ssbo_idx], csctx->external_staging_buffer,
+			                         0, (iz)(input_ssbo_idx * size), (iz)size);
+			external_staging_wait();
+			esl->hilbert(input_ssbo_idx, output_ssbo_idx);
+			external_staging_upload(csctx, output_ssbo_idx);
+		} else {
+			u32 set_base = 2 * csctx->rf_data_set;
+			esl->hilbert(set_base + input_ssbo_idx, set_base + output_ssbo_idx);
+		}
 		csctx->last_output_ssbo_index = !csctx->last_output_ssbo_index;
 	}break;
+	case BeamformerShaderKind_Hilbert:{
+		u32 *dim = cp->das_ubo_data.dec_data_dim;
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, rf_data_ssbos[input_ssbo_idx]);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, rf_data_ssbos[output_ssbo_idx]);
+		glProgramUniform1ui(program, HILBERT_SAMPLE_COUNT_UNIFORM_LOC, dim[0]);
+		glProgramUniform1ui(program, HILBERT_FFT_SIZE_UNIFORM_LOC,     cp->hilbert_fft_size);
+
+		/* NOTE(rnp): one workgroup per line; lines are stored transmit fastest */
+		glDispatchCompute(dim[2], dim[1], 1);
+		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+		csctx->last_output_ssbo_index = !csctx->last_output_ssbo_index;
+	}break;
+	case BeamformerShaderKind_HilbertBatchedFFT:{
+		u32 *dim = cp->das_ubo_data.dec_data_dim;
+		BeamformerFFTPlan *plan = fft_plan_for_size(csctx, cp->hilbert_fft_size, arena);
+
+		u32 index = input_ssbo_idx;
+		fft_dispatch(csctx, plan, rf_data_ssbos, &index, dim[1] * dim[2], 0, BeamformerFFTFlags_RealInput);
+		fft_dispatch(csctx, plan, rf_data_ssbos, &index, dim[1] * dim[2], 1,
+		             BeamformerFFTFlags_AnalyticMask|BeamformerFFTFlags_Normalize);
+		csctx->last_output_ssbo_index = index;
+	}break;
 	case BeamformerShaderKind_Demodulate:
 	case BeamformerShaderKind_DemodulateFloat:
 	case BeamformerShaderKind_Filter:
 	{
-		BeamformerFilterUBO *ubo = &cp->demod_ubo_data;
-		if (shader == BeamformerShaderKind_Filter)
-			ubo = &cp->filter_ubo_data;
-
-		u32 index = shader == BeamformerShaderKind_Filter ? BeamformerComputeUBOKind_Filter
-		                                                  : BeamformerComputeUBOKind_Demodulate;
-		glBindBufferBase(GL_UNIFORM_BUFFER,        0, cp->ubos[index]);
-		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, csctx->rf_data_ssbos[output_ssbo_idx]);
+		BeamformerFilterUBO *ubo = &cp->stage_ubo_data[stage].filter;
+		bind_compute_stage_ubo(cp, stage);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, rf_data_ssbos[output_ssbo_idx]);
 		if (!ubo->map_channels)
-			glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, csctx->rf_data_ssbos[input_ssbo_idx]);
+			glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, rf_data_ssbos[input_ssbo_idx]);
 
 		glBindImageTexture(0, csctx->filters[sp->filter_slot].texture, 0, GL_FALSE, 0, GL_READ_ONLY, GL_R32F);
 		if (ubo->map_channels)
@@ -592,92 +1510,205 @@ do_compute_shader(BeamformerCtx *ctx, Arena arena, BeamformerFrame *frame,
 
 		csctx->last_output_ssbo_index = !csctx->last_output_ssbo_index;
 	}break;
+	case BeamformerShaderKind_FilterFFT:{
+		BeamformerFilter *f = csctx->filters + sp->filter_slot;
+		bind_compute_stage_ubo(cp, stage);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, rf_data_ssbos[input_ssbo_idx]);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, rf_data_ssbos[output_ssbo_idx]);
+		glBindImageTexture(0, f->texture,          0, GL_FALSE, 0, GL_READ_ONLY, GL_R32F);
+		glBindImageTexture(2, f->spectrum_texture, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RG32F);
+
+		/* NOTE(rnp): one workgroup per block of outputs, channel, and transmit */
+		u32 *dim = cp->das_ubo_data.dec_data_dim;
+		u32 block_outputs = FILTER_FFT_SIZE - (u32)f->parameters.length;
+		glDispatchCompute((u32)ceil_f32((f32)dim[0] / (f32)block_outputs), dim[1], dim[2]);
+		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+		csctx->last_output_ssbo_index = !csctx->last_output_ssbo_index;
+	}break;
 	case BeamformerShaderKind_MinMax:{
-		for (i32 i = 1; i < frame->mips; i++) {
-			glBindImageTexture(0, frame->texture, i - 1, GL_TRUE, 0, GL_READ_ONLY,  GL_RG32F);
-			glBindImageTexture(1, frame->texture, i - 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_RG32F);
-			glProgramUniform1i(csctx->programs[shader], MIN_MAX_MIPS_LEVEL_UNIFORM_LOC, i);
-
-			u32 width  = (u32)frame->dim.x >> i;
-			u32 height = (u32)frame->dim.y >> i;
-			u32 depth  = (u32)frame->dim.z >> i;
-			glDispatchCompute(ORONE(width / 32), ORONE(height), ORONE(depth / 32));
-			glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+		/* NOTE(rnp): each pass produces up to 3 levels through shared memory. once the
+		 * last of those fits in a single workgroup's input tile the last workgroup to
+		 * finish also produces the remaining levels in the same dispatch */
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, csctx->min_max_counter_ssbo);
+		for (i32 level = 0; level < frame->mips - 1;) {
+			i32 pass_levels = MIN(3, frame->mips - 1 - level);
+			i32 tail_levels = 0;
+			if (pass_levels == 3) {
+				iv3 tail_input = beamform_frame_level_dim(frame, level + 3);
+				if (tail_input.x <= 2 * MIN_MAX_LOCAL_SIZE_X &&
+				    tail_input.y <= 2 * MIN_MAX_LOCAL_SIZE_Y &&
+				    tail_input.z <= 2 * MIN_MAX_LOCAL_SIZE_Z)
+				{
+					tail_levels = MIN(3, frame->mips - 1 - (level + 3));
+				}
+			}
+
+			u32 format = beamformer_output_format_gl[frame->format].internal_format;
+			glBindImageTexture(0, frame->texture, level, GL_TRUE, 0, GL_READ_ONLY, format);
+			for (i32 i = 1; i <= pass_levels + tail_levels; i++) {
+				GLenum access = i == 3 ? GL_READ_WRITE : GL_WRITE_ONLY;
+				glBindImageTexture((u32)i, frame->texture, level + i, GL_TRUE, 0, access, format);
+			}
+			glProgramUniform1i(program, MIN_MAX_PASS_LEVELS_UNIFORM_LOC, pass_levels);
+			glProgramUniform1i(program, MIN_MAX_TAIL_LEVELS_UNIFORM_LOC, tail_levels);
+
+			iv3 dim = beamform_frame_level_dim(frame, level + 1);
+			glDispatchCompute((u32)ceil_f32((f32)dim.x / MIN_MAX_LOCAL_SIZE_X),
+			                  (u32)ceil_f32((f32)dim.y / MIN_MAX_LOCAL_SIZE_Y),
+			                  (u32)ceil_f32((f32)dim.z / MIN_MAX_LOCAL_SIZE_Z));
+			glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT|GL_SHADER_STORAGE_BARRIER_BIT);
+
+			level += pass_levels + tail_levels;
 		}
 	}break;
 	case BeamformerShaderKind_DAS:
 	case BeamformerShaderKind_DASFast:
+	case BeamformerShaderKind_DASFastDelayTables:
+	case BeamformerShaderKind_DASFastTiled:
 	{
 		BeamformerParameters *ubo = &cp->das_ubo_data;
-		if (shader == BeamformerShaderKind_DASFast) {
-			glClearTexImage(frame->texture, 0, GL_RED, GL_FLOAT, 0);
-			glMemoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT);
-			glBindImageTexture(0, frame->texture, 0, GL_TRUE, 0, GL_READ_WRITE, GL_RG32F);
-		} else {
-			glBindImageTexture(0, frame->texture, 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_RG32F);
-		}
+		b32 fast    = shader != BeamformerShaderKind_DAS;
+		b32 batched = frame == &ctx->das_batch_frame;
 
-		glBindBufferBase(GL_UNIFORM_BUFFER, 0, cp->ubos[BeamformerComputeUBOKind_DAS]);
-		glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 1, csctx->rf_data_ssbos[input_ssbo_idx], 0, cp->rf_size);
-		glBindImageTexture(1, csctx->sparse_elements_texture, 0, GL_FALSE, 0, GL_READ_ONLY,  GL_R16I);
-		glBindImageTexture(2, csctx->focal_vectors_texture,   0, GL_FALSE, 0, GL_READ_ONLY,  GL_RG32F);
+		program = das_program(csctx, shader);
 
-		m4 voxel_transform = das_voxel_transform_matrix(ubo);
+		/* NOTE(rnp): batched frames are stacked along y and slice y reads its input from
+		 * slot y of the batch buffer */
+		iz  rf_size      = batched ? (iz)cp->rf_size * frame->dim.y : (iz)cp->rf_size;
+		u32 rf_ssbo      = batched ? csctx->das_batch_ssbo : rf_data_ssbos[input_ssbo_idx];
+		i32 batch_stride = batched ? (i32)(cp->rf_size / (cp->rf_data_half ? 4 : 8)) : 0;
+		glProgramUniform1i(program, DAS_RF_BATCH_STRIDE_UNIFORM_LOC, batch_stride);
 		glProgramUniform1ui(program, DAS_CYCLE_T_UNIFORM_LOC, cycle_t++);
-		glProgramUniformMatrix4fv(program, DAS_VOXEL_MATRIX_LOC, 1, 0, voxel_transform.E);
 
-		if (shader == BeamformerShaderKind_DASFast) {
-			i32 loop_end;
-			if (ubo->das_shader_id == DASShaderKind_RCA_VLS ||
-			    ubo->das_shader_id == DASShaderKind_RCA_TPW)
-			{
-				/* NOTE(rnp): to avoid repeatedly sampling the whole focal vectors
-				 * texture we loop over transmits for VLS/TPW */
-				loop_end = (i32)ubo->dec_data_dim[2];
+		/* NOTE(rnp): large volumes are first beamformed into coarse mip levels which are
+		 * presented while the next level is computed. refinement stops as soon as the
+		 * parameters change since the next frame will replace the result anyway */
+		m4 das_transform = das_voxel_transform_matrix(ubo);
+		/* NOTE(rnp): the delay table builder reads the DAS parameters from this range too */
+		bind_compute_stage_ubo(cp, stage);
+		if (shader == BeamformerShaderKind_DASFastDelayTables)
+			das_update_delay_tables(csctx, batched ? csctx->das_batch_frames[0] : frame, das_transform);
+
+		/* NOTE(rnp): the fast paths accumulate a channel (or transmit) per dispatch. unless
+		 * the frame is stored as full precision complex the partial sums are kept in the
+		 * accumulator and the last dispatch writes the final value into the frame */
+		b32 resolve = fast && frame->format != BeamformerOutputFormat_Complex32;
+		if (resolve && !iv3_equal(ctx->das_accumulator.dim, frame->dim)) {
+			alloc_beamform_frame(&ctx->gl, &ctx->das_accumulator, frame->dim,
+			                     BeamformerOutputFormat_Complex32, s8("DAS_Accumulator"), arena);
+		}
+		u32 output_format = beamformer_output_format_gl[frame->format].internal_format;
+
+		i32 level = batched ? 0 : das_progressive_start_level(ctx, frame, shader);
+		f32 total_points = 0;
+		for (i32 i = level; i >= 0; i--) {
+			iv3 dim = beamform_frame_level_dim(frame, i);
+			total_points += (f32)dim.x * (f32)dim.y * (f32)dim.z;
+		}
+
+		csctx->processing_progress      = 0;
+		csctx->das_refinement_cancelled = 0;
+		for (; level >= 0; level--) {
+			/* NOTE(rnp): presenting a coarse level runs the later stages which bind their own state */
+			glUseProgram(program);
+			bind_compute_stage_ubo(cp, stage);
+			glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 1, rf_ssbo, 0, rf_size);
+			glBindImageTexture(1, csctx->sparse_elements_texture, 0, GL_FALSE, 0, GL_READ_ONLY, GL_R16I);
+			glBindImageTexture(2, csctx->focal_vectors_texture,   0, GL_FALSE, 0, GL_READ_ONLY, GL_RG32F);
+
+			iv3 dim = beamform_frame_level_dim(frame, level);
+			f32 level_fraction = (f32)dim.x * (f32)dim.y * (f32)dim.z / total_points;
+
+			if (fast) {
+				u32 accumulator = resolve ? ctx->das_accumulator.texture : frame->texture;
+				glClearTexImage(accumulator, level, GL_RED, GL_FLOAT, 0);
+				glMemoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT);
+				glBindImageTexture(0, accumulator, level, GL_TRUE, 0, GL_READ_WRITE, GL_RG32F);
+				if (resolve)
+					glBindImageTexture(3, frame->texture, level, GL_TRUE, 0, GL_WRITE_ONLY, output_format);
 			} else {
-				loop_end = (i32)ubo->dec_data_dim[1];
+				glBindImageTexture(0, frame->texture, level, GL_TRUE, 0, GL_WRITE_ONLY, output_format);
 			}
-			f32 percent_per_step = 1.0f / (f32)loop_end;
-			csctx->processing_progress = -percent_per_step;
-			for (i32 index = 0; index < loop_end; index++) {
-				csctx->processing_progress += percent_per_step;
-				/* IMPORTANT(rnp): prevents OS from coalescing and killing our shader */
-				glFinish();
-				glProgramUniform1i(program, DAS_FAST_CHANNEL_UNIFORM_LOC, index);
-				glDispatchCompute((u32)ceil_f32((f32)frame->dim.x / DAS_FAST_LOCAL_SIZE_X),
-				                  (u32)ceil_f32((f32)frame->dim.y / DAS_FAST_LOCAL_SIZE_Y),
-				                  (u32)ceil_f32((f32)frame->dim.z / DAS_FAST_LOCAL_SIZE_Z));
-				glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+			m4 voxel_transform = m4_mul(das_transform, das_level_transform_matrix(frame->dim, dim));
+			glProgramUniformMatrix4fv(program, DAS_VOXEL_MATRIX_LOC, 1, 0, voxel_transform.E);
+
+			if (fast) {
+				i32 loop_end;
+				if (ubo->das_shader_id == DASShaderKind_RCA_VLS ||
+				    ubo->das_shader_id == DASShaderKind_RCA_TPW)
+				{
+					/* NOTE(rnp): to avoid repeatedly sampling the whole focal vectors
+					 * texture we loop over transmits for VLS/TPW */
+					loop_end = (i32)ubo->dec_data_dim[2];
+				} else {
+					loop_end = (i32)ubo->dec_data_dim[1];
+				}
+				f32 percent_per_step = level_fraction / (f32)loop_end;
+				if (resolve) glProgramUniform1i(program, DAS_FAST_LAST_CHANNEL_UNIFORM_LOC, loop_end - 1);
+				for (i32 index = 0; index < loop_end; index++) {
+					das_progressive_present(ctx, 0);
+					glProgramUniform1i(program, DAS_FAST_CHANNEL_UNIFORM_LOC, index);
+					glDispatchCompute((u32)ceil_f32((f32)dim.x / DAS_FAST_LOCAL_SIZE_X),
+					                  (u32)ceil_f32((f32)dim.y / DAS_FAST_LOCAL_SIZE_Y),
+					                  (u32)ceil_f32((f32)dim.z / DAS_FAST_LOCAL_SIZE_Z));
+					glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+					/* IMPORTANT(rnp): prevents OS from coalescing and killing our shader */
+					das_dispatch_throttle(csctx);
+					csctx->processing_progress += percent_per_step;
+				}
+			} else {
+				#if 1
+				/* TODO(rnp): compute max_points_per_dispatch based on something like a
+				 * transmit_count * channel_count product */
+				u32 max_points_per_dispatch = KB(64);
+				struct compute_cursor cursor = start_compute_cursor(dim, max_points_per_dispatch);
+				f32 percent_per_step = level_fraction * (f32)cursor.points_per_dispatch / (f32)cursor.total_points;
+				for (iv3 offset = {0};
+				     !compute_cursor_finished(&cursor);
+				     offset = step_compute_cursor(&cursor))
+				{
+					das_progressive_present(ctx, 0);
+					glProgramUniform3iv(program, DAS_VOXEL_OFFSET_UNIFORM_LOC, 1, offset.E);
+					glDispatchCompute(cursor.dispatch.x, cursor.dispatch.y, cursor.dispatch.z);
+					/* IMPORTANT(rnp): prevents OS from coalescing and killing our shader */
+					das_dispatch_throttle(csctx);
+					csctx->processing_progress += percent_per_step;
+				}
+				#else
+				/* NOTE(rnp): use this for testing tiling code. The performance of the above path
+				 * should be the same as this path if everything is working correctly */
+				iv3 compute_dim_offset = {0};
+				glProgramUniform3iv(program, DAS_VOXEL_OFFSET_UNIFORM_LOC, 1, compute_dim_offset.E);
+				glDispatchCompute((u32)ceil_f32((f32)dim.x / DAS_LOCAL_SIZE_X),
+				                  (u32)ceil_f32((f32)dim.y / DAS_LOCAL_SIZE_Y),
+				                  (u32)ceil_f32((f32)dim.z / DAS_LOCAL_SIZE_Z));
+				#endif
 			}
-		} else {
-			#if 1
-			/* TODO(rnp): compute max_points_per_dispatch based on something like a
-			 * transmit_count * channel_count product */
-			u32 max_points_per_dispatch = KB(64);
-			struct compute_cursor cursor = start_compute_cursor(frame->dim, max_points_per_dispatch);
-			f32 percent_per_step = (f32)cursor.points_per_dispatch / (f32)cursor.total_points;
-			csctx->processing_progress = -percent_per_step;
-			for (iv3 offset = {0};
-			     !compute_cursor_finished(&cursor);
-			     offset = step_compute_cursor(&cursor))
-			{
-				csctx->processing_progress += percent_per_step;
-				/* IMPORTANT(rnp): prevents OS from coalescing and killing our shader */
-				glFinish();
-				glProgramUniform3iv(program, DAS_VOXEL_OFFSET_UNIFORM_LOC, 1, offset.E);
-				glDispatchCompute(cursor.dispatch.x, cursor.dispatch.y, cursor.dispatch.z);
+			glMemoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT|GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+			/* NOTE(rnp): the coarse level goes through the rest of the pipeline in a
+			 * separate frame. it is presented once its fence signals; nothing waits here */
+			if (level > 0) {
+				BeamformerFrame *preview = das_progressive_frame(ctx, frame, level, arena);
+				for (i32 i = stage + 1; i < cp->shader_count; i++)
+					do_compute_shader(ctx, arena, preview, i);
+				csctx->progressive_fence   = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+				csctx->progressive_pending = preview;
+				glFlush();
+
+				if (das_refinement_cancelled(ctx)) {
+					csctx->das_refinement_cancelled = 1;
+					break;
+				}
 			}
-			#else
-			/* NOTE(rnp): use this for testing tiling code. The performance of the above path
-			 * should be the same as this path if everything is working correctly */
-			iv3 compute_dim_offset = {0};
-			glProgramUniform3iv(program, DAS_VOXEL_OFFSET_UNIFORM_LOC, 1, compute_dim_offset.E);
-			glDispatchCompute((u32)ceil_f32((f32)dim.x / DAS_LOCAL_SIZE_X),
-			                  (u32)ceil_f32((f32)dim.y / DAS_LOCAL_SIZE_Y),
-			                  (u32)ceil_f32((f32)dim.z / DAS_LOCAL_SIZE_Z));
-			#endif
 		}
-		glMemoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT|GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+		/* NOTE(rnp): a cancelled frame is never presented so its last coarse level is shown
+		 * in its place. a completed frame supersedes any coarse level still pending */
+		if (csctx->das_refinement_cancelled) das_progressive_present(ctx, (u64)-1);
+		else                                 das_progressive_discard(csctx);
 	}break;
 	case BeamformerShaderKind_Sum:{
 		u32 aframe_index = ctx->averaged_frame_index % ARRAY_COUNT(ctx->averaged_frames);
@@ -690,19 +1721,100 @@ do_compute_shader(BeamformerCtx *ctx, Arena arena, BeamformerFrame *frame,
 		assert(frame < ctx->beamform_frames + countof(ctx->beamform_frames));
 		u32 base_index   = (u32)(frame - ctx->beamform_frames);
 		u32 to_average   = (u32)cp->das_ubo_data.output_points[3];
-		u32 frame_count  = 0;
-		u32 *in_textures = push_array(&arena, u32, MAX_BEAMFORMED_SAVED_FRAMES);
-		ComputeFrameIterator cfi = compute_frame_iterator(ctx, 1 + base_index - to_average, to_average);
-		for (BeamformerFrame *it = frame_next(&cfi); it; it = frame_next(&cfi))
-			in_textures[frame_count++] = it->texture;
-
-		assert(to_average == frame_count);
-
-		do_sum_shader(csctx, in_textures, frame_count, 1 / (f32)frame_count, aframe->texture, aframe->dim);
-		aframe->min_coordinate  = frame->min_coordinate;
-		aframe->max_coordinate  = frame->max_coordinate;
-		aframe->compound_count  = frame->compound_count;
-		aframe->das_shader_kind = frame->das_shader_kind;
+
+		/* NOTE(rnp): the incremental modes start from the previous averaged frame. this is
+		 * only valid if it was produced from the frame directly preceding this one with the
+		 * same settings. running sums also need the frame leaving the window to still be
+		 * around and accumulate rounding error so they periodically get fully resummed */
+		BeamformerSumMode mode   = sp->sum_mode;
+		BeamformerFrame *last    = ctx->averaged_frames + ((ctx->averaged_frame_index - 1) % countof(ctx->averaged_frames));
+		BeamformerFrame *leaving = ctx->beamform_frames +
+		                           ((base_index + countof(ctx->beamform_frames) - to_average % countof(ctx->beamform_frames))
+		                            % countof(ctx->beamform_frames));
+		b32 incremental = ctx->averaging_count   == to_average &&
+		                  ctx->averaging_mode    == mode       &&
+		                  ctx->averaging_frame_id + 1 == frame->id &&
+		                  ctx->averaging_resum_countdown > 0   &&
+		                  iv3_equal(last->dim, aframe->dim);
+		switch (mode) {
+		case BeamformerSumMode_RunningSum:{
+			incremental &= to_average < countof(ctx->beamform_frames) &&
+			               leaving->id + to_average == frame->id &&
+			               iv3_equal(leaving->dim, frame->dim);
+		}break;
+		case BeamformerSumMode_ExponentialMovingAverage:{}break;
+		default:{ incremental = 0; }break;
+		}
+
+		if (incremental) {
+			ctx->averaging_resum_countdown--;
+			glCopyImageSubData(last->texture,   GL_TEXTURE_3D, 0, 0, 0, 0,
+			                   aframe->texture, GL_TEXTURE_3D, 0, 0, 0, 0,
+			                   aframe->dim.x, aframe->dim.y, aframe->dim.z);
+			glBindImageTexture(0, aframe->texture, 0, GL_TRUE, 0, GL_READ_WRITE,
+			                   beamformer_output_format_gl[aframe->format].internal_format);
+			if (mode == BeamformerSumMode_RunningSum) {
+				do_sum_dispatch(csctx, frame->texture,    1 / (f32)to_average, 1.0f, aframe->dim);
+				do_sum_dispatch(csctx, leaving->texture, -1 / (f32)to_average, 1.0f, aframe->dim);
+			} else {
+				f32 alpha = 2.0f / (f32)(to_average + 1);
+				do_sum_dispatch(csctx, frame->texture, alpha, 1.0f - alpha, aframe->dim);
+			}
+		} else {
+			u32 frame_count  = 0;
+			u32 *in_textures = push_array(&arena, u32, MAX_BEAMFORMED_SAVED_FRAMES);
+			ComputeFrameIterator cfi = compute_frame_iterator(ctx, 1 + base_index - to_average, to_average);
+			for (BeamformerFrame *it = frame_next(&cfi); it; it = frame_next(&cfi))
+				in_textures[frame_count++] = it->texture;
+
+			assert(to_average == frame_count);
+
+			do_sum_shader(csctx, in_textures, frame_count, 1 / (f32)frame_count, aframe->texture, aframe->dim);
+			ctx->averaging_resum_countdown = SUM_RUNNING_RESUM_INTERVAL;
+		}
+		ctx->averaging_mode     = mode;
+		ctx->averaging_count    = to_average;
+		ctx->averaging_frame_id = frame->id;
+
+		aframe->min_coordinate   = frame->min_coordinate;
+		aframe->max_coordinate   = frame->max_coordinate;
+		aframe->compound_count   = frame->compound_count;
+		aframe->das_shader_kind  = frame->das_shader_kind;
+		aframe->compressed_valid = 0;
+	}break;
+	case BeamformerShaderKind_LogCompress:{
+		/* NOTE(rnp): when the pipeline averaged frames it is the average which gets presented */
+		BeamformerFrame *source = frame;
+		for (i32 i = 0; i < stage; i++) {
+			if (cp->shaders[i] == BeamformerShaderKind_Sum)
+				source = ctx->averaged_frames + ctx->averaged_frame_index % countof(ctx->averaged_frames);
+		}
+
+		BeamformerLogCompressParameters *lp = &cp->stage_ubo_data[stage].log_compress;
+		u32 format = lp->bit_depth == 16 ? GL_R16 : GL_R8;
+		if (!iv3_equal(source->compressed_dim, source->dim) || source->compressed_bit_depth != lp->bit_depth) {
+			glDeleteTextures(1, &source->compressed_texture);
+			glCreateTextures(GL_TEXTURE_3D, 1, &source->compressed_texture);
+			glTextureStorage3D(source->compressed_texture, 1, format,
+			                   source->dim.x, source->dim.y, source->dim.z);
+			glTextureParameteri(source->compressed_texture, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+			glTextureParameteri(source->compressed_texture, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+			LABEL_GL_OBJECT(GL_TEXTURE, source->compressed_texture, s8("Log Compressed Frame"));
+			source->compressed_dim       = source->dim;
+			source->compressed_bit_depth = lp->bit_depth;
+		}
+
+		bind_compute_stage_ubo(cp, stage);
+		glBindImageTexture(0, source->texture, 0, GL_TRUE, 0, GL_READ_ONLY,
+		                   beamformer_output_format_gl[source->format].internal_format);
+		glBindImageTexture(1, source->compressed_texture, 0, GL_TRUE, 0, GL_WRITE_ONLY, format);
+		glDispatchCompute((u32)ceil_f32((f32)source->dim.x / LOG_COMPRESS_LOCAL_SIZE_X),
+		                  (u32)ceil_f32((f32)source->dim.y / LOG_COMPRESS_LOCAL_SIZE_Y),
+		                  (u32)ceil_f32((f32)source->dim.z / LOG_COMPRESS_LOCAL_SIZE_Z));
+		glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT|GL_TEXTURE_UPDATE_BARRIER_BIT);
+
+		source->compressed_parameters = *lp;
+		source->compressed_valid      = 1;
 	}break;
 	InvalidDefaultCase;
 	}
@@ -714,25 +1826,57 @@ shader_text_with_header(ShaderReloadContext *ctx, OS *os, Arena *arena)
 	Stream sb = arena_stream(*arena);
 	stream_append_s8s(&sb, s8("#version 460 core\n\n"), ctx->header);
 
+	if (ctx->kind < BeamformerShaderKind_ComputeCount) {
+		ComputeShaderCtx *cs = &ctx->beamformer_context->csctx;
+		if (cs->rf_data_half)
+			stream_append_s8(&sb, s8("#define RF_DATA_HALF 1\n\n"));
+		else
+			stream_append_s8(&sb, s8("#define RF_DATA_HALF 0\n\n"));
+
+		#define X(name, id, glsl, size) s8_comp(#glsl),
+		read_only local_persist s8 output_formats[] = {BEAMFORMER_OUTPUT_FORMAT_LIST};
+		#undef X
+		b32 magnitude = cs->output_format == BeamformerOutputFormat_Magnitude32 ||
+		                cs->output_format == BeamformerOutputFormat_Magnitude16;
+		stream_append_s8s(&sb, s8("#define OUTPUT_FORMAT    "), output_formats[cs->output_format],
+		                  s8("\n#define OUTPUT_MAGNITUDE "), magnitude ? s8("1") : s8("0"),
+		                  s8("\n#define OUTPUT_COMPLEX32 "),
+		                  cs->output_format == BeamformerOutputFormat_Complex32 ? s8("1") : s8("0"),
+		                  s8("\n\n"));
+	}
+
 	switch (ctx->kind) {
 	case BeamformerShaderKind_Demodulate:
 	case BeamformerShaderKind_DemodulateFloat:
 	case BeamformerShaderKind_Filter:
+	case BeamformerShaderKind_FilterFFT:
 	{
 		if (ctx->kind != BeamformerShaderKind_Demodulate)
 			stream_append_s8(&sb, s8("#define INPUT_DATA_TYPE_FLOAT\n\n"));
 
-		if (ctx->kind != BeamformerShaderKind_Filter)
+		if (ctx->kind == BeamformerShaderKind_Demodulate || ctx->kind == BeamformerShaderKind_DemodulateFloat)
 			stream_append_s8(&sb, s8("#define DEMODULATE\n\n"));
 
-		stream_append_s8(&sb, s8(""
-		"layout(local_size_x = " str(FILTER_LOCAL_SIZE_X) ", "
-		       "local_size_y = " str(FILTER_LOCAL_SIZE_Y) ", "
-		       "local_size_z = " str(FILTER_LOCAL_SIZE_Z) ") in;\n\n"
-		));
+		if (ctx->kind == BeamformerShaderKind_FilterFFT) {
+			stream_append_s8(&sb, s8(""
+			"layout(local_size_x = " str(FILTER_FFT_LOCAL_SIZE_X) ", local_size_y = 1, local_size_z = 1) in;\n\n"
+			"#define FILTER_FFT      1\n"
+			"#define FILTER_FFT_SIZE " str(FILTER_FFT_SIZE) "\n\n"
+			));
+		} else {
+			stream_append_s8(&sb, s8(""
+			"layout(local_size_x = " str(FILTER_LOCAL_SIZE_X) ", "
+			       "local_size_y = " str(FILTER_LOCAL_SIZE_Y) ", "
+			       "local_size_z = " str(FILTER_LOCAL_SIZE_Z) ") in;\n\n"
+			"#define FILTER_FFT 0\n\n"
+			));
+		}
 	}break;
 	case BeamformerShaderKind_DAS:
 	case BeamformerShaderKind_DASFast:
+	case BeamformerShaderKind_DASDelayTables:
+	case BeamformerShaderKind_DASFastDelayTables:
+	case BeamformerShaderKind_DASFastTiled:
 	{
 		if (ctx->kind == BeamformerShaderKind_DAS) {
 			stream_append_s8(&sb, s8(""
@@ -742,19 +1886,57 @@ shader_text_with_header(ShaderReloadContext *ctx, OS *os, Arena *arena)
 			"#define DAS_FAST 0\n\n"
 			"layout(location = " str(DAS_VOXEL_OFFSET_UNIFORM_LOC) ") uniform ivec3 u_voxel_offset;\n"
 			));
+		} else if (ctx->kind == BeamformerShaderKind_DASDelayTables) {
+			stream_append_s8(&sb, s8(""
+			"layout(local_size_x = " str(DAS_FAST_LOCAL_SIZE_X) ", "
+			       "local_size_y = " str(DAS_FAST_LOCAL_SIZE_Y) ", "
+			       "local_size_z = " str(DAS_FAST_LOCAL_SIZE_Z) ") in;\n\n"
+			"#define DAS_FAST 0\n\n"
+			"layout(location = " str(DAS_VOXEL_OFFSET_UNIFORM_LOC) ") uniform ivec3 u_voxel_offset;\n"
+			));
 		} else {
 			stream_append_s8(&sb, s8(""
 			"layout(local_size_x = " str(DAS_FAST_LOCAL_SIZE_X) ", "
 			       "local_size_y = " str(DAS_FAST_LOCAL_SIZE_Y) ", "
 			       "local_size_z = " str(DAS_FAST_LOCAL_SIZE_Z) ") in;\n\n"
 			"#define DAS_FAST 1\n\n"
-			"layout(location = " str(DAS_FAST_CHANNEL_UNIFORM_LOC) ") uniform int   u_channel;\n"
+			"layout(location = " str(DAS_FAST_CHANNEL_UNIFORM_LOC)      ") uniform int   u_channel;\n"
+			"layout(location = " str(DAS_FAST_LAST_CHANNEL_UNIFORM_LOC) ") uniform int   u_last_channel;\n"
 			));
 		}
+		if (ctx->kind == BeamformerShaderKind_DASDelayTables)
+			stream_append_s8(&sb, s8("#define DAS_BUILD_DELAY_TABLES 1\n"));
+		else
+			stream_append_s8(&sb, s8("#define DAS_BUILD_DELAY_TABLES 0\n"));
+
+		if (ctx->kind == BeamformerShaderKind_DASFastDelayTables)
+			stream_append_s8(&sb, s8("#define DAS_DELAY_TABLES 1\n"));
+		else
+			stream_append_s8(&sb, s8("#define DAS_DELAY_TABLES 0\n"));
+
+		if (ctx->kind == BeamformerShaderKind_DASFastTiled)
+			stream_append_s8(&sb, s8("#define DAS_TILED_RF 1\n\n"));
+		else
+			stream_append_s8(&sb, s8("#define DAS_TILED_RF 0\n\n"));
+
+		if (ctx->das_specialized) {
+			DASSpecialization *ds = &ctx->das_specialization;
+			stream_append_s8(&sb, s8("#define das_shader_id       "));
+			stream_append_u64(&sb, ds->das_shader_id);
+			stream_append_s8s(&sb, s8("\n#define interpolate         "),
+			                  ds->interpolate ? s8("true") : s8("false"));
+			stream_append_s8s(&sb, s8("\n#define coherency_weighting "),
+			                  ds->coherency_weighting ? s8("true") : s8("false"));
+			stream_append_s8s(&sb, s8("\n#define DAS_IQ_DATA         "),
+			                  ds->iq_data ? s8("true") : s8("false"), s8("\n\n"));
+		}
+
 		#define X(type, id, pretty, fixed_tx) "#define DAS_ID_" #type " " #id "\n"
 		stream_append_s8(&sb, s8(""
-		"layout(location = " str(DAS_VOXEL_MATRIX_LOC)    ") uniform mat4  u_voxel_transform;\n"
-		"layout(location = " str(DAS_CYCLE_T_UNIFORM_LOC) ") uniform uint  u_cycle_t;\n\n"
+		"layout(location = " str(DAS_VOXEL_MATRIX_LOC)            ") uniform mat4  u_voxel_transform;\n"
+		"layout(location = " str(DAS_CYCLE_T_UNIFORM_LOC)         ") uniform uint  u_cycle_t;\n"
+		"layout(location = " str(DAS_RF_BATCH_STRIDE_UNIFORM_LOC) ") uniform int   u_rf_batch_stride;\n\n"
+		"#define DAS_DELAY_TABLES_MAX_SAMPLES " str(DAS_DELAY_TABLES_MAX_SAMPLES) "\n\n"
 		DAS_TYPES
 		));
 		#undef X
@@ -764,13 +1946,28 @@ shader_text_with_header(ShaderReloadContext *ctx, OS *os, Arena *arena)
 	case BeamformerShaderKind_DecodeFloatComplex:
 	case BeamformerShaderKind_DecodeInt16Complex:
 	case BeamformerShaderKind_DecodeInt16ToFloat:
+	case BeamformerShaderKind_DecodeFWHT:
+	case BeamformerShaderKind_DecodeFWHTInt16Complex:
+	case BeamformerShaderKind_DecodeFWHTFloat:
+	case BeamformerShaderKind_DecodeFWHTFloatComplex:
+	case BeamformerShaderKind_DecodeFWHTInt16ToFloat:
 	{
 		s8 define_table[] = {
-			[BeamformerShaderKind_DecodeFloatComplex] = s8("#define INPUT_DATA_TYPE_FLOAT_COMPLEX\n\n"),
-			[BeamformerShaderKind_DecodeFloat]        = s8("#define INPUT_DATA_TYPE_FLOAT\n\n"),
-			[BeamformerShaderKind_DecodeInt16Complex] = s8("#define INPUT_DATA_TYPE_INT16_COMPLEX\n\n"),
-			[BeamformerShaderKind_DecodeInt16ToFloat] = s8("#define OUTPUT_DATA_TYPE_FLOAT\n\n"),
+			[BeamformerShaderKind_DecodeFloatComplex]     = s8("#define INPUT_DATA_TYPE_FLOAT_COMPLEX\n\n"),
+			[BeamformerShaderKind_DecodeFloat]            = s8("#define INPUT_DATA_TYPE_FLOAT\n\n"),
+			[BeamformerShaderKind_DecodeInt16Complex]     = s8("#define INPUT_DATA_TYPE_INT16_COMPLEX\n\n"),
+			[BeamformerShaderKind_DecodeInt16ToFloat]     = s8("#define OUTPUT_DATA_TYPE_FLOAT\n\n"),
+			[BeamformerShaderKind_DecodeFWHTFloatComplex] = s8("#define INPUT_DATA_TYPE_FLOAT_COMPLEX\n\n"),
+			[BeamformerShaderKind_DecodeFWHTFloat]        = s8("#define INPUT_DATA_TYPE_FLOAT\n\n"),
+			[BeamformerShaderKind_DecodeFWHTInt16Complex] = s8("#define INPUT_DATA_TYPE_INT16_COMPLEX\n\n"),
+			[BeamformerShaderKind_DecodeFWHTInt16ToFloat] = s8("#define OUTPUT_DATA_TYPE_FLOAT\n\n"),
 		};
+		if (ctx->kind >= BeamformerShaderKind_DecodeFWHT && ctx->kind <= BeamformerShaderKind_DecodeFWHTInt16ToFloat) {
+			stream_append_s8(&sb, s8("#define DECODE_FWHT 1\n"
+			                         "#define DECODE_FWHT_MAX_TRANSMITS " str(DECODE_FWHT_MAX_TRANSMITS) "\n\n"));
+		} else {
+			stream_append_s8(&sb, s8("#define DECODE_FWHT 0\n\n"));
+		}
 		#define X(type, id, pretty) "#define DECODE_MODE_" #type " " #id "\n"
 		stream_append_s8s(&sb, define_table[ctx->kind], s8(""
 		"layout(local_size_x = " str(DECODE_LOCAL_SIZE_X) ", "
@@ -781,13 +1978,56 @@ shader_text_with_header(ShaderReloadContext *ctx, OS *os, Arena *arena)
 		));
 		#undef X
 	}break;
+	case BeamformerShaderKind_Hilbert:{
+		stream_append_s8(&sb, s8(""
+		"layout(local_size_x = " str(HILBERT_LOCAL_SIZE_X) ", local_size_y = 1, local_size_z = 1) in;\n\n"
+		"#define HILBERT_FFT_MAX_SIZE " str(HILBERT_FFT_MAX_SIZE) "\n\n"
+		"layout(location = " str(HILBERT_SAMPLE_COUNT_UNIFORM_LOC) ") uniform uint u_sample_count;\n"
+		"layout(location = " str(HILBERT_FFT_SIZE_UNIFORM_LOC)     ") uniform uint u_fft_size;\n\n"
+		));
+	}break;
+	case BeamformerShaderKind_FFT:
+	case BeamformerShaderKind_FFTRadix4:
+	case BeamformerShaderKind_FFTRadix8:
+	{
+		s8 radix = s8("2");
+		if (ctx->kind == BeamformerShaderKind_FFTRadix4) radix = s8("4");
+		if (ctx->kind == BeamformerShaderKind_FFTRadix8) radix = s8("8");
+		stream_append_s8s(&sb, s8("#define FFT_RADIX "), radix, s8("\n\n"));
+
+		#define X(name, id) "#define FFT_FLAG_" #name " (1u << " #id ")\n"
+		stream_append_s8(&sb, s8(""
+		"layout(local_size_x = " str(FFT_LOCAL_SIZE_X) ", local_size_y = 1, local_size_z = 1) in;\n\n"
+		"layout(location = " str(FFT_SIZE_UNIFORM_LOC)       ") uniform uint  u_fft_size;\n"
+		"layout(location = " str(FFT_STRIDE_UNIFORM_LOC)     ") uniform uint  u_stride;\n"
+		"layout(location = " str(FFT_LINE_COUNT_UNIFORM_LOC) ") uniform uint  u_line_count;\n"
+		"layout(location = " str(FFT_DIRECTION_UNIFORM_LOC)  ") uniform float u_direction;\n"
+		"layout(location = " str(FFT_FLAGS_UNIFORM_LOC)      ") uniform uint  u_flags;\n\n"
+		BEAMFORMER_FFT_FLAG_LIST
+		));
+		#undef X
+	}break;
+	case BeamformerShaderKind_LogCompress:{
+		stream_append_s8(&sb, s8(""
+		"layout(local_size_x = " str(LOG_COMPRESS_LOCAL_SIZE_X) ", "
+		       "local_size_y = " str(LOG_COMPRESS_LOCAL_SIZE_Y) ", "
+		       "local_size_z = " str(LOG_COMPRESS_LOCAL_SIZE_Z) ") in;\n\n"
+		));
+	}break;
 	case BeamformerShaderKind_MinMax:{
-		stream_append_s8(&sb, s8("layout(location = " str(MIN_MAX_MIPS_LEVEL_UNIFORM_LOC)
-		                         ") uniform int u_mip_map;\n\n"));
+		stream_append_s8(&sb, s8(""
+		"layout(local_size_x = " str(MIN_MAX_LOCAL_SIZE_X) ", "
+		       "local_size_y = " str(MIN_MAX_LOCAL_SIZE_Y) ", "
+		       "local_size_z = " str(MIN_MAX_LOCAL_SIZE_Z) ") in;\n\n"
+		"layout(location = " str(MIN_MAX_PASS_LEVELS_UNIFORM_LOC) ") uniform int u_pass_levels;\n"
+		"layout(location = " str(MIN_MAX_TAIL_LEVELS_UNIFORM_LOC) ") uniform int u_tail_levels;\n\n"
+		));
 	}break;
 	case BeamformerShaderKind_Sum:{
-		stream_append_s8(&sb, s8("layout(location = " str(SUM_PRESCALE_UNIFORM_LOC)
-		                         ") uniform float u_sum_prescale = 1.0;\n\n"));
+		stream_append_s8(&sb, s8(""
+		"layout(location = " str(SUM_PRESCALE_UNIFORM_LOC)  ") uniform float u_sum_prescale  = 1.0;\n"
+		"layout(location = " str(SUM_OUT_SCALE_UNIFORM_LOC) ") uniform float u_sum_out_scale = 1.0;\n\n"
+		));
 	}break;
 	default:{}break;
 	}
@@ -812,15 +2052,21 @@ DEBUG_EXPORT BEAMFORMER_RELOAD_SHADER_FN(beamformer_reload_shader)
 	s8  *shader_texts = push_array(&arena, s8,  shader_count);
 	u32 *shader_types = push_array(&arena, u32, shader_count);
 
+	/* NOTE(rnp): the key covers the full generated source (including all header defines)
+	 * so any change to the shader or the parameters baked into it misses the cache */
+	u64 cache_key = ctx->gl.program_binary_formats > 0 ? ctx->gl.driver_hash : 0;
+
 	i32 index = 0;
 	do {
 		shader_texts[index] = shader_text_with_header(link, os, &arena);
 		shader_types[index] = link->gl_type;
+		if (cache_key) cache_key = (cache_key ^ s8_hash(shader_texts[index])) * 31 + link->gl_type;
 		index++;
 		link = link->link;
 	} while (link != src);
 
-	u32 new_program = load_shader(&ctx->os, arena, shader_texts, shader_types, shader_count, shader_name);
+	u32 new_program = load_shader(&ctx->os, arena, shader_texts, shader_types, shader_count,
+	                              shader_name, cache_key);
 	if (new_program) {
 		glDeleteProgram(*src->shader);
 		*src->shader = new_program;
@@ -839,6 +2085,280 @@ reload_compute_shader(BeamformerCtx *ctx, ShaderReloadContext *src, s8 name_extr
 	return result;
 }
 
+function void
+das_compile_specialized_program(BeamformerCtx *ctx, BeamformerShaderKind kind, Arena arena)
+{
+	ComputeShaderCtx    *cs   = &ctx->csctx;
+	ShaderReloadContext *base = cs->shader_reload_contexts[BeamformerShaderKind_DAS];
+	if (base && !das_find_specialized_program(cs, kind)) {
+		u32 program = 0;
+		ShaderReloadContext src = *base;
+		src.kind               = kind;
+		src.shader             = &program;
+		src.link               = &src;
+		src.das_specialized    = 1;
+		src.das_specialization = cs->compute_pipeline.das_specialization;
+		reload_compute_shader(ctx, &src, s8(" (Specialized)"), arena);
+
+		/* NOTE(rnp): failures are also stored so that they aren't retried every frame */
+		u32 index;
+		if (cs->das_program_count < countof(cs->das_programs)) {
+			index = cs->das_program_count++;
+		} else {
+			index = cs->das_program_next++ % countof(cs->das_programs);
+			glDeleteProgram(cs->das_programs[index].program);
+		}
+		cs->das_programs[index] = (DASSpecializedProgram){
+			.specialization = src.das_specialization,
+			.kind           = kind,
+			.program        = program,
+		};
+	}
+}
+
+function void
+das_prepare_specialized_programs(BeamformerCtx *ctx, Arena arena)
+{
+	BeamformerComputePipeline *cp = &ctx->csctx.compute_pipeline;
+	for (i32 i = 0; i < cp->shader_count; i++) {
+		switch (cp->shaders[i]) {
+		case BeamformerShaderKind_DASFastDelayTables:{
+			das_compile_specialized_program(ctx, BeamformerShaderKind_DASDelayTables, arena);
+		} /* FALLTHROUGH */
+		case BeamformerShaderKind_DAS:
+		case BeamformerShaderKind_DASFast:
+		case BeamformerShaderKind_DASFastTiled:
+		{
+			das_compile_specialized_program(ctx, cp->shaders[i], arena);
+		}break;
+		default:{}break;
+		}
+	}
+}
+
+/* NOTE(rnp): internal variants are compiled from the same file as their base kind */
+read_only global struct {
+	BeamformerShaderKind base;
+	s8                   suffix;
+} compute_shader_variants[BeamformerShaderKind_ComputeCount] = {
+	[BeamformerShaderKind_Demodulate]             = {BeamformerShaderKind_Filter, s8_comp(" (Demodulate I16)")},
+	[BeamformerShaderKind_DemodulateFloat]        = {BeamformerShaderKind_Filter, s8_comp(" (Demodulate F32)")},
+	[BeamformerShaderKind_FilterFFT]              = {BeamformerShaderKind_Filter, s8_comp(" (FFT)")},
+	[BeamformerShaderKind_DecodeInt16Complex]     = {BeamformerShaderKind_Decode, s8_comp(" (I16C)")},
+	[BeamformerShaderKind_DecodeFloat]            = {BeamformerShaderKind_Decode, s8_comp(" (F32)")},
+	[BeamformerShaderKind_DecodeFloatComplex]     = {BeamformerShaderKind_Decode, s8_comp(" (F32C)")},
+	[BeamformerShaderKind_DecodeInt16ToFloat]     = {BeamformerShaderKind_Decode, s8_comp(" (I16-F32)")},
+	[BeamformerShaderKind_DecodeFWHT]             = {BeamformerShaderKind_Decode, s8_comp(" (I16, FWHT)")},
+	[BeamformerShaderKind_DecodeFWHTInt16Complex] = {BeamformerShaderKind_Decode, s8_comp(" (I16C, FWHT)")},
+	[BeamformerShaderKind_DecodeFWHTFloat]        = {BeamformerShaderKind_Decode, s8_comp(" (F32, FWHT)")},
+	[BeamformerShaderKind_DecodeFWHTFloatComplex] = {BeamformerShaderKind_Decode, s8_comp(" (F32C, FWHT)")},
+	[BeamformerShaderKind_DecodeFWHTInt16ToFloat] = {BeamformerShaderKind_Decode, s8_comp(" (I16-F32, FWHT)")},
+	[BeamformerShaderKind_DASFast]                = {BeamformerShaderKind_DAS,    s8_comp(" (Fast)")},
+	[BeamformerShaderKind_DASDelayTables]         = {BeamformerShaderKind_DAS,    s8_comp(" (Delay Tables Build)")},
+	[BeamformerShaderKind_DASFastDelayTables]     = {BeamformerShaderKind_DAS,    s8_comp(" (Fast, Delay Tables)")},
+	[BeamformerShaderKind_DASFastTiled]           = {BeamformerShaderKind_DAS,    s8_comp(" (Fast, Tiled RF)")},
+	[BeamformerShaderKind_FFTRadix4]              = {BeamformerShaderKind_FFT,    s8_comp(" (Radix 4)")},
+	[BeamformerShaderKind_FFTRadix8]              = {BeamformerShaderKind_FFT,    s8_comp(" (Radix 8)")},
+};
+
+function BeamformerShaderKind
+compute_shader_base_kind(BeamformerShaderKind kind)
+{
+	BeamformerShaderKind result = kind;
+	if (compute_shader_variants[kind].suffix.len > 0)
+		result = compute_shader_variants[kind].base;
+	return result;
+}
+
+function b32
+compile_compute_shader_variant(BeamformerCtx *ctx, BeamformerShaderKind kind, Arena arena)
+{
+	ComputeShaderCtx    *cs  = &ctx->csctx;
+	ShaderReloadContext *src = cs->shader_reload_contexts[compute_shader_base_kind(kind)];
+	b32 result = 0;
+	if (src) {
+		ShaderReloadContext variant = *src;
+		variant.kind   = kind;
+		variant.shader = cs->programs + kind;
+		variant.link   = &variant;
+		result = reload_compute_shader(ctx, &variant, compute_shader_variants[kind].suffix, arena);
+		cs->program_status[kind] = result ? ShaderCompileStatus_Compiled : ShaderCompileStatus_Failed;
+	}
+	return result;
+}
+
+/* NOTE(rnp): returns true if kind has a usable program. a failed compile is not retried
+ * until the source changes */
+function b32
+compute_shader_variant_ensure(BeamformerCtx *ctx, BeamformerShaderKind kind, Arena arena)
+{
+	ComputeShaderCtx *cs = &ctx->csctx;
+	b32 result = 1;
+	/* NOTE(rnp): kinds without a source file (CUDA stages) have no program */
+	if (cs->shader_reload_contexts[compute_shader_base_kind(kind)]) {
+		if (cs->program_status[kind] == ShaderCompileStatus_Stale)
+			compile_compute_shader_variant(ctx, kind, arena);
+		result = cs->program_status[kind] == ShaderCompileStatus_Compiled;
+	}
+	return result;
+}
+
+function b32
+prepare_compute_pipeline_programs(BeamformerCtx *ctx, Arena arena)
+{
+	BeamformerComputePipeline *cp = &ctx->csctx.compute_pipeline;
+	/* NOTE(rnp): frame averaging runs outside of the pipeline */
+	b32 result = compute_shader_variant_ensure(ctx, BeamformerShaderKind_Sum, arena);
+	for (i32 i = 0; i < cp->shader_count; i++) {
+		if (cp->shaders[i] == BeamformerShaderKind_DASFastDelayTables)
+			result &= compute_shader_variant_ensure(ctx, BeamformerShaderKind_DASDelayTables, arena);
+		if (cp->shaders[i] == BeamformerShaderKind_HilbertBatchedFFT) {
+			result &= compute_shader_variant_ensure(ctx, BeamformerShaderKind_FFT,       arena);
+			result &= compute_shader_variant_ensure(ctx, BeamformerShaderKind_FFTRadix4, arena);
+			result &= compute_shader_variant_ensure(ctx, BeamformerShaderKind_FFTRadix8, arena);
+		}
+		result &= compute_shader_variant_ensure(ctx, cp->shaders[i], arena);
+	}
+	return result;
+}
+
+/* NOTE(rnp): marks every variant built from base as needing a recompile */
+function void
+invalidate_compute_shader_variants(ComputeShaderCtx *cs, BeamformerShaderKind base)
+{
+	for (i32 i = 0; i < BeamformerShaderKind_ComputeCount; i++) {
+		if (i != (i32)base && compute_shader_base_kind((BeamformerShaderKind)i) == base)
+			cs->program_status[i] = ShaderCompileStatus_Stale;
+	}
+
+	if (base == BeamformerShaderKind_DAS) {
+		cs->delay_tables_hash = 0;
+		das_clear_specialized_programs(cs);
+	}
+}
+
+/* NOTE(rnp): compiles the program for src->kind. internal variants built from the same
+ * file are only compiled once the pipeline needs them (or the worker is idle) */
+function b32
+reload_compute_shader_variants(BeamformerCtx *ctx, ShaderReloadContext *src, Arena arena)
+{
+	ComputeShaderCtx *cs = &ctx->csctx;
+	b32 result = reload_compute_shader(ctx, src, s8(""), arena);
+	cs->program_status[src->kind] = result ? ShaderCompileStatus_Compiled : ShaderCompileStatus_Failed;
+	invalidate_compute_shader_variants(cs, src->kind);
+	result &= prepare_compute_pipeline_programs(ctx, arena);
+	return result;
+}
+
+/* NOTE(rnp): compiles stale variants one at a time until new work shows up */
+function void
+compile_idle_compute_shader_variants(BeamformerCtx *ctx, Arena arena)
+{
+	BeamformerSharedMemory *sm = ctx->shared_memory.region;
+	for (i32 i = 0; i < BeamformerShaderKind_ComputeCount; i++) {
+		if (beamform_work_queue_pop(&sm->external_work_queue) ||
+		    beamform_work_queue_pop(ctx->beamform_work_queue))
+		{
+			break;
+		}
+		compute_shader_variant_ensure(ctx, (BeamformerShaderKind)i, arena);
+	}
+}
+
+/* NOTE(rnp): stores the DAS input of a frame whose earlier stages have been submitted.
+ * the copy is ordered on the GPU so the intermediate buffers are immediately free */
+function void
+das_batch_push(BeamformerCtx *ctx, BeamformerFrame *frame)
+{
+	ComputeShaderCtx          *cs = &ctx->csctx;
+	BeamformerComputePipeline *cp = &cs->compute_pipeline;
+
+	uz batch_size = (uz)cp->rf_size * cp->das_batch_count;
+	if (cs->das_batch_ssbo_size < batch_size) {
+		glDeleteBuffers(1, &cs->das_batch_ssbo);
+		glCreateBuffers(1, &cs->das_batch_ssbo);
+		glNamedBufferStorage(cs->das_batch_ssbo, (iz)batch_size, 0, 0);
+		LABEL_GL_OBJECT(GL_BUFFER, cs->das_batch_ssbo, s8("DAS_Batch_Input"));
+		cs->das_batch_ssbo_size = batch_size;
+	}
+
+	u32 index = cs->das_batch_frame_count++;
+	glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+	glCopyNamedBufferSubData(cs->rf_data_ssbos[cs->rf_data_set][cs->last_output_ssbo_index],
+	                         cs->das_batch_ssbo, 0, (iz)index * cp->rf_size, cp->rf_size);
+	cs->das_batch_frames[index] = frame;
+}
+
+/* NOTE(rnp): beamforms every pending frame with one DAS dispatch series. the frames are
+ * stacked along y of das_batch_frame (2D outputs always have a single y point) and each
+ * slice is then copied into its own frame. the remaining stages run per frame and the
+ * whole batch is retired as a single in flight frame */
+function void
+das_batch_flush(BeamformerCtx *ctx, Arena arena)
+{
+	ComputeShaderCtx          *cs = &ctx->csctx;
+	BeamformerComputePipeline *cp = &cs->compute_pipeline;
+	u32 count = cs->das_batch_frame_count;
+	if (count) {
+		BeamformerFrame *last = cs->das_batch_frames[count - 1];
+		i32 das_stage = compute_pipeline_das_stage(cp);
+
+		while (cs->in_flight_frames_submitted - cs->in_flight_frames_retired >= countof(cs->in_flight_frames))
+			retire_in_flight_frame(ctx, (u64)-1);
+		u32 in_flight_slot = cs->in_flight_frames_submitted % countof(cs->in_flight_frames);
+
+		/* NOTE(rnp): the batch's frames hold the last count timer query slots. the shared
+		 * stages are timed in the slot of the last frame */
+		u32 first_tqf = cs->timer_query_frames_submitted - count;
+		BeamformerTimerQueryFrame *tqf = cs->timer_query_frames +
+		                                 (cs->timer_query_frames_submitted - 1) % countof(cs->timer_query_frames);
+
+		BeamformerFrame *bf = &ctx->das_batch_frame;
+		iv3 batch_dim = last->dim;
+		batch_dim.y   = (i32)count;
+		if (!iv3_equal(bf->dim, batch_dim) || bf->format != last->format)
+			alloc_beamform_frame(&ctx->gl, bf, batch_dim, last->format, s8("DAS_Batch"), arena);
+
+		glBeginQuery(GL_TIME_ELAPSED, tqf->ids[das_stage]);
+		do_compute_shader(ctx, arena, bf, das_stage);
+		for (u32 i = 0; i < count; i++) {
+			BeamformerFrame *frame = cs->das_batch_frames[i];
+			glCopyImageSubData(bf->texture,    GL_TEXTURE_3D, 0, 0, (i32)i, 0,
+			                   frame->texture, GL_TEXTURE_3D, 0, 0, 0,      0,
+			                   frame->dim.x, 1, frame->dim.z);
+		}
+		glEndQuery(GL_TIME_ELAPSED);
+
+		for (i32 i = das_stage + 1; i < cp->shader_count; i++) {
+			glBeginQuery(GL_TIME_ELAPSED, tqf->ids[i]);
+			for (u32 j = 0; j < count; j++)
+				do_compute_shader(ctx, arena, cs->das_batch_frames[j], i);
+			glEndQuery(GL_TIME_ELAPSED);
+		}
+		glQueryCounter(tqf->timestamp_ids[1], GL_TIMESTAMP);
+
+		tqf->shader_count = cp->shader_count;
+		for (u32 i = 0; i < count; i++) {
+			BeamformerTimerQueryFrame *frame_tqf = cs->timer_query_frames +
+			                                       (first_tqf + i) % countof(cs->timer_query_frames);
+			frame_tqf->batch_stage = das_stage;
+			frame_tqf->batch_count = count;
+		}
+
+		BeamformerInFlightFrame *iff = cs->in_flight_frames + in_flight_slot;
+		iff->frame             = last;
+		iff->averaged_frame    = 0;
+		iff->batch_frame_count = count - 1;
+		iff->cancelled         = 0;
+		mem_copy(iff->batch_frames, cs->das_batch_frames, (count - 1) * sizeof(*iff->batch_frames));
+		iff->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		glFlush();
+		cs->in_flight_frames_submitted++;
+
+		cs->das_batch_frame_count = 0;
+	}
+}
+
 function void
 complete_queue(BeamformerCtx *ctx, BeamformWorkQueue *q, Arena arena, iptr gl_context)
 {
@@ -849,54 +2369,16 @@ complete_queue(BeamformerCtx *ctx, BeamformWorkQueue *q, Arena arena, iptr gl_co
 	BeamformWork *work = beamform_work_queue_pop(q);
 	while (work) {
 		b32 can_commit = 1;
+		/* NOTE(rnp): anything besides more frames may depend on the pending frames */
+		if (work->kind != BeamformerWorkKind_Compute && work->kind != BeamformerWorkKind_ComputeIndirect)
+			das_batch_flush(ctx, arena);
 		switch (work->kind) {
 		case BeamformerWorkKind_ReloadShader:{
 			ShaderReloadContext *src = work->shader_reload_context;
-			b32 success = reload_compute_shader(ctx, src, s8(""), arena);
-			/* TODO(rnp): think of a better way of doing this */
-			switch (src->kind) {
-			case BeamformerShaderKind_DAS:{
-				src->kind   = BeamformerShaderKind_DASFast;
-				src->shader = cs->programs + src->kind;
-				success &= reload_compute_shader(ctx, src, s8(" (Fast)"), arena);
-
-				src->kind   = BeamformerShaderKind_DAS;
-				src->shader = cs->programs + src->kind;
-			}break;
-			case BeamformerShaderKind_Decode:{
-				src->kind   = BeamformerShaderKind_DecodeFloatComplex;
-				src->shader = cs->programs + src->kind;
-				success &= reload_compute_shader(ctx, src, s8(" (F32C)"), arena);
-
-				src->kind   = BeamformerShaderKind_DecodeFloat;
-				src->shader = cs->programs + src->kind;
-				success &= reload_compute_shader(ctx, src, s8(" (F32)"),  arena);
-
-				src->kind   = BeamformerShaderKind_DecodeInt16Complex;
-				src->shader = cs->programs + src->kind;
-				success &= reload_compute_shader(ctx, src, s8(" (I16C)"),  arena);
+			b32 success = reload_compute_shader_variants(ctx, src, arena);
 
-				src->kind   = BeamformerShaderKind_DecodeInt16ToFloat;
-				src->shader = cs->programs + src->kind;
-				success &= reload_compute_shader(ctx, src, s8(" (I16-F32)"),  arena);
-
-				src->kind   = BeamformerShaderKind_Decode;
-				src->shader = cs->programs + src->kind;
-			}break;
-			case BeamformerShaderKind_Filter:{
-				src->kind   = BeamformerShaderKind_Demodulate;
-				src->shader = cs->programs + src->kind;
-				success &= reload_compute_shader(ctx, src, s8(" (Demodulate I16)"), arena);
-
-				src->kind   = BeamformerShaderKind_DemodulateFloat;
-				src->shader = cs->programs + src->kind;
-				success &= reload_compute_shader(ctx, src, s8(" (Demodulate F32)"), arena);
-
-				src->kind   = BeamformerShaderKind_Filter;
-				src->shader = cs->programs + src->kind;
-			}break;
-			default:{}break;
-			}
+			if (src->kind != BeamformerShaderKind_DAS)
+				cs->das_input_valid = 0;
 
 			if (success && ctx->latest_frame && !sm->live_imaging_parameters.active) {
 				fill_frame_compute_work(ctx, work, ctx->latest_frame->view_plane_tag, 0);
@@ -904,6 +2386,8 @@ complete_queue(BeamformerCtx *ctx, BeamformWorkQueue *q, Arena arena, iptr gl_co
 			}
 		}break;
 		case BeamformerWorkKind_ExportBuffer:{
+			/* NOTE(rnp): exports refer to the latest frame so anything in flight must land first */
+			retire_all_in_flight_frames(ctx);
 			/* TODO(rnp): better way of handling DispatchCompute barrier */
 			post_sync_barrier(&ctx->shared_memory, BeamformerSharedMemoryLockKind_DispatchCompute, sm->locks);
 			os_shared_memory_region_lock(&ctx->shared_memory, sm->locks, (i32)work->lock, (u32)-1);
@@ -915,13 +2399,38 @@ complete_queue(BeamformerCtx *ctx, BeamformWorkQueue *q, Arena arena, iptr gl_co
 					assert(frame->ready_to_present);
 					u32 texture  = frame->texture;
 					iv3 dim      = frame->dim;
-					u32 out_size = (u32)dim.x * (u32)dim.y * (u32)dim.z * 2 * sizeof(f32);
+					u32 out_size = (u32)dim.x * (u32)dim.y * (u32)dim.z *
+					               beamformer_output_format_voxel_size(frame->format);
 					if (out_size <= ec->size) {
-						glGetTextureImage(texture, 0, GL_RG, GL_FLOAT, (i32)out_size,
+						glGetTextureImage(texture, 0, beamformer_output_format_gl[frame->format].format,
+						                  beamformer_output_format_gl[frame->format].type, (i32)out_size,
 						                  (u8 *)sm + BEAMFORMER_SCRATCH_OFF);
 					}
 				}
 			}break;
+			case BeamformerExportKind_CompressedData:{
+				BeamformerFrame *frame = ctx->latest_frame;
+				if (frame && frame->compressed_valid) {
+					iv3 dim      = frame->compressed_dim;
+					u32 voxel    = frame->compressed_bit_depth / 8;
+					u32 out_size = (u32)dim.x * (u32)dim.y * (u32)dim.z * voxel;
+					if (out_size <= ec->size) {
+						glGetTextureImage(frame->compressed_texture, 0, GL_RED,
+						                  voxel == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_BYTE,
+						                  (i32)out_size, (u8 *)sm + BEAMFORMER_SCRATCH_OFF);
+					}
+				}
+			}break;
+			case BeamformerExportKind_RFData:{
+				/* NOTE(rnp): output of the last stage which wrote decoded RF data; this is
+				 * the DAS input when the pipeline has a DAS stage */
+				BeamformerComputePipeline *cp = &cs->compute_pipeline;
+				if (cp->rf_size <= ec->size) {
+					glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+					glGetNamedBufferSubData(cs->rf_data_ssbos[cs->rf_data_set][cs->last_output_ssbo_index],
+					                        0, (iz)cp->rf_size, (u8 *)sm + BEAMFORMER_SCRATCH_OFF);
+				}
+			}break;
 			case BeamformerExportKind_Stats:{
 				ComputeTimingTable *table = ctx->compute_timing_table;
 				/* NOTE(rnp): do a little spin to let this finish updating */
@@ -938,6 +2447,9 @@ complete_queue(BeamformerCtx *ctx, BeamformWorkQueue *q, Arena arena, iptr gl_co
 		case BeamformerWorkKind_CreateFilter:{
 			BeamformerCreateFilterContext *fctx = &work->create_filter_context;
 			beamformer_filter_update(cs->filters + fctx->slot, fctx->kind, fctx->parameters, arena);
+			cs->das_input_valid = 0;
+			/* NOTE(rnp): the length decides between direct form and FFT filtering */
+			mark_shared_memory_region_dirty(sm, BeamformerSharedMemoryLockKind_ComputePipeline);
 		}break;
 		case BeamformerWorkKind_UploadBuffer:{
 			os_shared_memory_region_lock(&ctx->shared_memory, sm->locks, (i32)work->lock, (u32)-1);
@@ -950,19 +2462,22 @@ complete_queue(BeamformerCtx *ctx, BeamformWorkQueue *q, Arena arena, iptr gl_co
 				tex_type          = GL_SHORT;
 				tex_format        = GL_RED_INTEGER;
 				tex_element_count = countof(sm->channel_mapping);
-				cs->cuda_lib.set_channel_mapping(sm->channel_mapping);
+				cs->external_stages.set_channel_mapping(sm->channel_mapping);
+				cs->das_input_valid = 0;
 			}break;
 			case BeamformerUploadKind_FocalVectors:{
 				tex_1d            = cs->focal_vectors_texture;
 				tex_type          = GL_FLOAT;
 				tex_format        = GL_RG;
 				tex_element_count = countof(sm->focal_vectors);
+				cs->delay_tables_hash = 0;
 			}break;
 			case BeamformerUploadKind_SparseElements:{
 				tex_1d            = cs->sparse_elements_texture;
 				tex_type          = GL_SHORT;
 				tex_format        = GL_RED_INTEGER;
 				tex_element_count = countof(sm->sparse_elements);
+				cs->delay_tables_hash = 0;
 			}break;
 			InvalidDefaultCase;
 			}
@@ -984,59 +2499,118 @@ complete_queue(BeamformerCtx *ctx, BeamformWorkQueue *q, Arena arena, iptr gl_co
 			fill_frame_compute_work(ctx, work, work->compute_indirect_plane, 1);
 		} /* FALLTHROUGH */
 		case BeamformerWorkKind_Compute:{
-			DEBUG_DECL(glClearNamedBufferData(cs->rf_data_ssbos[0], GL_RG32F, GL_RG, GL_FLOAT, 0);)
-			DEBUG_DECL(glClearNamedBufferData(cs->rf_data_ssbos[1], GL_RG32F, GL_RG, GL_FLOAT, 0);)
-			DEBUG_DECL(glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);)
-
-			push_compute_timing_info(ctx->compute_timing_table,
-			                         (ComputeTimingInfo){.kind = ComputeTimingInfoKind_ComputeFrameBegin});
-
 			BeamformerComputePipeline *cp = &cs->compute_pipeline;
 			u32 mask = (1 << (BeamformerSharedMemoryLockKind_Parameters - 1)) |
 			           (1 << (BeamformerSharedMemoryLockKind_ComputePipeline - 1));
 			if (sm->dirty_regions & mask) {
+				das_batch_flush(ctx, arena);
 				if (cs->rf_raw_size != cs->rf_buffer.rf_size ||
 				    !uv4_equal(cs->dec_data_dim, uv4_from_u32_array(bp->dec_data_dim)))
 				{
 					alloc_shader_storage(ctx, cs->rf_buffer.rf_size, arena);
 				}
 
-				plan_compute_pipeline(&ctx->shared_memory, cp, cs->filters);
+				u64 last_das_input_hash = cp->das_input_hash;
+				plan_compute_pipeline(&ctx->shared_memory, &ctx->gl, cp, cs->filters,
+				                      cs->external_stages.backend);
+				if (last_das_input_hash != cp->das_input_hash)
+					cs->das_input_valid = 0;
+
+				b32 recompile = cs->output_format != cp->output_format;
+				cs->output_format = cp->output_format;
+				if (cs->rf_data_half != cp->rf_data_half) {
+					cs->rf_data_half = cp->rf_data_half;
+					alloc_shader_storage(ctx, cs->rf_buffer.rf_size, arena);
+					recompile = 1;
+				}
+				if (recompile) {
+					for (i32 i = 0; i < countof(cs->shader_reload_contexts); i++) {
+						if (cs->shader_reload_contexts[i]) {
+							cs->program_status[i] = ShaderCompileStatus_Stale;
+							invalidate_compute_shader_variants(cs, (BeamformerShaderKind)i);
+						}
+					}
+				}
 				atomic_store_u32(&ctx->ui_read_params, ctx->beamform_work_queue != q);
 				atomic_and_u32(&sm->dirty_regions, ~mask);
 
-				#define X(k, t, v) glNamedBufferSubData(cp->ubos[BeamformerComputeUBOKind_##k], \
-				                                        0, sizeof(t), &cp->v ## _ubo_data);
-				BEAMFORMER_COMPUTE_UBO_LIST
-				#undef X
+				Arena scratch = arena;
+				u8 *ubo_data  = push_array(&scratch, u8, cp->ubo_stride * (u32)cp->shader_count);
+				for (i32 i = 0; i < cp->shader_count; i++) {
+					mem_copy(ubo_data + (u32)i * cp->ubo_stride, cp->stage_ubo_data + i,
+					         sizeof(*cp->stage_ubo_data));
+				}
+				glNamedBufferSubData(cp->ubo, 0, (i32)(cp->ubo_stride * (u32)cp->shader_count), ubo_data);
 			}
 
 			post_sync_barrier(&ctx->shared_memory, work->lock, sm->locks);
 
+			prepare_compute_pipeline_programs(ctx, arena);
+			das_prepare_specialized_programs(ctx, arena);
+
 			atomic_store_u32(&cs->processing_compute, 1);
 			start_renderdoc_capture(gl_context);
 
 			BeamformerFrame *frame = work->frame;
+			BeamformerOutputFormat format = cs->output_format;
 			iv3 try_dim = make_valid_test_dim(bp->output_points);
-			if (!iv3_equal(try_dim, frame->dim))
-				alloc_beamform_frame(&ctx->gl, frame, try_dim, s8("Beamformed_Data"), arena);
+			if (!iv3_equal(try_dim, frame->dim) || frame->format != format)
+				alloc_beamform_frame(&ctx->gl, frame, try_dim, format, s8("Beamformed_Data"), arena);
 
-			if (bp->output_points[3] > 1) {
-				if (!iv3_equal(try_dim, ctx->averaged_frames[0].dim)) {
-					alloc_beamform_frame(&ctx->gl, ctx->averaged_frames + 0, try_dim, s8("Averaged Frame"), arena);
-					alloc_beamform_frame(&ctx->gl, ctx->averaged_frames + 1, try_dim, s8("Averaged Frame"), arena);
-				}
+			BeamformerFrame *aframe = ctx->averaged_frames;
+			if (bp->output_points[3] > 1 && (!iv3_equal(try_dim, aframe->dim) || aframe->format != format)) {
+				for (i32 i = 0; i < countof(ctx->averaged_frames); i++)
+					alloc_beamform_frame(&ctx->gl, aframe + i, try_dim, format, s8("Averaged Frame"), arena);
+			}
+
+			frame->min_coordinate   = v4_from_f32_array(bp->output_min_coordinate);
+			frame->max_coordinate   = v4_from_f32_array(bp->output_max_coordinate);
+			frame->das_shader_kind  = bp->das_shader_id;
+			frame->compound_count   = bp->dec_data_dim[2];
+			frame->compressed_valid = 0;
+
+			/* NOTE(rnp): if no new data has arrived and nothing feeding the earlier stages has
+			 * changed we only need to rerun from DAS onwards */
+			BeamformerRFBuffer *rf = &cs->rf_buffer;
+			i32 das_stage   = compute_pipeline_das_stage(cp);
+			i32 first_stage = 0;
+			if (cs->das_input_valid && das_stage > 0 && work->kind == BeamformerWorkKind_Compute &&
+			    !atomic_load_u64(rf->upload_syncs + rf->compute_index % countof(rf->upload_syncs)))
+			{
+				first_stage = das_stage;
 			}
 
-			frame->min_coordinate  = v4_from_f32_array(bp->output_min_coordinate);
-			frame->max_coordinate  = v4_from_f32_array(bp->output_max_coordinate);
-			frame->das_shader_kind = bp->das_shader_id;
-			frame->compound_count  = bp->dec_data_dim[2];
+			/* NOTE(rnp): consecutive full 2D frames stop before DAS and are beamformed
+			 * together (see das_batch_flush) */
+			b32 batch = first_stage == 0 && das_stage > 0 && cp->das_batch_count > 1 && frame->dim.y == 1;
+			if (!batch) das_batch_flush(ctx, arena);
+
+			/* NOTE(rnp): wait for a free in flight slot. at most BEAMFORMER_MAX_FRAMES_IN_FLIGHT - 1
+			 * frames remain and they all read the most recent intermediate set. a full frame
+			 * moves to the next set so its early stages are free to run while those frames'
+			 * DAS is still executing. a DAS only rerun must read the set the last full frame
+			 * left behind */
+			while (cs->in_flight_frames_submitted - cs->in_flight_frames_retired >= countof(cs->in_flight_frames))
+				retire_in_flight_frame(ctx, (u64)-1);
+			u32 in_flight_slot = cs->in_flight_frames_submitted % countof(cs->in_flight_frames);
+
+			if (cs->timer_query_frames_submitted - cs->timer_query_frames_collected >= countof(cs->timer_query_frames))
+				collect_compute_timer_queries(ctx, 1);
+			BeamformerTimerQueryFrame *tqf = cs->timer_query_frames +
+			                                 cs->timer_query_frames_submitted % countof(cs->timer_query_frames);
+			u32 *timer_ids = tqf->ids;
+
+			cs->das_refinement_cancelled = 0;
+			if (first_stage == 0) {
+				cs->rf_data_set = (cs->rf_data_set + 1) % countof(cs->rf_data_ssbos);
+				DEBUG_DECL(glClearNamedBufferData(cs->rf_data_ssbos[cs->rf_data_set][0], GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, 0);)
+				DEBUG_DECL(glClearNamedBufferData(cs->rf_data_ssbos[cs->rf_data_set][1], GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, 0);)
+				DEBUG_DECL(glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);)
+			}
 
 			/* NOTE(rnp): first stage requires access to raw data buffer directly so we break
 			 * it out into a separate step. This way data can get release as soon as possible */
-			if (cp->shader_count > 0) {
-				BeamformerRFBuffer *rf = &cs->rf_buffer;
+			if (first_stage == 0 && cp->shader_count > 0) {
 				u32 slot = rf->compute_index % countof(rf->compute_syncs);
 
 				/* NOTE(rnp): compute indirect is used when uploading data. in this case the thread
@@ -1054,8 +2628,9 @@ complete_queue(BeamformerCtx *ctx, BeamformWorkQueue *q, Arena arena, iptr gl_co
 
 				glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 1, rf->ssbo, slot * rf->rf_size, rf->rf_size);
 
-				glBeginQuery(GL_TIME_ELAPSED, cs->shader_timer_ids[0]);
-				do_compute_shader(ctx, arena, frame, cp->shaders[0], cp->shader_parameters + 0);
+				glQueryCounter(tqf->timestamp_ids[0], GL_TIMESTAMP);
+				glBeginQuery(GL_TIME_ELAPSED, timer_ids[0]);
+				do_compute_shader(ctx, arena, frame, 0);
 				glEndQuery(GL_TIME_ELAPSED);
 
 				if (work->kind == BeamformerWorkKind_ComputeIndirect) {
@@ -1066,37 +2641,51 @@ complete_queue(BeamformerCtx *ctx, BeamformWorkQueue *q, Arena arena, iptr gl_co
 			}
 
 			b32 did_sum_shader = 0;
-			for (i32 i = 1; i < cp->shader_count; i++) {
+			i32 stage_end = batch ? das_stage : cp->shader_count;
+			if (first_stage > 0) glQueryCounter(tqf->timestamp_ids[0], GL_TIMESTAMP);
+			for (i32 i = MAX(first_stage, 1); i < stage_end; i++) {
 				did_sum_shader |= cp->shaders[i] == BeamformerShaderKind_Sum;
-				glBeginQuery(GL_TIME_ELAPSED, cs->shader_timer_ids[i]);
-				do_compute_shader(ctx, arena, frame, cp->shaders[i], cp->shader_parameters + i);
+				glBeginQuery(GL_TIME_ELAPSED, timer_ids[i]);
+				do_compute_shader(ctx, arena, frame, i);
 				glEndQuery(GL_TIME_ELAPSED);
+				/* NOTE(rnp): a cancelled progressive refinement leaves nothing for later stages */
+				if (cs->das_refinement_cancelled) stage_end = i + 1;
 			}
-
-			/* NOTE(rnp): the first of these blocks until work completes */
-			for (i32 i = 0; i < cp->shader_count; i++) {
-				ComputeTimingInfo info = {0};
-				info.kind   = ComputeTimingInfoKind_Shader;
-				info.shader = cp->shaders[i];
-				glGetQueryObjectui64v(cs->shader_timer_ids[i], GL_QUERY_RESULT, &info.timer_count);
-				push_compute_timing_info(ctx->compute_timing_table, info);
-			}
-			cs->processing_progress = 1;
-
-			frame->ready_to_present = 1;
-			if (did_sum_shader) {
-				u32 aframe_index = (ctx->averaged_frame_index % countof(ctx->averaged_frames));
-				ctx->averaged_frames[aframe_index].view_plane_tag  = frame->view_plane_tag;
-				ctx->averaged_frames[aframe_index].ready_to_present = 1;
-				atomic_add_u32(&ctx->averaged_frame_index, 1);
-				atomic_store_u64((u64 *)&ctx->latest_frame, (u64)(ctx->averaged_frames + aframe_index));
+			cs->das_input_valid = das_stage > 0;
+
+			/* NOTE(rnp): nothing here waits on the GPU. the frame is presented when it is
+			 * retired and its timings are collected once they are available. a batched
+			 * frame's timings are completed when its batch is flushed */
+			if (!batch) glQueryCounter(tqf->timestamp_ids[1], GL_TIMESTAMP);
+			tqf->first_stage  = first_stage;
+			tqf->shader_count = stage_end;
+			tqf->batch_stage  = stage_end;
+			tqf->batch_index  = batch ? cs->das_batch_frame_count : 0;
+			tqf->batch_count  = batch ? 0 : 1;
+			mem_copy(tqf->shaders, cp->shaders, sizeof(tqf->shaders));
+			mem_copy(tqf->stage_work, cp->stage_work, sizeof(tqf->stage_work));
+			cs->timer_query_frames_submitted++;
+
+			if (batch) {
+				das_batch_push(ctx, frame);
+				if (cs->das_batch_frame_count == cp->das_batch_count) das_batch_flush(ctx, arena);
+				else                                                  glFlush();
 			} else {
-				atomic_store_u64((u64 *)&ctx->latest_frame, (u64)frame);
+				BeamformerInFlightFrame *iff = cs->in_flight_frames + in_flight_slot;
+				iff->frame             = frame;
+				iff->averaged_frame    = 0;
+				iff->batch_frame_count = 0;
+				iff->cancelled         = cs->das_refinement_cancelled;
+				if (did_sum_shader) {
+					/* NOTE(rnp): the next frame's sum must start from this frame's average */
+					u32 aframe_index    = ctx->averaged_frame_index % countof(ctx->averaged_frames);
+					iff->averaged_frame = ctx->averaged_frames + aframe_index;
+					atomic_add_u32(&ctx->averaged_frame_index, 1);
+				}
+				iff->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+				glFlush();
+				cs->in_flight_frames_submitted++;
 			}
-			cs->processing_compute  = 0;
-
-			push_compute_timing_info(ctx->compute_timing_table,
-			                         (ComputeTimingInfo){.kind = ComputeTimingInfoKind_ComputeFrameEnd});
 
 			end_renderdoc_capture(gl_context);
 		}break;
@@ -1108,8 +2697,61 @@ complete_queue(BeamformerCtx *ctx, BeamformWorkQueue *q, Arena arena, iptr gl_co
 			work = beamform_work_queue_pop(q);
 		}
 	}
+	das_batch_flush(ctx, arena);
+}
+
+function u32
+latency_histogram_bucket(f32 seconds)
+{
+	u32 sub_buckets = 1u << BEAMFORMER_LATENCY_SUB_BUCKET_BITS;
+	u64 units       = (u64)(seconds * 1.0e9f) >> BEAMFORMER_LATENCY_MIN_SHIFT;
+	u32 value       = (u32)MIN(units, U32_MAX);
+	u32 result      = value;
+	if (value >= sub_buckets) {
+		u32 msb = 31 - clz_u32(value);
+		result  = (msb - BEAMFORMER_LATENCY_SUB_BUCKET_BITS + 1) * sub_buckets +
+		          ((value >> (msb - BEAMFORMER_LATENCY_SUB_BUCKET_BITS)) & (sub_buckets - 1));
+	}
+	result = MIN(result, BEAMFORMER_LATENCY_BUCKETS - 1);
+	return result;
+}
+
+function f32
+latency_histogram_bucket_end(u32 bucket)
+{
+	u32 sub_buckets = 1u << BEAMFORMER_LATENCY_SUB_BUCKET_BITS;
+	u64 units       = bucket + 1;
+	if (bucket >= sub_buckets)
+		units = (u64)(sub_buckets + bucket % sub_buckets + 1) << (bucket / sub_buckets - 1);
+	f32 result = (f32)(units << BEAMFORMER_LATENCY_MIN_SHIFT) / 1.0e9f;
+	return result;
+}
+
+function void
+latency_histogram_push(BeamformerLatencyHistogram *h, f32 seconds)
+{
+	h->buckets[latency_histogram_bucket(seconds)]++;
+	h->count++;
+	h->max = MAX(h->max, seconds);
+}
+
+function void
+latency_histogram_update_percentiles(BeamformerLatencyHistogram *h)
+{
+	read_only local_persist f32 fractions[] = {0.5f, 0.9f, 0.99f};
+	f32 *outputs[countof(fractions)] = {&h->p50, &h->p90, &h->p99};
+
+	u32 cumulative = 0, p = 0;
+	for (u32 i = 0; i < BEAMFORMER_LATENCY_BUCKETS && p < countof(fractions); i++) {
+		cumulative += h->buckets[i];
+		while (p < countof(fractions) && (f32)cumulative >= fractions[p] * (f32)h->count)
+			*outputs[p++] = MIN(latency_histogram_bucket_end(i), h->max);
+	}
 }
 
+/* NOTE(rnp): the 32 frame table is averaged on every update while the latency histograms
+ * accumulate every frame since the last reset. everything is derived from the timing table
+ * alone; the work behind each time was recorded with it by the compute thread */
 function void
 coalesce_timing_table(ComputeTimingTable *t, ComputeShaderStats *stats)
 {
@@ -1122,6 +2764,8 @@ coalesce_timing_table(ComputeTimingTable *t, ComputeShaderStats *stats)
 	static_assert(BeamformerShaderKind_Count + 1 <= 32, "timing coalescence bitfield test");
 	u32 seen_info_test = 0;
 
+	u32 latency_updated = 0;
+
 	while (t->read_index != target) {
 		ComputeTimingInfo info = t->buffer[t->read_index % countof(t->buffer)];
 		switch (info.kind) {
@@ -1130,15 +2774,30 @@ coalesce_timing_table(ComputeTimingTable *t, ComputeShaderStats *stats)
 			t->compute_frame_active = 1;
 			/* NOTE(rnp): allow multiple instances of same shader to accumulate */
 			mem_clear(stats->table.times[stats_index], 0, sizeof(stats->table.times[stats_index]));
+			mem_clear(stats->work[stats_index],        0, sizeof(stats->work[stats_index]));
 		}break;
 		case ComputeTimingInfoKind_ComputeFrameEnd:{
 			assert(t->compute_frame_active == 1);
 			t->compute_frame_active = 0;
+
+			for EachEnumValue(BeamformerShaderKind, shader) {
+				f32 time = stats->table.times[stats_index][shader];
+				if (time > 0) {
+					latency_histogram_push(stats->table.latency + shader, time);
+					latency_updated |= (1u << shader);
+				}
+			}
+			latency_histogram_push(&stats->table.frame_latency, (f32)info.timer_count / 1.0e9f);
+			latency_updated |= (1u << BeamformerShaderKind_Count);
+
 			stats->latest_frame_index = stats_index;
 			stats_index = (stats_index + 1) % countof(stats->table.times);
 		}break;
 		case ComputeTimingInfoKind_Shader:{
 			stats->table.times[stats_index][info.shader] += (f32)info.timer_count / 1.0e9f;
+			#define X(name, ...) stats->work[stats_index][info.shader].name += info.work.name;
+			BEAMFORMER_COMPUTE_STAGE_METRICS
+			#undef X
 			seen_info_test |= (1u << info.shader);
 		}break;
 		case ComputeTimingInfoKind_RF_Data:{
@@ -1148,20 +2807,39 @@ coalesce_timing_table(ComputeTimingTable *t, ComputeShaderStats *stats)
 			stats->last_rf_timer_count = info.timer_count;
 			seen_info_test |= (1 << BeamformerShaderKind_Count);
 		}break;
+		case ComputeTimingInfoKind_StatsReset:{
+			mem_clear(stats->table.latency, 0, sizeof(stats->table.latency));
+			mem_clear(&stats->table.frame_latency, 0, sizeof(stats->table.frame_latency));
+			latency_updated = 0;
+		}break;
 		}
 		/* NOTE(rnp): do this at the end so that stats table is always in a consistent state */
 		atomic_add_u32(&t->read_index, 1);
 	}
 
 	if (seen_info_test) {
+		/* NOTE(rnp): rates are total work over total time across the table so frames planned
+		 * with different pipelines are weighted correctly. they are built locally so the
+		 * published table never holds a partial result */
+		BeamformerComputeStageMetrics metrics[BeamformerShaderKind_Count] = {0};
 		for EachEnumValue(BeamformerShaderKind, shader) {
-			if (seen_info_test & (1 << shader)) {
-				f32 sum = 0;
-				for EachElement(stats->table.times, i)
-					sum += stats->table.times[i][shader];
+			f32 sum = 0;
+			BeamformerComputeStageMetrics work = {0};
+			for EachElement(stats->table.times, i) {
+				sum += stats->table.times[i][shader];
+				#define X(name, ...) work.name += stats->work[i][shader].name;
+				BEAMFORMER_COMPUTE_STAGE_METRICS
+				#undef X
+			}
+			if (seen_info_test & (1 << shader))
 				stats->average_times[shader] = sum / countof(stats->table.times);
+			if (sum > 0) {
+				#define X(name, ...) metrics[shader].name = work.name / sum;
+				BEAMFORMER_COMPUTE_STAGE_METRICS
+				#undef X
 			}
 		}
+		mem_copy(stats->table.metrics, metrics, sizeof(metrics));
 
 		if (seen_info_test & (1 << BeamformerShaderKind_Count)) {
 			f32 sum = 0;
@@ -1170,6 +2848,13 @@ coalesce_timing_table(ComputeTimingTable *t, ComputeShaderStats *stats)
 			stats->rf_time_delta_average = sum / countof(stats->table.rf_time_deltas);
 		}
 	}
+
+	for EachEnumValue(BeamformerShaderKind, shader) {
+		if (latency_updated & (1u << shader))
+			latency_histogram_update_percentiles(stats->table.latency + shader);
+	}
+	if (latency_updated & (1u << BeamformerShaderKind_Count))
+		latency_histogram_update_percentiles(&stats->table.frame_latency);
 }
 
 DEBUG_EXPORT BEAMFORMER_COMPUTE_SETUP_FN(beamformer_compute_setup)
@@ -1179,14 +2864,10 @@ DEBUG_EXPORT BEAMFORMER_COMPUTE_SETUP_FN(beamformer_compute_setup)
 	ComputeShaderCtx          *cs  = &ctx->csctx;
 	BeamformerComputePipeline *cp  = &cs->compute_pipeline;
 
-	glCreateBuffers(countof(cp->ubos), cp->ubos);
-	#define X(k, t, ...) \
-		glNamedBufferStorage(cp->ubos[BeamformerComputeUBOKind_##k], sizeof(t), \
-		                     0, GL_DYNAMIC_STORAGE_BIT); \
-		LABEL_GL_OBJECT(GL_BUFFER, cp->ubos[BeamformerComputeUBOKind_##k], s8(#t));
-
-		BEAMFORMER_COMPUTE_UBO_LIST
-	#undef X
+	cp->ubo_stride = (u32)round_up_to(sizeof(BeamformerComputeStageUBO), MAX(ctx->gl.ubo_offset_alignment, 16));
+	glCreateBuffers(1, &cp->ubo);
+	glNamedBufferStorage(cp->ubo, cp->ubo_stride * MAX_COMPUTE_SHADER_STAGES, 0, GL_DYNAMIC_STORAGE_BIT);
+	LABEL_GL_OBJECT(GL_BUFFER, cp->ubo, s8("Compute_Stage_UBOs"));
 
 	glCreateTextures(GL_TEXTURE_1D, 1, &cs->channel_mapping_texture);
 	glCreateTextures(GL_TEXTURE_1D, 1, &cs->sparse_elements_texture);
@@ -1199,15 +2880,34 @@ DEBUG_EXPORT BEAMFORMER_COMPUTE_SETUP_FN(beamformer_compute_setup)
 	LABEL_GL_OBJECT(GL_TEXTURE, cs->focal_vectors_texture,   s8("Focal_Vectors"));
 	LABEL_GL_OBJECT(GL_TEXTURE, cs->sparse_elements_texture, s8("Sparse_Elements"));
 
-	glCreateQueries(GL_TIME_ELAPSED, countof(cs->shader_timer_ids), cs->shader_timer_ids);
+	u32 zero = 0;
+	glCreateBuffers(1, &cs->min_max_counter_ssbo);
+	glNamedBufferStorage(cs->min_max_counter_ssbo, sizeof(zero), &zero, 0);
+	LABEL_GL_OBJECT(GL_BUFFER, cs->min_max_counter_ssbo, s8("Min_Max_Counter"));
+
+	for EachElement(cs->timer_query_frames, i) {
+		BeamformerTimerQueryFrame *tqf = cs->timer_query_frames + i;
+		glCreateQueries(GL_TIME_ELAPSED, countof(tqf->ids),           tqf->ids);
+		glCreateQueries(GL_TIMESTAMP,    countof(tqf->timestamp_ids), tqf->timestamp_ids);
+	}
 }
 
 DEBUG_EXPORT BEAMFORMER_COMPLETE_COMPUTE_FN(beamformer_complete_compute)
 {
 	BeamformerCtx *ctx         = (BeamformerCtx *)user_context;
 	BeamformerSharedMemory *sm = ctx->shared_memory.region;
-	complete_queue(ctx, &sm->external_work_queue, arena, gl_context);
-	complete_queue(ctx, ctx->beamform_work_queue, arena, gl_context);
+	ComputeShaderCtx       *cs = &ctx->csctx;
+	/* NOTE(rnp): keep submitting new work while earlier frames are still executing. only
+	 * once the queues are empty do we block on the oldest frame and even then only briefly
+	 * so that newly arriving work can be submitted behind it */
+	for (;;) {
+		complete_queue(ctx, &sm->external_work_queue, arena, gl_context);
+		complete_queue(ctx, ctx->beamform_work_queue, arena, gl_context);
+		if (cs->in_flight_frames_retired == cs->in_flight_frames_submitted)
+			break;
+		retire_in_flight_frame(ctx, COMPUTE_RETIRE_POLL_NS);
+	}
+	compile_idle_compute_shader_variants(ctx, arena);
 }
 
 function void
@@ -1268,10 +2968,28 @@ DEBUG_EXPORT BEAMFORMER_RF_UPLOAD_FN(beamformer_rf_upload)
 
 		os_wake_waiters(ctx->compute_worker_sync);
 
-		ComputeTimingInfo info = {.kind = ComputeTimingInfoKind_RF_Data};
-		glGetQueryObjectui64v(rf->data_timestamp_query, GL_QUERY_RESULT, &info.timer_count);
-		glQueryCounter(rf->data_timestamp_query, GL_TIMESTAMP);
-		push_compute_timing_info(ctx->compute_timing_table, info);
+		/* NOTE(rnp): the oldest timestamp is only waited on if the ring is full which would
+		 * mean the GPU is further behind than the upload slots allow */
+		u32 query_count = countof(rf->data_timestamp_queries);
+		if (rf->data_timestamp_queries_issued - rf->data_timestamp_queries_collected == query_count) {
+			ComputeTimingInfo info = {.kind = ComputeTimingInfoKind_RF_Data};
+			u32 query = rf->data_timestamp_queries[rf->data_timestamp_queries_collected++ % query_count];
+			glGetQueryObjectui64v(query, GL_QUERY_RESULT, &info.timer_count);
+			push_compute_timing_info(ctx->compute_timing_table, info);
+		}
+		glQueryCounter(rf->data_timestamp_queries[rf->data_timestamp_queries_issued++ % query_count], GL_TIMESTAMP);
+
+		while (rf->data_timestamp_queries_collected != rf->data_timestamp_queries_issued) {
+			u32 query     = rf->data_timestamp_queries[rf->data_timestamp_queries_collected % query_count];
+			u64 available = 0;
+			glGetQueryObjectui64v(query, GL_QUERY_RESULT_AVAILABLE, &available);
+			if (!available) break;
+
+			ComputeTimingInfo info = {.kind = ComputeTimingInfoKind_RF_Data};
+			glGetQueryObjectui64v(query, GL_QUERY_RESULT, &info.timer_count);
+			push_compute_timing_info(ctx->compute_timing_table, info);
+			rf->data_timestamp_queries_collected++;
+		}
 	}
 }
 
@@ -1281,31 +2999,42 @@ DEBUG_EXPORT BEAMFORMER_FRAME_STEP_FN(beamformer_frame_step)
 {
 	dt_for_frame = input->dt;
 
-	if (IsWindowResized()) {
+	if (!ctx->headless && IsWindowResized()) {
 		ctx->window_size.h = GetScreenHeight();
 		ctx->window_size.w = GetScreenWidth();
 	}
 
-	coalesce_timing_table(ctx->compute_timing_table, ctx->compute_shader_stats);
+	BeamformerSharedMemory *sm = ctx->shared_memory.region;
+	/* NOTE(rnp): resets go through the timing table so that the histograms only ever
+	 * change while it is being coalesced and frames are counted on the correct side */
+	ComputeShaderStats *stats = ctx->compute_shader_stats;
+	u32 reset_count = atomic_load_u32(&sm->compute_stats_reset_count);
+	if (stats->reset_count != reset_count) {
+		stats->reset_count = reset_count;
+		push_compute_timing_info(ctx->compute_timing_table,
+		                         (ComputeTimingInfo){.kind = ComputeTimingInfoKind_StatsReset});
+	}
+	coalesce_timing_table(ctx->compute_timing_table, stats);
 
 	if (input->executable_reloaded) {
-		ui_init(ctx, ctx->ui_backing_store);
+		if (!ctx->headless) ui_init(ctx, ctx->ui_backing_store);
 		DEBUG_DECL(start_frame_capture = ctx->os.start_frame_capture);
 		DEBUG_DECL(end_frame_capture   = ctx->os.end_frame_capture);
 	}
 
-	BeamformerSharedMemory *sm = ctx->shared_memory.region;
 	if (sm->locks[BeamformerSharedMemoryLockKind_UploadRF] != 0)
 		os_wake_waiters(&ctx->os.upload_worker.sync_variable);
 
-	BeamformerFrame        *frame = ctx->latest_frame;
-	BeamformerViewPlaneTag  tag   = frame? frame->view_plane_tag : 0;
-	draw_ui(ctx, input, frame, tag);
+	if (!ctx->headless) {
+		BeamformerFrame        *frame = ctx->latest_frame;
+		BeamformerViewPlaneTag  tag   = frame? frame->view_plane_tag : 0;
+		draw_ui(ctx, input, frame, tag);
 
-	ctx->frame_view_render_context.updated = 0;
+		ctx->frame_view_render_context.updated = 0;
 
-	if (WindowShouldClose())
-		ctx->should_exit = 1;
+		if (WindowShouldClose())
+			ctx->should_exit = 1;
+	}
 }
 
 /* NOTE(rnp): functions defined in these shouldn't be visible to the whole program */
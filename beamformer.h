@@ -9,6 +9,7 @@
 
 ///////////////////
 // REQUIRED OS API
+function OS_MAKE_DIRECTORY_FN(os_make_directory);
 function OS_READ_WHOLE_FILE_FN(os_read_whole_file);
 function OS_SHARED_MEMORY_LOCK_REGION_FN(os_shared_memory_region_lock);
 function OS_SHARED_MEMORY_UNLOCK_REGION_FN(os_shared_memory_region_unlock);
@@ -34,39 +35,15 @@ typedef struct {
 	f32  dt;
 } BeamformerInput;
 
-#define CUDA_INIT_FN(name) void name(u32 *input_dims, u32 *decoded_dims)
-typedef CUDA_INIT_FN(cuda_init_fn);
-CUDA_INIT_FN(cuda_init_stub) {}
+#include "external_stage.h"
 
-#define CUDA_REGISTER_BUFFERS_FN(name) void name(u32 *rf_data_ssbos, u32 rf_buffer_count, u32 raw_data_ssbo)
-typedef CUDA_REGISTER_BUFFERS_FN(cuda_register_buffers_fn);
-CUDA_REGISTER_BUFFERS_FN(cuda_register_buffers_stub) {}
-
-#define CUDA_DECODE_FN(name) void name(size_t input_offset, u32 output_buffer_idx, u32 rf_channel_offset)
-typedef CUDA_DECODE_FN(cuda_decode_fn);
-CUDA_DECODE_FN(cuda_decode_stub) {}
-
-#define CUDA_HILBERT_FN(name) void name(u32 input_buffer_idx, u32 output_buffer_idx)
-typedef CUDA_HILBERT_FN(cuda_hilbert_fn);
-CUDA_HILBERT_FN(cuda_hilbert_stub) {}
-
-#define CUDA_SET_CHANNEL_MAPPING_FN(name) void name(i16 *channel_mapping)
-typedef CUDA_SET_CHANNEL_MAPPING_FN(cuda_set_channel_mapping_fn);
-CUDA_SET_CHANNEL_MAPPING_FN(cuda_set_channel_mapping_stub) {}
-
-#define CUDA_LIB_FNS \
-	X(decode,              "cuda_decode")              \
-	X(hilbert,             "cuda_hilbert")             \
-	X(init,                "init_cuda_configuration")  \
-	X(register_buffers,    "register_cuda_buffers")    \
-	X(set_channel_mapping, "cuda_set_channel_mapping")
-
-typedef struct {
-	void *lib;
-	#define X(name, symname) cuda_ ## name ## _fn *name;
-	CUDA_LIB_FNS
-	#undef X
-} CudaLib;
+EXTERNAL_STAGE_INIT_FN(external_stage_init_stub) {}
+EXTERNAL_STAGE_REGISTER_BUFFERS_FN(external_stage_register_buffers_stub) {}
+EXTERNAL_STAGE_REGISTER_HOST_BUFFERS_FN(external_stage_register_host_buffers_stub) {}
+EXTERNAL_STAGE_DECODE_FN(external_stage_decode_stub) {}
+EXTERNAL_STAGE_HILBERT_FN(external_stage_hilbert_stub) {}
+EXTERNAL_STAGE_SET_CHANNEL_MAPPING_FN(external_stage_set_channel_mapping_stub) {}
+EXTERNAL_STAGE_SET_HADAMARD_FN(external_stage_set_hadamard_stub) {}
 
 /* TODO(rnp): this should be a UBO */
 #define FRAME_VIEW_MODEL_MATRIX_LOC   0
@@ -78,6 +55,7 @@ typedef struct {
 #define FRAME_VIEW_LOG_SCALE_LOC      6
 #define FRAME_VIEW_BB_COLOUR_LOC      7
 #define FRAME_VIEW_BB_FRACTION_LOC    8
+#define FRAME_VIEW_COMPRESSED_LOC     9
 #define FRAME_VIEW_SOLID_BB_LOC      10
 
 #define FRAME_VIEW_BB_COLOUR   0.92, 0.88, 0.78, 1.0
@@ -85,6 +63,17 @@ typedef struct {
 
 #define FRAME_VIEW_RENDER_TARGET_SIZE 1024, 1024
 
+/* NOTE(rnp): number of coarse mip levels a volume is beamformed into before the full
+ * resolution output. each level has 1/8 of the voxels of the level below it */
+#define DAS_PROGRESSIVE_LEVELS 2
+
+/* NOTE(rnp): upper bound on the combined size of the DAS delay tables */
+#define DAS_DELAY_TABLES_MAX_SIZE MB(768)
+
+/* NOTE(rnp): DAS dispatches which may be queued on the GPU before the compute thread
+ * waits on the oldest one */
+#define DAS_DISPATCHES_IN_FLIGHT 4
+
 typedef struct {
 	u32 shader;
 	u32 framebuffers[2];  /* [0] -> multisample target, [1] -> normal target for resolving */
@@ -106,6 +95,9 @@ typedef struct {
 	BeamformerFilterKind       kind;
 	BeamformerFilterParameters parameters;
 	u32 texture;
+	/* NOTE: FFT of the (shifted) filter for overlap-save; only created when the
+	 * length is within [FILTER_FFT_MIN_TAPS, FILTER_FFT_MAX_TAPS] */
+	u32 spectrum_texture;
 } BeamformerFilter;
 
 /* X(name, type, gltype) */
@@ -147,18 +139,49 @@ typedef align_as(16) struct {
 } BeamformerFilterUBO;
 static_assert((sizeof(BeamformerFilterUBO) & 15) == 0, "UBO size must be a multiple of 16");
 
+/* NOTE(rnp): every pipeline stage owns a range of a single UBO (at stage * ubo_stride)
+ * so that multiple stages of the same kind can be configured independently */
 /* TODO(rnp): das should remove redundant info and add voxel transform */
-/* TODO(rnp): need 1 UBO per filter slot */
-#define BEAMFORMER_COMPUTE_UBO_LIST \
-	X(DAS,        BeamformerParameters, das)    \
-	X(Decode,     BeamformerDecodeUBO,  decode) \
-	X(Filter,     BeamformerFilterUBO,  filter) \
-	X(Demodulate, BeamformerFilterUBO,  demod)
-
-#define X(k, ...) BeamformerComputeUBOKind_##k,
-typedef enum {BEAMFORMER_COMPUTE_UBO_LIST BeamformerComputeUBOKind_Count} BeamformerComputeUBOKind;
+typedef union {
+	BeamformerParameters das;
+	BeamformerDecodeUBO  decode;
+	BeamformerFilterUBO  filter;
+	BeamformerLogCompressParameters log_compress;
+} BeamformerComputeStageUBO;
+
+/* NOTE(rnp): DAS parameters which are compiled into specialized programs as constants */
+typedef union {
+	struct {
+		u8 das_shader_id;
+		u8 interpolate;
+		u8 coherency_weighting;
+		u8 iq_data;
+	};
+	u32 value;
+} DASSpecialization;
+
+typedef struct {
+	DASSpecialization    specialization;
+	BeamformerShaderKind kind;
+	u32                  program;
+} DASSpecializedProgram;
+
+#define DAS_SPECIALIZED_PROGRAM_CACHE_SIZE 32
+
+#define X(name, id) BeamformerFFTFlags_##name = (1 << id),
+typedef enum {BEAMFORMER_FFT_FLAG_LIST} BeamformerFFTFlags;
 #undef X
 
+/* NOTE: log2(size) passes; radix 8 passes after at most one radix 2 or 4 pass */
+typedef struct {
+	u32 size;
+	u32 twiddle_ssbo;
+	u32 pass_count;
+	u8  radices[16];
+} BeamformerFFTPlan;
+
+#define FFT_PLAN_CACHE_SIZE 4
+
 typedef struct {
 	BeamformerShaderKind       shaders[MAX_COMPUTE_SHADER_STAGES];
 	BeamformerShaderParameters shader_parameters[MAX_COMPUTE_SHADER_STAGES];
@@ -169,12 +192,30 @@ typedef struct {
 	uv3 demod_dispatch;
 
 	u32  rf_size;
+	b32  rf_data_half;
+	u32  hilbert_fft_size;
 
-	u32 ubos[BeamformerComputeUBOKind_Count];
+	/* NOTE(rnp): 1 unless consecutive frames may share a DAS dispatch series */
+	u32  das_batch_count;
 
-	#define X(k, type, name) type name ##_ubo_data;
-	BEAMFORMER_COMPUTE_UBO_LIST
-	#undef X
+	BeamformerOutputFormat output_format;
+
+	BeamformerLogCompressParameters log_compress_parameters;
+
+	DASSpecialization das_specialization;
+
+	/* NOTE(rnp): hash of everything which determines the input to the DAS stage */
+	u64  das_input_hash;
+
+	BeamformerParameters das_ubo_data;
+	BeamformerDecodeUBO  decode_ubo_data;
+
+	u32 ubo;
+	u32 ubo_stride;
+	BeamformerComputeStageUBO stage_ubo_data[MAX_COMPUTE_SHADER_STAGES];
+
+	/* NOTE(rnp): estimated work per frame; same layout as the per second metrics */
+	BeamformerComputeStageMetrics stage_work[MAX_COMPUTE_SHADER_STAGES];
 } BeamformerComputePipeline;
 
 #define MAX_RAW_DATA_FRAMES_IN_FLIGHT 3
@@ -186,12 +227,61 @@ typedef struct {
 	u32 ssbo;
 	u32 rf_size;
 
-	u32 data_timestamp_query;
+	/* NOTE: timestamps are read back once they become available; they complete in order */
+	u32 data_timestamp_queries[8];
+	u32 data_timestamp_queries_issued;
+	u32 data_timestamp_queries_collected;
 
 	u32 insertion_index;
 	u32 compute_index;
 } BeamformerRFBuffer;
 
+/* NOTE(rnp): a frame's early stages may be submitted while up to this many earlier
+ * frames are still executing on the GPU. each frame in flight reads its own set of
+ * intermediate buffers (see rf_data_ssbos) */
+#define BEAMFORMER_MAX_FRAMES_IN_FLIGHT 2
+
+typedef struct {
+	BeamformerFrame *frame;
+	BeamformerFrame *averaged_frame;
+	/* NOTE(rnp): frames from the same DAS batch which are presented before frame */
+	BeamformerFrame *batch_frames[BEAMFORMER_MAX_DAS_BATCH - 1];
+	u32              batch_frame_count;
+	/* NOTE(rnp): progressive refinement was cancelled; the frame is never presented */
+	b32              cancelled;
+	GLsync           fence;
+} BeamformerInFlightFrame;
+
+/* NOTE(rnp): timer queries of submitted frames. these are only ever read once the GPU
+ * reports them as available so the ring is deeper than the number of frames in flight.
+ * every frame of an unflushed DAS batch holds a slot so the ring must fit a whole batch */
+#define BEAMFORMER_TIMER_QUERY_FRAMES 8
+static_assert(BEAMFORMER_MAX_DAS_BATCH <= BEAMFORMER_TIMER_QUERY_FRAMES, "timer query ring can't hold a DAS batch");
+
+/* NOTE(rnp): frames in a DAS batch only time the stages before DAS themselves. the stages
+ * from batch_stage on are timed once for the whole batch in the slot of its last frame and
+ * split evenly between the frames when they are collected. batch_count is 0 until the
+ * batch has been flushed; frames which were not batched are a batch of 1 */
+typedef struct {
+	u32                           ids[MAX_COMPUTE_SHADER_STAGES];
+	/* NOTE: GL_TIMESTAMP queries at the start of the first and the end of the last stage */
+	u32                           timestamp_ids[2];
+	BeamformerShaderKind          shaders[MAX_COMPUTE_SHADER_STAGES];
+	/* NOTE: work of each stage as planned when the frame was submitted */
+	BeamformerComputeStageMetrics stage_work[MAX_COMPUTE_SHADER_STAGES];
+	i32                           first_stage;
+	i32                           shader_count;
+	i32                           batch_stage;
+	u32                           batch_index;
+	u32                           batch_count;
+} BeamformerTimerQueryFrame;
+
+typedef enum {
+	ShaderCompileStatus_Stale,
+	ShaderCompileStatus_Compiled,
+	ShaderCompileStatus_Failed,
+} ShaderCompileStatus;
+
 typedef struct {
 	u32 programs[BeamformerShaderKind_ComputeCount];
 
@@ -201,43 +291,112 @@ typedef struct {
 	BeamformerRFBuffer rf_buffer;
 
 	/* NOTE: Decoded data is only relevant in the context of a single frame. We use two
-	 * buffers so that they can be swapped when chaining multiple compute stages */
-	u32 rf_data_ssbos[2];
+	 * buffers so that they can be swapped when chaining multiple compute stages. frames
+	 * alternate between sets of these so that the early stages of a frame never have to
+	 * wait on the previous frame's DAS stage which may still be reading its set */
+	u32 rf_data_ssbos[BEAMFORMER_MAX_FRAMES_IN_FLIGHT][2];
+	u32 rf_data_set;
 	u32 last_output_ssbo_index;
 
+	/* NOTE: precision the compute programs were compiled for and rf_data_ssbos were
+	 * allocated with. changing it requires reloading every compute program */
+	b32 rf_data_half;
+	/* NOTE: format the compute programs were compiled to write beamformed frames in */
+	BeamformerOutputFormat output_format;
+	ShaderReloadContext *shader_reload_contexts[BeamformerShaderKind_ComputeCount];
+
+	/* NOTE: internal variants are compiled on first use by the pipeline or when the
+	 * compute worker is idle */
+	ShaderCompileStatus program_status[BeamformerShaderKind_ComputeCount];
+
+	/* NOTE: compiled on first use; replaced round robin once full */
+	DASSpecializedProgram das_programs[DAS_SPECIALIZED_PROGRAM_CACHE_SIZE];
+	u32 das_program_count;
+	u32 das_program_next;
+
+	/* NOTE: frames whose pre DAS stages have run and whose DAS input is stored in
+	 * das_batch_ssbo at the same index. they are beamformed together once the batch is full,
+	 * the queue runs dry, or anything else needs the compute context */
+	BeamformerFrame *das_batch_frames[BEAMFORMER_MAX_DAS_BATCH];
+	u32 das_batch_frame_count;
+	u32 das_batch_ssbo;
+	uz  das_batch_ssbo_size;
+
+	/* NOTE: created on first use for a size; replaced round robin once full */
+	BeamformerFFTPlan fft_plans[FFT_PLAN_CACHE_SIZE];
+	u32 fft_plan_count;
+	u32 fft_plan_next;
+
+	/* NOTE: set when rf_data_ssbos[last_output_ssbo_index] still holds the input to the
+	 * DAS stage from the previous frame. A recompute which only changes parameters consumed
+	 * by DAS (e.g. panning or zooming the output region) can then skip every earlier stage */
+	b32 das_input_valid;
+
 	u32 channel_mapping_texture;
 	u32 sparse_elements_texture;
 	u32 focal_vectors_texture;
 	u32 hadamard_texture;
 
+	/* NOTE: counts finished workgroups so the last one can complete the mip chain */
+	u32 min_max_counter_ssbo;
+
+	/* NOTE: [0]: transmit delays [transmit][voxel], [1]: receive delays [channel][voxel],
+	 * [2]: receive apodization [channel / 2][voxel]. rebuilt only when the geometry hash
+	 * changes */
+	u32 delay_table_ssbos[3];
+	uz  delay_table_sizes[3];
+	u64 delay_tables_hash;
+
 	uv4 dec_data_dim;
 	u32 rf_raw_size;
 
 	f32 processing_progress;
 	b32 processing_compute;
 
-	u32 shader_timer_ids[MAX_COMPUTE_SHADER_STAGES];
+	BeamformerTimerQueryFrame timer_query_frames[BEAMFORMER_TIMER_QUERY_FRAMES];
+	u32 timer_query_frames_submitted;
+	u32 timer_query_frames_collected;
+
+	/* NOTE: frames whose work has been submitted to the GPU but which have not been
+	 * presented yet. retired in submission order */
+	BeamformerInFlightFrame in_flight_frames[BEAMFORMER_MAX_FRAMES_IN_FLIGHT];
+	u32 in_flight_frames_submitted;
+	u32 in_flight_frames_retired;
+
+	/* NOTE: coarse level of a progressively refined frame which is presented once its
+	 * fence signals (see das_progressive_present) */
+	BeamformerFrame *progressive_pending;
+	GLsync           progressive_fence;
+	b32              das_refinement_cancelled;
+
+	/* NOTE: fences of the most recent DAS dispatches (see das_dispatch_throttle) */
+	GLsync das_dispatch_fences[DAS_DISPATCHES_IN_FLIGHT];
+	u32    das_dispatches_submitted;
 
 	BeamformerRenderModel unit_cube_model;
-	CudaLib cuda_lib;
-} ComputeShaderCtx;
+	ExternalStageLib external_stages;
 
-typedef enum {
-	#define X(type, id, pretty, fixed_tx) DASShaderKind_##type = id,
-	DAS_TYPES
-	#undef X
-	DASShaderKind_Count
-} DASShaderKind;
+	/* NOTE: host memory copy used by host external stage backends. laid out as
+	 * [rf_data_ssbos[0]][rf_data_ssbos[1]][raw rf data] */
+	u32  external_staging_buffer;
+	u8  *external_staging;
+	uz   external_staging_rf_size;
+} ComputeShaderCtx;
 
 typedef struct {
 	BeamformerComputeStatsTable table;
 	f32 average_times[BeamformerShaderKind_Count];
+	/* NOTE: work done by each shader in the frames of table.times */
+	BeamformerComputeStageMetrics work[countof(((BeamformerComputeStatsTable *)0)->times)][BeamformerShaderKind_Count];
 
 	u64 last_rf_timer_count;
 	f32 rf_time_delta_average;
 
 	u32 latest_frame_index;
 	u32 latest_rf_index;
+
+	/* NOTE: last value of the shared memory reset counter pushed into the timing table */
+	u32 reset_count;
 } ComputeShaderStats;
 
 /* TODO(rnp): maybe this also gets used for CPU timing info as well */
@@ -246,14 +405,18 @@ typedef enum {
 	ComputeTimingInfoKind_ComputeFrameEnd,
 	ComputeTimingInfoKind_Shader,
 	ComputeTimingInfoKind_RF_Data,
+	/* NOTE: clears the latency histograms; ordered with the timings around it */
+	ComputeTimingInfoKind_StatsReset,
 } ComputeTimingInfoKind;
 
 typedef struct {
+	/* NOTE: for ComputeFrameEnd this is the time from the start of the frame's first stage
+	 * to the end of its last stage */
 	u64 timer_count;
 	ComputeTimingInfoKind kind;
-	union {
-		BeamformerShaderKind shader;
-	};
+	BeamformerShaderKind  shader;
+	/* NOTE: work of the stage which was timed; only valid for ComputeTimingInfoKind_Shader */
+	BeamformerComputeStageMetrics work;
 } ComputeTimingInfo;
 
 typedef struct {
@@ -274,6 +437,8 @@ struct BeamformerFrame {
 	u32 texture;
 	b32 ready_to_present;
 
+	BeamformerOutputFormat format;
+
 	iv3 dim;
 	i32 mips;
 
@@ -288,6 +453,14 @@ struct BeamformerFrame {
 	DASShaderKind          das_shader_kind;
 	BeamformerViewPlaneTag view_plane_tag;
 
+	/* NOTE: single level 8 or 16 bit image written by the LogCompress stage. it is only
+	 * valid for the current contents of texture when compressed_valid is set */
+	u32 compressed_texture;
+	iv3 compressed_dim;
+	u32 compressed_bit_depth;
+	b32 compressed_valid;
+	BeamformerLogCompressParameters compressed_parameters;
+
 	BeamformerFrame *next;
 };
 
@@ -302,10 +475,15 @@ struct BeamformerFrame {
 	X(MAX_SHADER_STORAGE_BLOCK_SIZE,   max_ssbo_size,                   "")      \
 	X(MAX_COMPUTE_SHARED_MEMORY_SIZE,  max_shared_memory_size,          "")      \
 	X(MAX_UNIFORM_BLOCK_SIZE,          max_ubo_size,                    "")      \
-	X(MAX_SERVER_WAIT_TIMEOUT,         max_server_wait_time,            " [ns]")
+	X(UNIFORM_BUFFER_OFFSET_ALIGNMENT, ubo_offset_alignment,            "")      \
+	X(MAX_SERVER_WAIT_TIMEOUT,         max_server_wait_time,            " [ns]") \
+	X(NUM_PROGRAM_BINARY_FORMATS,      program_binary_formats,          "")
 
 typedef struct {
 	enum gl_vendor_ids vendor_id;
+	/* NOTE(rnp): hash of the vendor, renderer, and version strings. cached
+	 * program binaries are only valid for the driver that produced them */
+	u64 driver_hash;
 	#define X(glname, name, suffix) i32 name;
 	GL_PARAMETERS
 	#undef X
@@ -316,6 +494,8 @@ typedef struct {
 
 	iv2 window_size;
 	b32 should_exit;
+	/* NOTE: no window, UI, or frame view rendering; only the compute and upload workers */
+	b32 headless;
 
 	Arena  ui_backing_store;
 	void  *ui;
@@ -343,9 +523,30 @@ typedef struct {
 	u32 next_render_frame_index;
 	u32 display_frame_index;
 
-	/* NOTE: this will only be used when we are averaging */
+	/* NOTE: this will only be used when we are averaging. there are more than can be in
+	 * flight so that the presented frame is never being written; the count is kept a
+	 * power of two so that the wrapping index arithmetic holds */
 	u32             averaged_frame_index;
-	BeamformerFrame averaged_frames[2];
+	BeamformerFrame averaged_frames[4];
+
+	/* NOTE: the fast DAS paths accumulate channels in this full precision complex frame
+	 * when beamformed frames are stored in any other format */
+	BeamformerFrame das_accumulator;
+
+	/* NOTE: coarse levels of a progressively refined frame are presented from these so
+	 * that the frame being refined is never sampled. the one not currently presented is
+	 * written next */
+	BeamformerFrame progressive_frames[2];
+
+	/* NOTE: output of a batched DAS dispatch; batched frames are stacked along y */
+	BeamformerFrame das_batch_frame;
+
+	/* NOTE: the incremental averaging modes update the previous averaged frame instead of
+	 * summing the whole window. this records what that frame was produced from */
+	BeamformerSumMode averaging_mode;
+	u32               averaging_frame_id;
+	u32               averaging_count;
+	u32               averaging_resum_countdown;
 } BeamformerCtx;
 
 struct ShaderReloadContext {
@@ -357,6 +558,9 @@ struct ShaderReloadContext {
 	ShaderReloadContext *link;
 	GLenum     gl_type;
 	BeamformerShaderKind kind;
+
+	b32               das_specialized;
+	DASSpecialization das_specialization;
 };
 
 #define BEAMFORMER_FRAME_STEP_FN(name) void name(BeamformerCtx *ctx, BeamformerInput *input)
@@ -12,23 +12,38 @@
 
 /* X(enumarant, number, shader file name, pretty name) */
 #define COMPUTE_SHADERS \
-	X(CudaDecode,          0, "",        "CUDA Decode")      \
-	X(CudaHilbert,         1, "",        "CUDA Hilbert")     \
-	X(DAS,                 2, "das",     "DAS")              \
-	X(Decode,              3, "decode",  "Decode (I16)")     \
-	X(Filter,              4, "filter",  "Filter (F32C)")    \
-	X(Demodulate,          5, "",        "Demodulate (I16)") \
-	X(MinMax,              6, "min_max", "Min/Max")          \
-	X(Sum,                 7, "sum",     "Sum")
+	X(CudaDecode,              0, "",             "CUDA Decode")              \
+	X(CudaHilbert,             1, "",             "CUDA Hilbert")             \
+	X(DAS,                     2, "das",          "DAS")                      \
+	X(Decode,                  3, "decode",       "Decode (I16)")             \
+	X(Filter,                  4, "filter",       "Filter (F32C)")            \
+	X(Demodulate,              5, "",             "Demodulate (I16)")         \
+	X(MinMax,                  6, "min_max",      "Min/Max")                  \
+	X(Sum,                     7, "sum",          "Sum")                      \
+	X(LogCompress,             8, "log_compress", "Log Compress")
 
 #define COMPUTE_SHADERS_INTERNAL \
 	COMPUTE_SHADERS \
-	X(DecodeInt16Complex,  8, "",        "Decode (I16C)") \
-	X(DecodeFloat,         9, "",        "Decode (F32)")  \
-	X(DecodeFloatComplex, 10, "",        "Decode (F32C)") \
-	X(DecodeInt16ToFloat, 11, "",        "Decode (I16-F32)") \
-	X(DemodulateFloat,    12, "",        "Demodulate (F32)") \
-	X(DASFast,            13, "",        "DAS (Fast)")
+	X(DecodeInt16Complex,      9, "",             "Decode (I16C)")            \
+	X(DecodeFloat,            10, "",             "Decode (F32)")             \
+	X(DecodeFloatComplex,     11, "",             "Decode (F32C)")            \
+	X(DecodeInt16ToFloat,     12, "",             "Decode (I16-F32)")         \
+	X(DemodulateFloat,        13, "",             "Demodulate (F32)")         \
+	X(DASFast,                14, "",             "DAS (Fast)")               \
+	X(DASDelayTables,         15, "",             "DAS Delay Tables")         \
+	X(DASFastDelayTables,     16, "",             "DAS (Fast, Delay Tables)") \
+	X(DASFastTiled,           17, "",             "DAS (Fast, Tiled RF)")     \
+	X(DecodeFWHT,             18, "",             "Decode (I16, FWHT)")       \
+	X(DecodeFWHTInt16Complex, 19, "",             "Decode (I16C, FWHT)")      \
+	X(DecodeFWHTFloat,        20, "",             "Decode (F32, FWHT)")       \
+	X(DecodeFWHTFloatComplex, 21, "",             "Decode (F32C, FWHT)")      \
+	X(DecodeFWHTInt16ToFloat, 22, "",             "Decode (I16-F32, FWHT)")   \
+	X(FilterFFT,              23, "",             "Filter (F32C, FFT)")       \
+	X(Hilbert,                24, "hilbert",      "Hilbert")                  \
+	X(HilbertBatchedFFT,      25, "",             "Hilbert (Batched FFT)")    \
+	X(FFT,                    26, "fft",          "FFT (Radix 2)")            \
+	X(FFTRadix4,              27, "",             "FFT (Radix 4)")            \
+	X(FFTRadix8,              28, "",             "FFT (Radix 8)")
 
 typedef enum {
 	#define X(e, n, ...) BeamformerShaderKind_##e = n,
@@ -40,11 +55,51 @@ typedef enum {
 	BeamformerShaderKind_ComputeCount = BeamformerShaderKind_Render3D,
 } BeamformerShaderKind;
 
+/* X(name, pretty name, unit) */
+#define BEAMFORMER_COMPUTE_STAGE_METRICS \
+	X(bytes_read,     "Read",    "[B/s]")  \
+	X(bytes_written,  "Written", "[B/s]")  \
+	X(samples,        "Samples", "[S/s]")  \
+	X(voxels,         "Voxels",  "[V/s]")  \
+	X(das_operations, "DAS Ops", "[Op/s]")
+
+/* NOTE(rnp): effective rates derived from the average time of each shader and the size of
+ * the data it touches. das_operations counts voxel * channel * transmit products */
+typedef struct {
+	#define X(name, ...) float name;
+	BEAMFORMER_COMPUTE_STAGE_METRICS
+	#undef X
+} BeamformerComputeStageMetrics;
+
+/* NOTE(rnp): HDR style (log-linear) histogram of times since the last reset. times below
+ * 2^(MIN_SHIFT + SUB_BUCKET_BITS) [ns] use 2^MIN_SHIFT [ns] wide buckets; above that every
+ * power of two is split into 2^SUB_BUCKET_BITS buckets (~12% relative precision). times
+ * beyond the last bucket (~68 [s]) are counted in it. percentiles are reported as the upper
+ * edge of the bucket containing them; max is exact */
+#define BEAMFORMER_LATENCY_MIN_SHIFT       10
+#define BEAMFORMER_LATENCY_SUB_BUCKET_BITS 3
+#define BEAMFORMER_LATENCY_BUCKETS         192
+
+typedef struct {
+	uint32_t buckets[BEAMFORMER_LATENCY_BUCKETS];
+	uint32_t count;
+	float    p50; /* [s] */
+	float    p90; /* [s] */
+	float    p99; /* [s] */
+	float    max; /* [s] */
+} BeamformerLatencyHistogram;
+
 typedef struct {
 	/* NOTE(rnp): this wants to be iterated on both dimensions. it depends entirely on which
 	 * visualization method you want to use. the coalescing function wants both directions */
 	float times[32][BeamformerShaderKind_Count];
 	float rf_time_deltas[32];
+	BeamformerComputeStageMetrics metrics[BeamformerShaderKind_Count];
+	/* NOTE(rnp): per frame time of each shader and of the whole compute frame. the frame
+	 * time runs from the start of its first stage to the end of its last so a frame beamformed
+	 * in a DAS batch includes the time spent waiting for the rest of the batch */
+	BeamformerLatencyHistogram latency[BeamformerShaderKind_Count];
+	BeamformerLatencyHistogram frame_latency;
 } BeamformerComputeStatsTable;
 
 /* X(type, id, pretty name) */
@@ -52,6 +107,12 @@ typedef struct {
 	X(NONE,     0, "None")     \
 	X(HADAMARD, 1, "Hadamard")
 
+typedef enum {
+	#define X(type, id, pretty) BeamformerDecodeMode_##type = id,
+	DECODE_TYPES
+	#undef X
+} BeamformerDecodeMode;
+
 #define BEAMFORMER_DATA_KIND_LIST \
 	X(Int16,          0) \
 	X(Int16Complex,   1) \
@@ -70,6 +131,65 @@ typedef enum {BEAMFORMER_DATA_KIND_LIST} BeamformerDataKind;
 typedef enum {BEAMFORMER_FILTER_KIND_LIST} BeamformerFilterKind;
 #undef X
 
+/* NOTE(rnp): Full:       average of the last output_points[3] frames
+ *            RunningSum: same as Full but only the newest and oldest frames are read
+ *            ExponentialMovingAverage: alpha = 2 / (output_points[3] + 1) */
+#define BEAMFORMER_SUM_MODE_LIST \
+	X(Full,                     0) \
+	X(RunningSum,               1) \
+	X(ExponentialMovingAverage, 2)
+
+#define X(k, id) BeamformerSumMode_##k = id,
+typedef enum {BEAMFORMER_SUM_MODE_LIST} BeamformerSumMode;
+#undef X
+
+/* NOTE(rnp): storage format of beamformed frames. the magnitude formats store |IQ| and
+ *            the Sum stage then averages magnitudes instead of complex values
+ * X(name, id, glsl image format, bytes per voxel) */
+#define BEAMFORMER_OUTPUT_FORMAT_LIST \
+	X(Complex32,   0, rg32f, 8) \
+	X(Complex16,   1, rg16f, 4) \
+	X(Magnitude32, 2, r32f,  4) \
+	X(Magnitude16, 3, r16f,  2)
+
+#define X(k, id, ...) BeamformerOutputFormat_##k = id,
+typedef enum {BEAMFORMER_OUTPUT_FORMAT_LIST BeamformerOutputFormat_Count} BeamformerOutputFormat;
+#undef X
+
+/* NOTE(rnp): LogCompress maps |IQ| to [0, 1] the same way the frame view does with log
+ *            scale enabled and stores the result as an 8 or 16 bit unsigned normalized
+ *            image alongside the frame. also used directly as the stage's UBO
+ * X(name, type, gltype, comment) */
+#define BEAMFORMER_LOG_COMPRESS_PARAMETERS_LIST \
+	X(dynamic_range, float,    float, "/* [dB] range mapped onto [0, 1] */")        \
+	X(threshold,     float,    float, "/* [dB] magnitude mapped to 1 */")           \
+	X(gamma,         float,    float, "/* applied to the thresholded magnitude */") \
+	X(bit_depth,     uint32_t, uint,  "/* 8 or 16 */")
+
+#define X(name, type, ...) type name;
+typedef struct {BEAMFORMER_LOG_COMPRESS_PARAMETERS_LIST} BeamformerLogCompressParameters;
+#undef X
+
+/* NOTE(rnp): DelayTables: precompute per voxel transmit and receive delays (and receive
+ *            apodization) once per geometry. Only used by the fast path for FORCES,
+ *            UFORCES, FLASH, TPW, and VLS and only when the tables fit on the GPU
+ *            TiledRF:     workgroups cooperatively stage RF samples in shared memory.
+ *            Only used by the fast path and ignored when DelayTables is in use */
+#define BEAMFORMER_DAS_FLAG_LIST \
+	X(DelayTables, 0) \
+	X(TiledRF,     1)
+
+/* NOTE(rnp): HalfPrecisionRF: intermediate RF/IQ data between stages is stored as packed
+ *            f16 pairs. stages still compute in f32. ignored when the pipeline contains
+ *            CUDA stages
+ *            DirectFormFilter: never use the FFT path for the Filter stage
+ *            BatchedFFTHilbert: run the native Hilbert stage through the batched FFT even
+ *            when lines fit in a single workgroup. lines must be a power of 2 */
+#define BEAMFORMER_PIPELINE_FLAG_LIST \
+	X(HalfPrecisionRF,   0) \
+	X(DirectFormFilter,  1) \
+	X(BatchedFFTHilbert, 2)
+
 /* X(type, id, pretty name) */
 #define BEAMFORMER_VIEW_PLANE_TAG_LIST \
 	X(XZ,        0, "XZ")        \
@@ -98,16 +218,34 @@ typedef enum {
 	X(EPIC_UHERCULES,  9, "EPIC-UHERCULES", 0) \
 	X(FLASH,          10, "Flash",          0)
 
+typedef enum {
+	#define X(type, id, pretty, fixed_tx) DASShaderKind_##type = id,
+	DAS_TYPES
+	#undef X
+	DASShaderKind_Count
+} DASShaderKind;
+
 #define FILTER_LOCAL_SIZE_X 64
 #define FILTER_LOCAL_SIZE_Y  1
 #define FILTER_LOCAL_SIZE_Z  1
 
+/* NOTE(rnp): filters with at least FILTER_FFT_MIN_TAPS taps are applied with overlap-save
+ * FFT convolution. each workgroup transforms a FILTER_FFT_SIZE block in shared memory
+ * and produces FILTER_FFT_SIZE - taps outputs, hence the upper limit on the length */
+#define FILTER_FFT_SIZE         2048
+#define FILTER_FFT_LOCAL_SIZE_X  256
+#define FILTER_FFT_MIN_TAPS       64
+#define FILTER_FFT_MAX_TAPS     (FILTER_FFT_SIZE / 2 - 1)
+
 #define DECODE_LOCAL_SIZE_X  4
 #define DECODE_LOCAL_SIZE_Y  1
 #define DECODE_LOCAL_SIZE_Z 16
 
 #define DECODE_FIRST_PASS_UNIFORM_LOC 1
 
+/* NOTE(rnp): shared memory limit for the fast Walsh-Hadamard decode */
+#define DECODE_FWHT_MAX_TRANSMITS 256
+
 #define DAS_LOCAL_SIZE_X  16
 #define DAS_LOCAL_SIZE_Y   1
 #define DAS_LOCAL_SIZE_Z  16
@@ -116,15 +254,62 @@ typedef enum {
 #define DAS_FAST_LOCAL_SIZE_Y  1
 #define DAS_FAST_LOCAL_SIZE_Z 16
 
-#define DAS_VOXEL_OFFSET_UNIFORM_LOC  2
-#define DAS_CYCLE_T_UNIFORM_LOC       3
-#define DAS_VOXEL_MATRIX_LOC          4
-#define DAS_FAST_CHANNEL_UNIFORM_LOC  5
+#define DAS_VOXEL_OFFSET_UNIFORM_LOC      2
+#define DAS_CYCLE_T_UNIFORM_LOC           3
+#define DAS_VOXEL_MATRIX_LOC              4
+#define DAS_FAST_CHANNEL_UNIFORM_LOC      5
+#define DAS_FAST_LAST_CHANNEL_UNIFORM_LOC 6
+#define DAS_RF_BATCH_STRIDE_UNIFORM_LOC   7
+
+/* NOTE(rnp): delay tables store sample indices as 16.16 fixed point. indices are clamped
+ * to this many samples so that a transmit and a receive delay can be summed */
+#define DAS_DELAY_TABLES_MAX_SAMPLES 16384
+
+#define MIN_MAX_LOCAL_SIZE_X 4
+#define MIN_MAX_LOCAL_SIZE_Y 4
+#define MIN_MAX_LOCAL_SIZE_Z 4
 
-#define MIN_MAX_MIPS_LEVEL_UNIFORM_LOC 1
+#define MIN_MAX_PASS_LEVELS_UNIFORM_LOC 1
+#define MIN_MAX_TAIL_LEVELS_UNIFORM_LOC 2
 #define SUM_PRESCALE_UNIFORM_LOC       1
+#define SUM_OUT_SCALE_UNIFORM_LOC      2
+
+#define LOG_COMPRESS_LOCAL_SIZE_X 16
+#define LOG_COMPRESS_LOCAL_SIZE_Y  1
+#define LOG_COMPRESS_LOCAL_SIZE_Z 16
+
+/* NOTE(rnp): one workgroup per (channel, transmit) line. lines are zero padded to a power
+ * of 2 which must fit in shared memory; longer power of 2 lines use the batched FFT and
+ * anything else falls back to the external stage */
+#define HILBERT_LOCAL_SIZE_X  256
+#define HILBERT_FFT_MAX_SIZE  4096
+
+#define HILBERT_SAMPLE_COUNT_UNIFORM_LOC 1
+#define HILBERT_FFT_SIZE_UNIFORM_LOC     2
+
+/* NOTE(rnp): batched Stockham FFT over contiguous power of 2 lines of complex f32 data.
+ * each dispatch is a single radix 2, 4, or 8 pass between two buffers */
+#define FFT_LOCAL_SIZE_X 64
+#define FFT_MAX_SIZE     (1 << 16)
+
+#define FFT_SIZE_UNIFORM_LOC       1
+#define FFT_STRIDE_UNIFORM_LOC     2
+#define FFT_LINE_COUNT_UNIFORM_LOC 3
+#define FFT_DIRECTION_UNIFORM_LOC  4
+#define FFT_FLAGS_UNIFORM_LOC      5
+
+/* NOTE(rnp): applied to the loads of the first pass only
+ *            RealInput:    treat the input as real (imaginary part is ignored)
+ *            AnalyticMask: zero negative frequencies and double positive frequencies
+ *            Normalize:    scale by 1 / size */
+#define BEAMFORMER_FFT_FLAG_LIST \
+	X(RealInput,    0) \
+	X(AnalyticMask, 1) \
+	X(Normalize,    2)
 
 #define MAX_BEAMFORMED_SAVED_FRAMES 16
+/* NOTE(rnp): at most this many 2D frames are beamformed by a single DAS dispatch series */
+#define BEAMFORMER_MAX_DAS_BATCH     8
 #define MAX_COMPUTE_SHADER_STAGES   16
 
 #define BEAMFORMER_FILTER_SLOTS      4
@@ -2,7 +2,7 @@
 #ifndef _BEAMFORMER_WORK_QUEUE_H_
 #define _BEAMFORMER_WORK_QUEUE_H_
 
-#define BEAMFORMER_SHARED_MEMORY_VERSION (11UL)
+#define BEAMFORMER_SHARED_MEMORY_VERSION (19UL)
 
 typedef struct BeamformerFrame     BeamformerFrame;
 typedef struct ShaderReloadContext ShaderReloadContext;
@@ -47,6 +47,8 @@ typedef struct {
 typedef enum {
 	BeamformerExportKind_BeamformedData,
 	BeamformerExportKind_Stats,
+	BeamformerExportKind_CompressedData,
+	BeamformerExportKind_RFData,
 } BeamformerExportKind;
 
 typedef struct {
@@ -56,6 +58,8 @@ typedef struct {
 
 typedef union {
 	u8 filter_slot;
+	u8 sum_mode;
+	u8 das_flags;
 } BeamformerShaderParameters;
 
 #define BEAMFORMER_SHARED_MEMORY_LOCKS \
@@ -113,6 +117,14 @@ typedef BEAMFORM_WORK_QUEUE_PUSH_COMMIT_FN(beamform_work_queue_push_commit_fn);
 typedef enum {BEAMFORMER_LIVE_IMAGING_DIRTY_FLAG_LIST} BeamformerLiveImagingDirtyFlags;
 #undef X
 
+#define X(name, id) BeamformerDASFlags_##name = (1 << id),
+typedef enum {BEAMFORMER_DAS_FLAG_LIST} BeamformerDASFlags;
+#undef X
+
+#define X(name, id) BeamformerPipelineFlags_##name = (1 << id),
+typedef enum {BEAMFORMER_PIPELINE_FLAG_LIST} BeamformerPipelineFlags;
+#undef X
+
 typedef struct {
 	u32 version;
 
@@ -149,10 +161,20 @@ typedef struct {
 	BeamformerShaderParameters shader_parameters[MAX_COMPUTE_SHADER_STAGES];
 	i32                        shader_count;
 	BeamformerDataKind         data_kind;
+	BeamformerPipelineFlags    pipeline_flags;
+	BeamformerOutputFormat     output_format;
+
+	BeamformerLogCompressParameters log_compress_parameters;
+
+	/* NOTE(rnp): consecutive frames beamformed together; see beamformer_set_das_batch() */
+	u32 das_batch_count;
 
 	/* TODO(rnp): this is really sucky. we need a better way to communicate this */
 	u32 scratch_rf_size;
 
+	/* NOTE(rnp): incremented to clear the latency histograms */
+	u32 compute_stats_reset_count;
+
 	BeamformerLiveImagingParameters live_imaging_parameters;
 	BeamformerLiveImagingDirtyFlags live_imaging_dirty_flags;
 
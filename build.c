@@ -53,6 +53,7 @@ global char *g_argv0;
   #include "os_linux.c"
 
   #define W32_DECL(x)
+  #define LINUX_DECL(x) x
 
   #define OS_SHARED_LINK_LIB(s) "lib" s ".so"
   #define OS_SHARED_LIB(s)      s ".so"
@@ -64,6 +65,7 @@ global char *g_argv0;
   #include "os_win32.c"
 
   #define W32_DECL(x) x
+  #define LINUX_DECL(x)
 
   #define OS_SHARED_LINK_LIB(s) s ".dll"
   #define OS_SHARED_LIB(s)      s ".dll"
@@ -212,12 +214,6 @@ os_remove_file(char *name)
 	return result;
 }
 
-function void
-os_make_directory(char *name)
-{
-	mkdir(name, 0770);
-}
-
 function u64
 os_get_filetime(char *file)
 {
@@ -278,18 +274,11 @@ enum {
 	MOVEFILE_REPLACE_EXISTING = 0x01,
 };
 
-W32(b32) CreateDirectoryA(c8 *, void *);
 W32(b32) CreateProcessA(u8 *, u8 *, iptr, iptr, b32, u32, iptr, u8 *, iptr, iptr);
 W32(b32) GetExitCodeProcess(iptr handle, u32 *);
 W32(b32) GetFileTime(iptr, iptr, iptr, iptr);
 W32(b32) MoveFileExA(c8 *, c8 *, u32);
 
-function void
-os_make_directory(char *name)
-{
-	CreateDirectoryA(name, 0);
-}
-
 function b32
 os_rename_file(char *name, char *new)
 {
@@ -673,6 +662,18 @@ build_helper_library(Arena arena, CommandList cc)
 	return result;
 }
 
+function b32
+build_cpu_stages_library(Arena arena, CommandList cc)
+{
+	char *library = "external/" OS_SHARED_LIB("cpu_stages");
+	char *libs[]  = {is_w32 ? LINK_LIB("Synchronization") : "-lm"};
+
+	if (!is_msvc) cmd_append(&arena, &cc, "-Wno-unused-function");
+	b32 result = build_shared_library(arena, cc, "cpu_stages", library,
+	                                  libs, countof(libs), arg_list(char *, "cpu_stages.c"));
+	return result;
+}
+
 function b32
 build_beamformer_as_library(Arena arena, CommandList cc)
 {
@@ -691,8 +692,12 @@ function b32
 build_tests(Arena arena, CommandList cc)
 {
 	#define TEST_PROGRAMS \
-		X("decode", W32_DECL(LINK_LIB("Synchronization"))) \
-		X("throughput", LINK_LIB("zstd"), W32_DECL(LINK_LIB("Synchronization")))
+		X("cpu_das_throughput", LINUX_DECL("-lm"), W32_DECL(LINK_LIB("Synchronization"))) \
+		X("das",                LINUX_DECL("-lm"), W32_DECL(LINK_LIB("Synchronization"))) \
+		X("decode",             W32_DECL(LINK_LIB("Synchronization"))) \
+		X("fft",                LINUX_DECL("-lm"), W32_DECL(LINK_LIB("Synchronization"))) \
+		X("filter",             LINUX_DECL("-lm"), W32_DECL(LINK_LIB("Synchronization"))) \
+		X("throughput",         LINK_LIB("zstd"), W32_DECL(LINK_LIB("Synchronization")))
 
 	os_make_directory(OUTPUT("tests"));
 	if (!is_msvc) cmd_append(&arena, &cc, "-Wno-unused-function");
@@ -810,6 +815,26 @@ build_matlab_bindings(Arena arena)
 		meta_begin_scope(&m, s8("enumeration"));
 		BEAMFORMER_DATA_KIND_LIST
 		result &= meta_end_and_write_matlab(&m, OUTPUT("matlab/OGLBeamformerDataKind.m"));
+
+		meta_begin_matlab_class(&m, "OGLBeamformerSumMode", "int32");
+		meta_begin_scope(&m, s8("enumeration"));
+		BEAMFORMER_SUM_MODE_LIST
+		result &= meta_end_and_write_matlab(&m, OUTPUT("matlab/OGLBeamformerSumMode.m"));
+
+		meta_begin_matlab_class(&m, "OGLBeamformerDASFlags", "int32");
+		meta_begin_scope(&m, s8("enumeration"));
+		BEAMFORMER_DAS_FLAG_LIST
+		result &= meta_end_and_write_matlab(&m, OUTPUT("matlab/OGLBeamformerDASFlags.m"));
+
+		meta_begin_matlab_class(&m, "OGLBeamformerPipelineFlags", "int32");
+		meta_begin_scope(&m, s8("enumeration"));
+		BEAMFORMER_PIPELINE_FLAG_LIST
+		result &= meta_end_and_write_matlab(&m, OUTPUT("matlab/OGLBeamformerPipelineFlags.m"));
+
+		meta_begin_matlab_class(&m, "OGLBeamformerOutputFormat", "int32");
+		meta_begin_scope(&m, s8("enumeration"));
+		BEAMFORMER_OUTPUT_FORMAT_LIST
+		result &= meta_end_and_write_matlab(&m, OUTPUT("matlab/OGLBeamformerOutputFormat.m"));
 		#undef X
 
 		#define X(name, __t, __s, elements, ...) meta_push_line(&m, s8(#name "(1," #elements ")"));
@@ -867,6 +892,7 @@ main(i32 argc, char *argv[])
 	// helpers/tests
 	result &= build_matlab_bindings(arena);
 	result &= build_helper_library(arena, c);
+	result &= build_cpu_stages_library(arena, c);
 	if (options.tests) result &= build_tests(arena, c);
 
 	//////////////////
@@ -0,0 +1,511 @@
+/* See LICENSE for license details. */
+
+/* NOTE(rnp): CPU implementation of the DAS stage. it follows the reference (non DAS_FAST)
+ * path of shaders/das.glsl and exists as a correctness oracle for the GPU implementation
+ * (see tests/das.c) and for beamforming offline on machines without a capable GPU.
+ * CPU_DAS_LANES voxels along x are beamformed at once using AVX-512, AVX2, or plain scalar
+ * code depending on the target. rows of voxels are split into tiles which are spread across a thread pool.
+ *
+ * requires the OS layer, beamformer_parameters.h, and thread_pool.c to be included first.
+ */
+
+#if ARCH_X64 && defined(__AVX512F__)
+#include <immintrin.h>
+#define CPU_DAS_LANES 16
+typedef __m512  f32xW;
+typedef __m512i i32xW;
+
+#define add_f32xW(a, b)      _mm512_add_ps(a, b)
+#define sub_f32xW(a, b)      _mm512_sub_ps(a, b)
+#define mul_f32xW(a, b)      _mm512_mul_ps(a, b)
+#define div_f32xW(a, b)      _mm512_div_ps(a, b)
+#define min_f32xW(a, b)      _mm512_min_ps(a, b)
+#define max_f32xW(a, b)      _mm512_max_ps(a, b)
+#define sqrt_f32xW(a)        _mm512_sqrt_ps(a)
+#define dup_f32xW(a)         _mm512_set1_ps(a)
+#define store_f32xW(p, a)    _mm512_storeu_ps(p, a)
+#define floor_f32xW(a)       _mm512_floor_ps(a)
+#define ramp_f32xW()         _mm512_setr_ps(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15)
+#define cmp_f32xW(a, b, op)  _mm512_maskz_mov_ps(_mm512_cmp_ps_mask(a, b, op), _mm512_set1_ps(1.0f))
+#define ge_f32xW(a, b)       cmp_f32xW(a, b, _CMP_GE_OQ)
+#define gt_f32xW(a, b)       cmp_f32xW(a, b, _CMP_GT_OQ)
+#define lt_f32xW(a, b)       cmp_f32xW(a, b, _CMP_LT_OQ)
+#define eq_f32xW(a, b)       cmp_f32xW(a, b, _CMP_EQ_OQ)
+#define any_f32xW(a)         (_mm512_cmp_ps_mask(a, _mm512_setzero_ps(), _CMP_NEQ_UQ) != 0)
+
+#define add_i32xW(a, b)      _mm512_add_epi32(a, b)
+#define dup_i32xW(a)         _mm512_set1_epi32(a)
+#define min_i32xW(a, b)      _mm512_min_epi32(a, b)
+#define max_i32xW(a, b)      _mm512_max_epi32(a, b)
+#define trunc_f32xW_i32xW(a) _mm512_cvttps_epi32(a)
+#define gather_f32xW(p, i)   _mm512_i32gather_ps(i, p, 4)
+
+#elif ARCH_X64 && defined(__AVX2__)
+#include <immintrin.h>
+#define CPU_DAS_LANES 8
+typedef __m256  f32xW;
+typedef __m256i i32xW;
+
+#define add_f32xW(a, b)      _mm256_add_ps(a, b)
+#define sub_f32xW(a, b)      _mm256_sub_ps(a, b)
+#define mul_f32xW(a, b)      _mm256_mul_ps(a, b)
+#define div_f32xW(a, b)      _mm256_div_ps(a, b)
+#define min_f32xW(a, b)      _mm256_min_ps(a, b)
+#define max_f32xW(a, b)      _mm256_max_ps(a, b)
+#define sqrt_f32xW(a)        _mm256_sqrt_ps(a)
+#define dup_f32xW(a)         _mm256_set1_ps(a)
+#define store_f32xW(p, a)    _mm256_storeu_ps(p, a)
+#define floor_f32xW(a)       _mm256_floor_ps(a)
+#define ramp_f32xW()         _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7)
+#define cmp_f32xW(a, b, op)  _mm256_and_ps(_mm256_cmp_ps(a, b, op), _mm256_set1_ps(1.0f))
+#define ge_f32xW(a, b)       cmp_f32xW(a, b, _CMP_GE_OQ)
+#define gt_f32xW(a, b)       cmp_f32xW(a, b, _CMP_GT_OQ)
+#define lt_f32xW(a, b)       cmp_f32xW(a, b, _CMP_LT_OQ)
+#define eq_f32xW(a, b)       cmp_f32xW(a, b, _CMP_EQ_OQ)
+#define any_f32xW(a)         (_mm256_movemask_ps(_mm256_cmp_ps(a, _mm256_setzero_ps(), _CMP_NEQ_UQ)) != 0)
+
+#define add_i32xW(a, b)      _mm256_add_epi32(a, b)
+#define dup_i32xW(a)         _mm256_set1_epi32(a)
+#define min_i32xW(a, b)      _mm256_min_epi32(a, b)
+#define max_i32xW(a, b)      _mm256_max_epi32(a, b)
+#define trunc_f32xW_i32xW(a) _mm256_cvttps_epi32(a)
+#define gather_f32xW(p, i)   _mm256_i32gather_ps(p, i, 4)
+
+#else
+#define CPU_DAS_LANES 1
+typedef f32 f32xW;
+typedef i32 i32xW;
+
+#define add_f32xW(a, b)      ((a) + (b))
+#define sub_f32xW(a, b)      ((a) - (b))
+#define mul_f32xW(a, b)      ((a) * (b))
+#define div_f32xW(a, b)      ((a) / (b))
+#define min_f32xW(a, b)      MIN(a, b)
+#define max_f32xW(a, b)      MAX(a, b)
+#define sqrt_f32xW(a)        sqrt_f32(a)
+#define dup_f32xW(a)         (a)
+#define store_f32xW(p, a)    (*(p) = (a))
+#define floor_f32xW(a)       floor_f32(a)
+#define ramp_f32xW()         (0.0f)
+#define ge_f32xW(a, b)       ((f32)((a) >= (b)))
+#define gt_f32xW(a, b)       ((f32)((a) >  (b)))
+#define lt_f32xW(a, b)       ((f32)((a) <  (b)))
+#define eq_f32xW(a, b)       ((f32)((a) == (b)))
+#define any_f32xW(a)         ((a) != 0)
+
+#define add_i32xW(a, b)      ((a) + (b))
+#define dup_i32xW(a)         (a)
+#define min_i32xW(a, b)      MIN(a, b)
+#define max_i32xW(a, b)      MAX(a, b)
+#define trunc_f32xW_i32xW(a) ((i32)(a))
+#define gather_f32xW(p, i)   ((p)[i])
+#endif
+
+#define CPU_DAS_TILE_WIDTH  (4 * CPU_DAS_LANES)
+#define CPU_DAS_C_SPLINE    0.5f
+
+#define TX_MODE_TX_COLS(a) (((a) & 2) != 0)
+#define TX_MODE_RX_COLS(a) (((a) & 1) != 0)
+
+typedef struct {
+	BeamformerParameters parameters;
+	/* NOTE: maps output voxel indices to world coordinates (u_voxel_transform) */
+	m4   voxel_transform;
+	iv3  output_dim;
+	/* NOTE: [z][y][x] */
+	v2  *output;
+	/* NOTE: [channel][transmit][sample] */
+	v2  *rf_data;
+	/* NOTE: [transmit] {steering angle [degrees], focal depth [m]} */
+	v2  *focal_vectors;
+	/* NOTE: [transmit - 1] transmitting element for the sparse methods */
+	i16 *sparse_elements;
+} CPUDASParameters;
+
+typedef struct { f32xW x, y, z; } v3xW;
+typedef struct { f32xW x, y;    } v2xW;
+
+function f32xW
+abs_f32xW(f32xW a)
+{
+	f32xW result = max_f32xW(a, sub_f32xW(dup_f32xW(0), a));
+	return result;
+}
+
+function f32xW
+length_v2xW(f32xW x, f32xW y)
+{
+	f32xW result = sqrt_f32xW(add_f32xW(mul_f32xW(x, x), mul_f32xW(y, y)));
+	return result;
+}
+
+function f32xW
+length_v3xW(f32xW x, f32xW y, f32xW z)
+{
+	f32xW result = sqrt_f32xW(add_f32xW(add_f32xW(mul_f32xW(x, x), mul_f32xW(y, y)), mul_f32xW(z, z)));
+	return result;
+}
+
+/* NOTE(rnp): cosine and sine of 2π * turns. the argument is reduced to [-1/4, 1/4] turns
+ * and the Taylor series is evaluated to 12th (cos) and 11th (sin) order. the error is
+ * below the rounding error of a f32 */
+function void
+cos_sin_turns_f32xW(f32xW turns, f32xW *cos_out, f32xW *sin_out)
+{
+	f32xW r    = sub_f32xW(turns, floor_f32xW(add_f32xW(turns, dup_f32xW(0.5f))));
+	f32xW flip = gt_f32xW(abs_f32xW(r), dup_f32xW(0.25f));
+	f32xW half = sub_f32xW(gt_f32xW(r, dup_f32xW(0)), dup_f32xW(0.5f));
+	r = add_f32xW(r, mul_f32xW(flip, sub_f32xW(half, add_f32xW(r, r))));
+
+	f32xW x  = mul_f32xW(r, dup_f32xW(2.0f * PI));
+	f32xW x2 = mul_f32xW(x, x);
+
+	f32xW c = dup_f32xW(1.0f / 479001600.0f);
+	c = sub_f32xW(dup_f32xW(1.0f / 3628800.0f), mul_f32xW(x2, c));
+	c = sub_f32xW(dup_f32xW(1.0f / 40320.0f),   mul_f32xW(x2, c));
+	c = sub_f32xW(dup_f32xW(1.0f / 720.0f),     mul_f32xW(x2, c));
+	c = sub_f32xW(dup_f32xW(1.0f / 24.0f),      mul_f32xW(x2, c));
+	c = sub_f32xW(dup_f32xW(1.0f / 2.0f),       mul_f32xW(x2, c));
+	c = sub_f32xW(dup_f32xW(1.0f),              mul_f32xW(x2, c));
+
+	f32xW s = dup_f32xW(1.0f / 39916800.0f);
+	s = sub_f32xW(dup_f32xW(1.0f / 362880.0f), mul_f32xW(x2, s));
+	s = sub_f32xW(dup_f32xW(1.0f / 5040.0f),   mul_f32xW(x2, s));
+	s = sub_f32xW(dup_f32xW(1.0f / 120.0f),    mul_f32xW(x2, s));
+	s = sub_f32xW(dup_f32xW(1.0f / 6.0f),      mul_f32xW(x2, s));
+	s = sub_f32xW(dup_f32xW(1.0f),             mul_f32xW(x2, s));
+
+	*cos_out = mul_f32xW(c, sub_f32xW(dup_f32xW(1.0f), add_f32xW(flip, flip)));
+	*sin_out = mul_f32xW(s, x);
+}
+
+function f32xW
+cpu_das_apodize(f32xW arg)
+{
+	f32xW turns = mul_f32xW(min_f32xW(abs_f32xW(arg), dup_f32xW(0.5f * PI)), dup_f32xW(1.0f / (2.0f * PI)));
+	f32xW c, s;
+	cos_sin_turns_f32xW(turns, &c, &s);
+	f32xW result = mul_f32xW(c, c);
+	return result;
+}
+
+/* NOTE(rnp): GCC's unoptimized AVX-512 gather macro passes a constant mask which trips
+ * -Wsign-conversion inside the system header */
+#if COMPILER_GCC || COMPILER_CLANG
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wsign-conversion"
+#endif
+function v2xW
+cpu_das_rf_sample(f32 *rf, i32xW index)
+{
+	v2xW  result;
+	i32xW i2 = add_i32xW(index, index);
+	result.x = gather_f32xW(rf, i2);
+	result.y = gather_f32xW(rf, add_i32xW(i2, dup_i32xW(1)));
+	return result;
+}
+#if COMPILER_GCC || COMPILER_CLANG
+#pragma GCC diagnostic pop
+#endif
+
+function v2xW
+cpu_das_sample_rf(CPUDASParameters *dp, i32 channel, i32 transmit, f32xW index)
+{
+	BeamformerParameters *bp = &dp->parameters;
+	i32 samples = (i32)bp->dec_data_dim[0];
+	i32 last    = samples * (i32)bp->dec_data_dim[1] * (i32)bp->dec_data_dim[2] - 1;
+	i32 base    = channel * samples * (i32)bp->dec_data_dim[2] + transmit * samples;
+	f32 *rf     = (f32 *)dp->rf_data;
+
+	f32xW tk    = floor_f32xW(index);
+	f32xW valid = mul_f32xW(ge_f32xW(index, dup_f32xW(0)),
+	                        lt_f32xW(add_f32xW(tk, dup_f32xW(bp->interpolate ? 2.0f : 0.0f)),
+	                                 dup_f32xW((f32)samples)));
+
+	v2xW result = {0};
+	if (any_f32xW(valid)) {
+		/* NOTE(rnp): out of range lanes are clamped to the buffer and masked off below */
+		if (bp->interpolate) {
+			i32xW i0 = trunc_f32xW_i32xW(max_f32xW(tk, dup_f32xW(0)));
+			i0 = add_i32xW(i0, dup_i32xW(base));
+			v2xW s[4];
+			for (i32 i = 0; i < 4; i++)
+				s[i] = cpu_das_rf_sample(rf, min_i32xW(max_i32xW(add_i32xW(i0, dup_i32xW(i - 1)), dup_i32xW(0)), dup_i32xW(last)));
+
+			/* NOTE: See: https://cubic.org/docs/hermite.htm */
+			f32xW t   = sub_f32xW(index, tk);
+			f32xW t2  = mul_f32xW(t, t);
+			f32xW t3  = mul_f32xW(t2, t);
+			f32xW h0  = add_f32xW(sub_f32xW(mul_f32xW(dup_f32xW(2), t3), mul_f32xW(dup_f32xW(3), t2)), dup_f32xW(1));
+			f32xW h1  = sub_f32xW(mul_f32xW(dup_f32xW(3), t2), mul_f32xW(dup_f32xW(2), t3));
+			f32xW h2  = add_f32xW(sub_f32xW(t3, mul_f32xW(dup_f32xW(2), t2)), t);
+			f32xW h3  = sub_f32xW(t3, t2);
+			f32xW cs  = dup_f32xW(CPU_DAS_C_SPLINE);
+
+			f32xW t1x = mul_f32xW(cs, sub_f32xW(s[2].x, s[0].x));
+			f32xW t1y = mul_f32xW(cs, sub_f32xW(s[2].y, s[0].y));
+			f32xW t2x = mul_f32xW(cs, sub_f32xW(s[3].x, s[1].x));
+			f32xW t2y = mul_f32xW(cs, sub_f32xW(s[3].y, s[1].y));
+
+			result.x = add_f32xW(add_f32xW(mul_f32xW(h0, s[1].x), mul_f32xW(h1, s[2].x)),
+			                     add_f32xW(mul_f32xW(h2, t1x),    mul_f32xW(h3, t2x)));
+			result.y = add_f32xW(add_f32xW(mul_f32xW(h0, s[1].y), mul_f32xW(h1, s[2].y)),
+			                     add_f32xW(mul_f32xW(h2, t1y),    mul_f32xW(h3, t2y)));
+		} else {
+			i32xW i0 = trunc_f32xW_i32xW(floor_f32xW(add_f32xW(max_f32xW(index, dup_f32xW(0)), dup_f32xW(0.5f))));
+			i0 = min_i32xW(add_i32xW(i0, dup_i32xW(base)), dup_i32xW(last));
+			result = cpu_das_rf_sample(rf, i0);
+		}
+		result.x = mul_f32xW(result.x, valid);
+		result.y = mul_f32xW(result.y, valid);
+
+		if (bp->center_frequency > 0) {
+			f32xW c, s;
+			cos_sin_turns_f32xW(mul_f32xW(index, dup_f32xW(bp->center_frequency / bp->sampling_frequency)), &c, &s);
+			v2xW iq  = result;
+			result.x = sub_f32xW(mul_f32xW(c, iq.x), mul_f32xW(s, iq.y));
+			result.y = add_f32xW(mul_f32xW(s, iq.x), mul_f32xW(c, iq.y));
+		}
+	}
+	return result;
+}
+
+function f32xW
+cpu_das_sample_index(BeamformerParameters *bp, f32xW distance)
+{
+	f32xW time   = add_f32xW(div_f32xW(distance, dup_f32xW(bp->speed_of_sound)), dup_f32xW(bp->time_offset));
+	f32xW result = mul_f32xW(time, dup_f32xW(bp->sampling_frequency));
+	return result;
+}
+
+function v3xW
+cpu_das_transform_point(f32 *m, v3xW p)
+{
+	v3xW result;
+	result.x = add_f32xW(add_f32xW(mul_f32xW(dup_f32xW(m[0]), p.x), mul_f32xW(dup_f32xW(m[4]), p.y)),
+	                     add_f32xW(mul_f32xW(dup_f32xW(m[8]), p.z), dup_f32xW(m[12])));
+	result.y = add_f32xW(add_f32xW(mul_f32xW(dup_f32xW(m[1]), p.x), mul_f32xW(dup_f32xW(m[5]), p.y)),
+	                     add_f32xW(mul_f32xW(dup_f32xW(m[9]), p.z), dup_f32xW(m[13])));
+	result.z = add_f32xW(add_f32xW(mul_f32xW(dup_f32xW(m[2]), p.x), mul_f32xW(dup_f32xW(m[6]), p.y)),
+	                     add_f32xW(mul_f32xW(dup_f32xW(m[10]), p.z), dup_f32xW(m[14])));
+	return result;
+}
+
+function v2xW
+cpu_das_rca_plane_projection(v3xW point, b32 rows)
+{
+	v2xW result = {rows ? point.y : point.x, point.z};
+	return result;
+}
+
+function f32xW
+cpu_das_transmit_distance(v3xW world_point, v2 focal_vector, b32 tx_rows)
+{
+	f32  depth = focal_vector.y;
+	v2xW p     = cpu_das_rca_plane_projection(world_point, tx_rows);
+
+	f32xW c, s;
+	cos_sin_turns_f32xW(dup_f32xW(focal_vector.x / 360.0f), &c, &s);
+
+	f32xW result;
+	if (depth == F32_INFINITY || depth == -F32_INFINITY) {
+		result = add_f32xW(mul_f32xW(p.x, s), mul_f32xW(p.y, c));
+	} else {
+		f32xW d = dup_f32xW(depth);
+		result  = length_v2xW(sub_f32xW(p.x, mul_f32xW(d, s)), sub_f32xW(p.y, mul_f32xW(d, c)));
+	}
+	return result;
+}
+
+typedef struct {
+	f32xW re, im, coherence;
+} CPUDASSum;
+
+function void
+cpu_das_accumulate(CPUDASSum *sum, f32xW apodization, v2xW value)
+{
+	f32xW re = mul_f32xW(apodization, value.x);
+	f32xW im = mul_f32xW(apodization, value.y);
+	sum->re        = add_f32xW(sum->re, re);
+	sum->im        = add_f32xW(sum->im, im);
+	sum->coherence = add_f32xW(sum->coherence, length_v2xW(re, im));
+}
+
+function CPUDASSum
+cpu_das_forces(CPUDASParameters *dp, Arena scratch, v3xW world_point)
+{
+	BeamformerParameters *bp = &dp->parameters;
+	i32  uforces   = bp->das_shader_id == DASShaderKind_UFORCES;
+	i32  channels  = (i32)bp->dec_data_dim[1];
+	i32  transmits = (i32)bp->dec_data_dim[2];
+	v3xW xdc_point = cpu_das_transform_point(bp->xdc_transform, world_point);
+
+	/* NOTE(rnp): the transmit distance only depends on the voxel */
+	f32xW *transmit_distance = push_array(&scratch, f32xW, transmits);
+	for (i32 transmit = uforces; transmit < transmits; transmit++) {
+		i32 tx_channel = uforces ? dp->sparse_elements[transmit - 1] : transmit;
+		f32 center_x   = bp->xdc_element_pitch[0] * (f32)tx_channel;
+		f32 center_y   = bp->xdc_element_pitch[1] * (f32)(channels / 2);
+		transmit_distance[transmit] = length_v3xW(sub_f32xW(xdc_point.x, dup_f32xW(center_x)),
+		                                          sub_f32xW(xdc_point.y, dup_f32xW(center_y)),
+		                                          xdc_point.z);
+	}
+
+	f32xW apodization_scale = div_f32xW(dup_f32xW(bp->f_number * PI), abs_f32xW(xdc_point.z));
+
+	CPUDASSum result = {0};
+	for (i32 rx_channel = 0; rx_channel < channels; rx_channel++) {
+		f32xW dx = sub_f32xW(xdc_point.x, dup_f32xW((f32)rx_channel * bp->xdc_element_pitch[0]));
+		f32xW receive_distance = length_v2xW(dx, xdc_point.z);
+		f32xW apodization      = cpu_das_apodize(mul_f32xW(apodization_scale, dx));
+		if (any_f32xW(apodization)) {
+			for (i32 transmit = uforces; transmit < transmits; transmit++) {
+				f32xW sidx = cpu_das_sample_index(bp, add_f32xW(transmit_distance[transmit], receive_distance));
+				cpu_das_accumulate(&result, apodization, cpu_das_sample_rf(dp, rx_channel, transmit, sidx));
+			}
+		}
+	}
+	return result;
+}
+
+function CPUDASSum
+cpu_das_hercules(CPUDASParameters *dp, v3xW world_point)
+{
+	BeamformerParameters *bp = &dp->parameters;
+	i32  uhercules = bp->das_shader_id == DASShaderKind_UHERCULES;
+	b32  tx_rows   = !TX_MODE_TX_COLS(bp->transmit_mode);
+	b32  rx_cols   =  TX_MODE_RX_COLS(bp->transmit_mode);
+	i32  channels  = (i32)bp->dec_data_dim[1];
+	i32  transmits = (i32)bp->dec_data_dim[2];
+	v3xW xdc_point = cpu_das_transform_point(bp->xdc_transform, world_point);
+
+	f32xW transmit_distance = cpu_das_transmit_distance(world_point, dp->focal_vectors[0], tx_rows);
+	f32xW apodization_scale = div_f32xW(dup_f32xW(bp->f_number * PI), abs_f32xW(xdc_point.z));
+
+	CPUDASSum result = {0};
+	for (i32 transmit = uhercules; transmit < transmits; transmit++) {
+		i32 tx_channel = uhercules ? dp->sparse_elements[transmit - uhercules] : transmit;
+		/* NOTE: tribal knowledge */
+		f32 transmit_scale = transmit == 0 ? 1.0f / sqrt_f32((f32)transmits) : 1.0f;
+		for (i32 rx_channel = 0; rx_channel < channels; rx_channel++) {
+			f32 element_x, element_y;
+			if (rx_cols) {
+				element_x = (f32)rx_channel * bp->xdc_element_pitch[0];
+				element_y = (f32)tx_channel * bp->xdc_element_pitch[1];
+			} else {
+				element_x = (f32)tx_channel * bp->xdc_element_pitch[0];
+				element_y = (f32)rx_channel * bp->xdc_element_pitch[1];
+			}
+			f32xW dx = sub_f32xW(xdc_point.x, dup_f32xW(element_x));
+			f32xW dy = sub_f32xW(xdc_point.y, dup_f32xW(element_y));
+
+			f32xW apodization = cpu_das_apodize(mul_f32xW(apodization_scale, length_v2xW(dx, dy)));
+			if (any_f32xW(apodization)) {
+				apodization = mul_f32xW(apodization, dup_f32xW(transmit_scale));
+				f32xW sidx  = cpu_das_sample_index(bp, add_f32xW(transmit_distance, length_v3xW(dx, dy, xdc_point.z)));
+				cpu_das_accumulate(&result, apodization, cpu_das_sample_rf(dp, rx_channel, transmit, sidx));
+			}
+		}
+	}
+	return result;
+}
+
+function CPUDASSum
+cpu_das_rca(CPUDASParameters *dp, Arena scratch, v3xW world_point)
+{
+	BeamformerParameters *bp = &dp->parameters;
+	b32  tx_rows   = !TX_MODE_TX_COLS(bp->transmit_mode);
+	b32  rx_rows   = !TX_MODE_RX_COLS(bp->transmit_mode);
+	i32  channels  = (i32)bp->dec_data_dim[1];
+	i32  transmits = (i32)bp->dec_data_dim[2];
+	v2xW xdc_point = cpu_das_rca_plane_projection(cpu_das_transform_point(bp->xdc_transform, world_point), rx_rows);
+
+	/* NOTE(rnp): the receive distance and apodization only depend on the voxel */
+	f32xW *receive_distance = push_array(&scratch, f32xW, channels);
+	f32xW *apodization      = push_array(&scratch, f32xW, channels);
+	f32xW apodization_scale = div_f32xW(dup_f32xW(bp->f_number * PI), abs_f32xW(xdc_point.y));
+	for (i32 rx_channel = 0; rx_channel < channels; rx_channel++) {
+		f32 center = (f32)rx_channel * bp->xdc_element_pitch[rx_rows ? 1 : 0];
+		f32xW dx   = sub_f32xW(xdc_point.x, dup_f32xW(center));
+		receive_distance[rx_channel] = length_v2xW(dx, xdc_point.y);
+		apodization[rx_channel]      = cpu_das_apodize(mul_f32xW(apodization_scale, dx));
+	}
+
+	CPUDASSum result = {0};
+	for (i32 transmit = 0; transmit < transmits; transmit++) {
+		f32xW transmit_distance = cpu_das_transmit_distance(world_point, dp->focal_vectors[transmit], tx_rows);
+		for (i32 rx_channel = 0; rx_channel < channels; rx_channel++) {
+			if (any_f32xW(apodization[rx_channel])) {
+				f32xW sidx = cpu_das_sample_index(bp, add_f32xW(transmit_distance, receive_distance[rx_channel]));
+				cpu_das_accumulate(&result, apodization[rx_channel], cpu_das_sample_rf(dp, rx_channel, transmit, sidx));
+			}
+		}
+	}
+	return result;
+}
+
+function THREAD_POOL_JOB_FN(cpu_das_job)
+{
+	CPUDASParameters     *dp = user_context;
+	BeamformerParameters *bp = &dp->parameters;
+	iv3 dim = dp->output_dim;
+
+	i32 tiles_x = (dim.x + CPU_DAS_TILE_WIDTH - 1) / CPU_DAS_TILE_WIDTH;
+	i32 tile    = (i32)item % tiles_x;
+	i32 y       = ((i32)item / tiles_x) % dim.y;
+	i32 z       = ((i32)item / tiles_x) / dim.y;
+
+	f32 *m = dp->voxel_transform.E;
+	i32 x_end = MIN(dim.x, (tile + 1) * CPU_DAS_TILE_WIDTH);
+	for (i32 x = tile * CPU_DAS_TILE_WIDTH; x < x_end; x += CPU_DAS_LANES) {
+		f32xW xs = add_f32xW(dup_f32xW((f32)x), ramp_f32xW());
+		v3xW world_point;
+		world_point.x = add_f32xW(mul_f32xW(dup_f32xW(m[0]), xs), dup_f32xW(m[4] * (f32)y + m[8]  * (f32)z + m[12]));
+		world_point.y = add_f32xW(mul_f32xW(dup_f32xW(m[1]), xs), dup_f32xW(m[5] * (f32)y + m[9]  * (f32)z + m[13]));
+		world_point.z = add_f32xW(mul_f32xW(dup_f32xW(m[2]), xs), dup_f32xW(m[6] * (f32)y + m[10] * (f32)z + m[14]));
+
+		CPUDASSum sum = {0};
+		switch (bp->das_shader_id) {
+		case DASShaderKind_FORCES:
+		case DASShaderKind_UFORCES:
+		{
+			sum = cpu_das_forces(dp, scratch, world_point);
+		}break;
+		case DASShaderKind_HERCULES:
+		case DASShaderKind_UHERCULES:
+		{
+			sum = cpu_das_hercules(dp, world_point);
+		}break;
+		case DASShaderKind_FLASH:
+		case DASShaderKind_RCA_TPW:
+		case DASShaderKind_RCA_VLS:
+		{
+			sum = cpu_das_rca(dp, scratch, world_point);
+		}break;
+		default:{}break;
+		}
+
+		if (bp->coherency_weighting) {
+			f32xW scale = div_f32xW(dup_f32xW(1.0f), add_f32xW(sum.coherence, eq_f32xW(sum.coherence, dup_f32xW(0))));
+			sum.re = mul_f32xW(sum.re, mul_f32xW(sum.re, scale));
+			sum.im = mul_f32xW(sum.im, mul_f32xW(sum.im, scale));
+		}
+
+		f32 re[CPU_DAS_LANES], im[CPU_DAS_LANES];
+		store_f32xW(re, sum.re);
+		store_f32xW(im, sum.im);
+		v2 *out = dp->output + x + dim.x * (y + dim.y * z);
+		for (i32 i = 0; i < MIN(CPU_DAS_LANES, dim.x - x); i++) {
+			out[i].x = re[i];
+			out[i].y = im[i];
+		}
+	}
+}
+
+function void
+cpu_das_beamform(ThreadPool *pool, CPUDASParameters *dp)
+{
+	iv3 dim = dp->output_dim;
+	u32 tiles_x = (u32)(dim.x + CPU_DAS_TILE_WIDTH - 1) / CPU_DAS_TILE_WIDTH;
+	thread_pool_run(pool, cpu_das_job, dp, tiles_x * (u32)dim.y * (u32)dim.z);
+}
@@ -0,0 +1,268 @@
+/* See LICENSE for license details. */
+
+/* NOTE(rnp): host memory backend for the external stage interface (see external_stage.h).
+ * every call operates on the mapped copies registered by the beamformer and is split
+ * across a thread pool.
+ *
+ * decode:  Hadamard decode of i16 rf data. vectorized over 4 time samples.
+ * hilbert: analytic signal of the real part of each (channel, transmit) line found with
+ *          a radix-2 FFT. vectorized over 4 lines. lines are zero padded to the next
+ *          power of 2 so the result differs from an exact length transform near the end
+ *          of each line.
+ */
+#include "compiler.h"
+
+#include "util.h"
+#include "external_stage.h"
+
+#if OS_LINUX
+#include "os_linux.c"
+#elif OS_WINDOWS
+#include "os_win32.c"
+#else
+#error Unsupported Platform
+#endif
+
+#include "thread_pool.c"
+
+#if OS_WINDOWS
+  #define CPU_STAGES_EXPORT __declspec(dllexport)
+#else
+  #define CPU_STAGES_EXPORT
+#endif
+
+#define CPU_STAGES_MAX_CHANNELS      256
+#define CPU_STAGES_MAX_ORDER         256
+#define CPU_STAGES_THREAD_SCRATCH    MB(8)
+#define CPU_STAGES_ARENA_SIZE        MB(4)
+#define CPU_DECODE_BLOCK_SAMPLES     64
+
+typedef struct {
+	ThreadPool pool;
+	u32        input_index;
+	u32        output_index;
+
+	/* NOTE: holds the FFT twiddle factors; reset on every init */
+	Arena arena;
+
+	u32 input_dims[2];
+	u32 decoded_dims[4];
+
+	f32 *rf_data[2];
+	i16 *raw_data;
+
+	u32 fft_size;
+	f32 *twiddle_re;
+	f32 *twiddle_im;
+
+	u32 hadamard_order;
+	f32 hadamard[CPU_STAGES_MAX_ORDER * CPU_STAGES_MAX_ORDER];
+	i16 channel_mapping[CPU_STAGES_MAX_CHANNELS];
+} CPUStagesContext;
+
+global CPUStagesContext g_cpu_stages;
+
+function THREAD_POOL_JOB_FN(cpu_decode_job)
+{
+	CPUStagesContext *ctx = user_context;
+	u32 samples   = ctx->decoded_dims[0];
+	u32 transmits = ctx->decoded_dims[2];
+	u32 blocks    = (samples + CPU_DECODE_BLOCK_SAMPLES - 1) / CPU_DECODE_BLOCK_SAMPLES;
+	u32 channel   = item / blocks;
+	u32 sample    = (item % blocks) * CPU_DECODE_BLOCK_SAMPLES;
+	u32 count     = MIN(CPU_DECODE_BLOCK_SAMPLES, samples - sample);
+
+	/* NOTE(rnp): gather the block of every transmit for the mapped channel */
+	f32 *x   = push_array(&scratch, f32, transmits * CPU_DECODE_BLOCK_SAMPLES);
+	i16 *raw = ctx->raw_data + (iz)ctx->channel_mapping[channel] * ctx->input_dims[0] + sample;
+	for (u32 t = 0; t < transmits; t++)
+		for (u32 s = 0; s < count; s++)
+			x[t * CPU_DECODE_BLOCK_SAMPLES + s] = raw[t * samples + s];
+
+	f32 *out   = ctx->rf_data[ctx->output_index];
+	u32 order  = ctx->hadamard_order == transmits ? transmits : 0;
+	f32x4 scale = dup_f32x4(order ? 1.0f / (f32)order : 1.0f);
+	for (u32 t = 0; t < transmits; t++) {
+		f32 *o = out + 2 * ((channel * transmits + t) * samples + sample);
+		for (u32 s = 0; s < count; s += 4) {
+			f32x4 sum;
+			if (order) {
+				sum = dup_f32x4(0);
+				f32 *h = ctx->hadamard + t * order;
+				for (u32 i = 0; i < order; i++)
+					sum = add_f32x4(sum, mul_f32x4(dup_f32x4(h[i]), load_f32x4(x + i * CPU_DECODE_BLOCK_SAMPLES + s)));
+			} else {
+				sum = load_f32x4(x + t * CPU_DECODE_BLOCK_SAMPLES + s);
+			}
+
+			f32 lanes[4];
+			store_f32x4(lanes, mul_f32x4(sum, scale));
+			for (u32 j = 0; j < 4 && s + j < count; j++) {
+				o[2 * (s + j) + 0] = lanes[j];
+				o[2 * (s + j) + 1] = 0;
+			}
+		}
+	}
+}
+
+/* NOTE(rnp): in place radix-2 decimation in time FFT of 4 interleaved sequences */
+function void
+cpu_fft_x4(CPUStagesContext *ctx, f32 *re, f32 *im)
+{
+	u32 n = ctx->fft_size;
+	for (u32 i = 1, j = 0; i < n; i++) {
+		u32 bit = n >> 1;
+		for (; j & bit; bit >>= 1)
+			j ^= bit;
+		j ^= bit;
+		if (i < j) {
+			f32x4 tr = load_f32x4(re + 4 * i), ti = load_f32x4(im + 4 * i);
+			store_f32x4(re + 4 * i, load_f32x4(re + 4 * j));
+			store_f32x4(im + 4 * i, load_f32x4(im + 4 * j));
+			store_f32x4(re + 4 * j, tr);
+			store_f32x4(im + 4 * j, ti);
+		}
+	}
+
+	for (u32 size = 2; size <= n; size *= 2) {
+		u32 half = size / 2;
+		u32 step = n / size;
+		for (u32 k = 0; k < n; k += size) {
+			for (u32 j = 0; j < half; j++) {
+				f32x4 wr = dup_f32x4(ctx->twiddle_re[j * step]);
+				f32x4 wi = dup_f32x4(ctx->twiddle_im[j * step]);
+				f32 *ar = re + 4 * (k + j),        *ai = im + 4 * (k + j);
+				f32 *br = re + 4 * (k + j + half), *bi = im + 4 * (k + j + half);
+
+				f32x4 xr = load_f32x4(br), xi = load_f32x4(bi);
+				f32x4 tr = sub_f32x4(mul_f32x4(wr, xr), mul_f32x4(wi, xi));
+				f32x4 ti = add_f32x4(mul_f32x4(wr, xi), mul_f32x4(wi, xr));
+				f32x4 ur = load_f32x4(ar), ui = load_f32x4(ai);
+				store_f32x4(ar, add_f32x4(ur, tr));
+				store_f32x4(ai, add_f32x4(ui, ti));
+				store_f32x4(br, sub_f32x4(ur, tr));
+				store_f32x4(bi, sub_f32x4(ui, ti));
+			}
+		}
+	}
+}
+
+function THREAD_POOL_JOB_FN(cpu_hilbert_job)
+{
+	CPUStagesContext *ctx = user_context;
+	u32 samples = ctx->decoded_dims[0];
+	u32 lines   = ctx->decoded_dims[1] * ctx->decoded_dims[2];
+	u32 n       = ctx->fft_size;
+
+	f32 *re = push_array(&scratch, f32, 4 * n);
+	f32 *im = push_array(&scratch, f32, 4 * n);
+
+	f32 *in  = ctx->rf_data[ctx->input_index];
+	f32 *out = ctx->rf_data[ctx->output_index];
+
+	u32 line = 4 * item;
+	for (u32 l = 0; l < 4 && line + l < lines; l++)
+		for (u32 s = 0; s < samples; s++)
+			re[4 * s + l] = in[2 * ((line + l) * samples + s)];
+
+	cpu_fft_x4(ctx, re, im);
+
+	/* NOTE(rnp): keep DC and nyquist, double positive and drop negative frequencies.
+	 * the inverse transform is done with the forward transform by conjugating the
+	 * input and output */
+	f32x4 zero = dup_f32x4(0), two = dup_f32x4(2.0f), neg_two = dup_f32x4(-2.0f);
+	store_f32x4(im, sub_f32x4(zero, load_f32x4(im)));
+	store_f32x4(im + 4 * (n / 2), sub_f32x4(zero, load_f32x4(im + 4 * (n / 2))));
+	for (u32 k = 1; k < n / 2; k++) {
+		store_f32x4(re + 4 * k, mul_f32x4(two,     load_f32x4(re + 4 * k)));
+		store_f32x4(im + 4 * k, mul_f32x4(neg_two, load_f32x4(im + 4 * k)));
+	}
+	for (u32 k = n / 2 + 1; k < n; k++) {
+		store_f32x4(re + 4 * k, zero);
+		store_f32x4(im + 4 * k, zero);
+	}
+
+	cpu_fft_x4(ctx, re, im);
+
+	f32 scale = 1.0f / (f32)n;
+	for (u32 l = 0; l < 4 && line + l < lines; l++) {
+		f32 *o = out + 2 * (line + l) * samples;
+		for (u32 s = 0; s < samples; s++) {
+			o[2 * s + 0] =  scale * re[4 * s + l];
+			o[2 * s + 1] = -scale * im[4 * s + l];
+		}
+	}
+}
+
+CPU_STAGES_EXPORT EXTERNAL_STAGE_INIT_FN(cpu_stages_init)
+{
+	CPUStagesContext *ctx = &g_cpu_stages;
+	if (!ctx->pool.thread_count) {
+		thread_pool_start(&ctx->pool, 0, CPU_STAGES_THREAD_SCRATCH, s8("cpu_stages"));
+		ctx->arena = os_alloc_arena(CPU_STAGES_ARENA_SIZE);
+		for (u32 i = 0; i < CPU_STAGES_MAX_CHANNELS; i++)
+			ctx->channel_mapping[i] = (i16)i;
+	}
+
+	mem_copy(ctx->input_dims,   input_dims,   sizeof(ctx->input_dims));
+	mem_copy(ctx->decoded_dims, decoded_dims, sizeof(ctx->decoded_dims));
+
+	Arena arena   = ctx->arena;
+	ctx->fft_size = round_up_power_of_2(MAX(2, decoded_dims[0]));
+	ctx->twiddle_re = push_array(&arena, f32, ctx->fft_size / 2);
+	ctx->twiddle_im = push_array(&arena, f32, ctx->fft_size / 2);
+	for (u32 k = 0; k < ctx->fft_size / 2; k++) {
+		f32 angle = 2.0f * PI * (f32)k / (f32)ctx->fft_size;
+		ctx->twiddle_re[k] =  cos_f32(angle);
+		ctx->twiddle_im[k] = -sin_f32(angle);
+	}
+}
+
+CPU_STAGES_EXPORT EXTERNAL_STAGE_REGISTER_HOST_BUFFERS_FN(cpu_stages_register_buffers)
+{
+	CPUStagesContext *ctx = &g_cpu_stages;
+	for (u32 i = 0; i < MIN(rf_buffer_count, countof(ctx->rf_data)); i++)
+		ctx->rf_data[i] = rf_data[i];
+	ctx->raw_data = raw_data;
+}
+
+CPU_STAGES_EXPORT EXTERNAL_STAGE_SET_CHANNEL_MAPPING_FN(cpu_stages_set_channel_mapping)
+{
+	mem_copy(g_cpu_stages.channel_mapping, channel_mapping, sizeof(g_cpu_stages.channel_mapping));
+}
+
+CPU_STAGES_EXPORT EXTERNAL_STAGE_SET_HADAMARD_FN(cpu_stages_set_hadamard)
+{
+	CPUStagesContext *ctx = &g_cpu_stages;
+	ctx->hadamard_order = 0;
+	if (hadamard && order <= CPU_STAGES_MAX_ORDER) {
+		for (u32 i = 0; i < order * order; i++)
+			ctx->hadamard[i] = (f32)hadamard[i];
+		ctx->hadamard_order = order;
+	}
+}
+
+CPU_STAGES_EXPORT EXTERNAL_STAGE_DECODE_FN(cpu_stages_decode)
+{
+	CPUStagesContext *ctx = &g_cpu_stages;
+	u32 blocks   = (ctx->decoded_dims[0] + CPU_DECODE_BLOCK_SAMPLES - 1) / CPU_DECODE_BLOCK_SAMPLES;
+	u32 channels = MIN(ctx->decoded_dims[1], CPU_STAGES_MAX_CHANNELS);
+	if (ctx->raw_data && ctx->decoded_dims[2] <= CPU_STAGES_MAX_ORDER) {
+		i16 *raw_data = ctx->raw_data;
+		ctx->raw_data = (i16 *)((u8 *)raw_data + input_offset);
+		ctx->output_index = output_buffer_idx;
+		thread_pool_run(&ctx->pool, cpu_decode_job, ctx, blocks * channels);
+		ctx->raw_data = raw_data;
+	}
+}
+
+CPU_STAGES_EXPORT EXTERNAL_STAGE_HILBERT_FN(cpu_stages_hilbert)
+{
+	CPUStagesContext *ctx = &g_cpu_stages;
+	u32 lines = ctx->decoded_dims[1] * ctx->decoded_dims[2];
+	if (ctx->rf_data[0] && 8 * ctx->fft_size * sizeof(f32) + 64 <= CPU_STAGES_THREAD_SCRATCH) {
+		ctx->input_index  = input_buffer_idx;
+		ctx->output_index = output_buffer_idx;
+		thread_pool_run(&ctx->pool, cpu_hilbert_job, ctx, (lines + 3) / 4);
+	}
+}
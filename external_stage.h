@@ -0,0 +1,56 @@
+/* See LICENSE for license details. */
+#ifndef _EXTERNAL_STAGE_H_
+#define _EXTERNAL_STAGE_H_
+
+/* NOTE(rnp): interface for pipeline stages which are implemented outside of OpenGL.
+ * GPU backends (CUDA) operate directly on the registered GL buffers. host backends
+ * receive pointers to persistently mapped copies of those buffers; the beamformer
+ * copies data into and out of the mapped memory around each call. */
+
+#define EXTERNAL_STAGE_INIT_FN(name) void name(u32 *input_dims, u32 *decoded_dims)
+typedef EXTERNAL_STAGE_INIT_FN(external_stage_init_fn);
+
+#define EXTERNAL_STAGE_REGISTER_BUFFERS_FN(name) void name(u32 *rf_data_ssbos, u32 rf_buffer_count, u32 raw_data_ssbo)
+typedef EXTERNAL_STAGE_REGISTER_BUFFERS_FN(external_stage_register_buffers_fn);
+
+#define EXTERNAL_STAGE_REGISTER_HOST_BUFFERS_FN(name) void name(void **rf_data, u32 rf_buffer_count, void *raw_data)
+typedef EXTERNAL_STAGE_REGISTER_HOST_BUFFERS_FN(external_stage_register_host_buffers_fn);
+
+#define EXTERNAL_STAGE_DECODE_FN(name) void name(size_t input_offset, u32 output_buffer_idx, u32 rf_channel_offset)
+typedef EXTERNAL_STAGE_DECODE_FN(external_stage_decode_fn);
+
+#define EXTERNAL_STAGE_HILBERT_FN(name) void name(u32 input_buffer_idx, u32 output_buffer_idx)
+typedef EXTERNAL_STAGE_HILBERT_FN(external_stage_hilbert_fn);
+
+#define EXTERNAL_STAGE_SET_CHANNEL_MAPPING_FN(name) void name(i16 *channel_mapping)
+typedef EXTERNAL_STAGE_SET_CHANNEL_MAPPING_FN(external_stage_set_channel_mapping_fn);
+
+/* NOTE(rnp): row major order x order matrix; 0 disables decoding */
+#define EXTERNAL_STAGE_SET_HADAMARD_FN(name) void name(i32 *hadamard, u32 order)
+typedef EXTERNAL_STAGE_SET_HADAMARD_FN(external_stage_set_hadamard_fn);
+
+typedef enum {
+	ExternalStageBackend_None,
+	ExternalStageBackend_CUDA,
+	ExternalStageBackend_CPU,
+} ExternalStageBackend;
+
+/* X(name, CUDA symbol, CPU symbol); a missing (0) symbol is left as a stub */
+#define EXTERNAL_STAGE_LIB_FNS \
+	X(decode,                "cuda_decode",              "cpu_stages_decode")              \
+	X(hilbert,               "cuda_hilbert",             "cpu_stages_hilbert")             \
+	X(init,                  "init_cuda_configuration",  "cpu_stages_init")                \
+	X(register_buffers,      "register_cuda_buffers",    0)                                \
+	X(register_host_buffers, 0,                          "cpu_stages_register_buffers")    \
+	X(set_channel_mapping,   "cuda_set_channel_mapping", "cpu_stages_set_channel_mapping") \
+	X(set_hadamard,          0,                          "cpu_stages_set_hadamard")
+
+typedef struct {
+	void *lib;
+	ExternalStageBackend backend;
+	#define X(name, ...) external_stage_ ## name ## _fn *name;
+	EXTERNAL_STAGE_LIB_FNS
+	#undef X
+} ExternalStageLib;
+
+#endif /* _EXTERNAL_STAGE_H_ */
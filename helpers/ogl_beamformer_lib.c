@@ -224,6 +224,80 @@ beamformer_push_pipeline(i32 *shaders, i32 shader_count, BeamformerDataKind data
 	return result;
 }
 
+b32
+beamformer_set_pipeline_flags(u32 flags)
+{
+	b32 result = 0;
+	if (check_shared_memory()) {
+		BeamformerSharedMemoryLockKind lock = BeamformerSharedMemoryLockKind_ComputePipeline;
+		if (lib_try_lock(lock, g_beamformer_library_context.timeout_ms)) {
+			g_beamformer_library_context.bp->pipeline_flags = (BeamformerPipelineFlags)flags;
+			atomic_or_u32(&g_beamformer_library_context.bp->dirty_regions, 1 << (lock - 1));
+			lib_release_lock(lock);
+			result = 1;
+		}
+	}
+	return result;
+}
+
+b32
+beamformer_set_output_format(u32 format)
+{
+	b32 result = 0;
+	if (check_shared_memory()) {
+		BeamformerSharedMemoryLockKind lock = BeamformerSharedMemoryLockKind_ComputePipeline;
+		if (format >= BeamformerOutputFormat_Count) {
+			g_beamformer_library_context.last_error = BF_LIB_ERR_KIND_INVALID_OUTPUT_FORMAT;
+		} else if (lib_try_lock(lock, g_beamformer_library_context.timeout_ms)) {
+			g_beamformer_library_context.bp->output_format = (BeamformerOutputFormat)format;
+			atomic_or_u32(&g_beamformer_library_context.bp->dirty_regions, 1 << (lock - 1));
+			lib_release_lock(lock);
+			result = 1;
+		}
+	}
+	return result;
+}
+
+b32
+beamformer_set_log_compression(f32 dynamic_range, f32 threshold, f32 gamma, u32 bit_depth)
+{
+	b32 result = 0;
+	if (check_shared_memory()) {
+		BeamformerSharedMemoryLockKind lock = BeamformerSharedMemoryLockKind_ComputePipeline;
+		if (bit_depth != 8 && bit_depth != 16) {
+			g_beamformer_library_context.last_error = BF_LIB_ERR_KIND_INVALID_BIT_DEPTH;
+		} else if (lib_try_lock(lock, g_beamformer_library_context.timeout_ms)) {
+			BeamformerLogCompressParameters *lp = &g_beamformer_library_context.bp->log_compress_parameters;
+			lp->dynamic_range = dynamic_range;
+			lp->threshold     = threshold;
+			lp->gamma         = gamma;
+			lp->bit_depth     = bit_depth;
+			atomic_or_u32(&g_beamformer_library_context.bp->dirty_regions, 1 << (lock - 1));
+			lib_release_lock(lock);
+			result = 1;
+		}
+	}
+	return result;
+}
+
+b32
+beamformer_set_das_batch(u32 count)
+{
+	b32 result = 0;
+	if (check_shared_memory()) {
+		BeamformerSharedMemoryLockKind lock = BeamformerSharedMemoryLockKind_ComputePipeline;
+		if (!BETWEEN(count, 1, BEAMFORMER_MAX_DAS_BATCH)) {
+			g_beamformer_library_context.last_error = BF_LIB_ERR_KIND_INVALID_DAS_BATCH;
+		} else if (lib_try_lock(lock, g_beamformer_library_context.timeout_ms)) {
+			g_beamformer_library_context.bp->das_batch_count = count;
+			atomic_or_u32(&g_beamformer_library_context.bp->dirty_regions, 1 << (lock - 1));
+			lib_release_lock(lock);
+			result = 1;
+		}
+	}
+	return result;
+}
+
 function b32
 beamformer_create_filter(BeamformerFilterKind kind, BeamformerFilterParameters params, i32 slot)
 {
@@ -470,7 +544,14 @@ beamform_data_synchronized(void *data, u32 data_size, i32 output_points[3], f32
 		g_beamformer_library_context.bp->parameters.output_points[1] = output_points[1];
 		g_beamformer_library_context.bp->parameters.output_points[2] = output_points[2];
 
-		uz output_size = (u32)output_points[0] * (u32)output_points[1] * (u32)output_points[2] * sizeof(f32) * 2;
+		uz voxel_size = 0;
+		switch (g_beamformer_library_context.bp->output_format) {
+		#define X(name, id, format, size) case BeamformerOutputFormat_##name:{ voxel_size = size; }break;
+		BEAMFORMER_OUTPUT_FORMAT_LIST
+		#undef X
+		default:{ voxel_size = 2 * sizeof(f32); }break;
+		}
+		uz output_size = (u32)output_points[0] * (u32)output_points[1] * (u32)output_points[2] * voxel_size;
 		if (output_size <= BEAMFORMER_SCRATCH_SIZE && beamformer_push_data_with_compute(data, data_size, 0)) {
 			BeamformerExportContext export;
 			export.kind = BeamformerExportKind_BeamformedData;
@@ -490,6 +571,42 @@ beamform_data_synchronized(void *data, u32 data_size, i32 output_points[3], f32
 	return result;
 }
 
+b32
+beamformer_export_log_compressed(void *out_data, u32 size, i32 timeout_ms)
+{
+	b32 result = 0;
+	if (check_shared_memory()) {
+		if (size <= BEAMFORMER_SCRATCH_SIZE) {
+			BeamformerExportContext export;
+			export.kind = BeamformerExportKind_CompressedData;
+			export.size = size;
+			if (beamformer_export_buffer(export) && beamformer_flush_commands(0))
+				result = beamformer_read_output(out_data, size, timeout_ms);
+		} else {
+			g_beamformer_library_context.last_error = BF_LIB_ERR_KIND_EXPORT_SPACE_OVERFLOW;
+		}
+	}
+	return result;
+}
+
+b32
+beamformer_export_rf_data(void *out_data, u32 size, i32 timeout_ms)
+{
+	b32 result = 0;
+	if (check_shared_memory()) {
+		if (size <= BEAMFORMER_SCRATCH_SIZE) {
+			BeamformerExportContext export;
+			export.kind = BeamformerExportKind_RFData;
+			export.size = size;
+			if (beamformer_export_buffer(export) && beamformer_flush_commands(0))
+				result = beamformer_read_output(out_data, size, timeout_ms);
+		} else {
+			g_beamformer_library_context.last_error = BF_LIB_ERR_KIND_EXPORT_SPACE_OVERFLOW;
+		}
+	}
+	return result;
+}
+
 b32
 beamformer_compute_timings(BeamformerComputeStatsTable *output, i32 timeout_ms)
 {
@@ -505,6 +622,17 @@ beamformer_compute_timings(BeamformerComputeStatsTable *output, i32 timeout_ms)
 	return result;
 }
 
+b32
+beamformer_reset_compute_timings(void)
+{
+	b32 result = 0;
+	if (check_shared_memory()) {
+		atomic_add_u32(&g_beamformer_library_context.bp->compute_stats_reset_count, 1);
+		result = 1;
+	}
+	return result;
+}
+
 i32
 beamformer_live_parameters_get_dirty_flag(void)
 {
@@ -21,7 +21,10 @@
 	X(EXPORT_SPACE_OVERFLOW,   10, "not enough space for data export")              \
 	X(SHARED_MEMORY,           11, "failed to open shared memory region")           \
 	X(SYNC_VARIABLE,           12, "failed to acquire lock within timeout period")  \
-	X(INVALID_TIMEOUT,         13, "invalid timeout value")
+	X(INVALID_TIMEOUT,         13, "invalid timeout value")                         \
+	X(INVALID_OUTPUT_FORMAT,   14, "invalid output format")                         \
+	X(INVALID_BIT_DEPTH,       15, "invalid bit depth: must be 8 or 16")            \
+	X(INVALID_DAS_BATCH,       16, "invalid DAS batch: must be 1 to " str(BEAMFORMER_MAX_DAS_BATCH))
 
 #define X(type, num, string) BF_LIB_ERR_KIND_ ##type = num,
 typedef enum {BEAMFORMER_LIB_ERRORS} BeamformerLibErrorKind;
@@ -48,8 +51,20 @@ LIB_FN uint32_t beamformer_set_global_timeout(int32_t timeout_ms);
 LIB_FN uint32_t beamform_data_synchronized(void *data, uint32_t data_size, int32_t output_points[3],
                                            float *out_data, int32_t timeout_ms);
 
-/* NOTE: downloads the last 32 frames worth of compute timings into output */
+/* NOTE: downloads the log compressed image produced by the LogCompress stage for the most
+ * recent frame. out_data must hold 1 (8 bit) or 2 (16 bit) bytes per output point */
+LIB_FN uint32_t beamformer_export_log_compressed(void *out_data, uint32_t size, int32_t timeout_ms);
+
+/* NOTE: downloads the decoded RF data written by the last stage before DAS for the most
+ * recent frame. samples are complex, 2 floats each (2 halves with HalfPrecisionRF), laid
+ * out as [channel][transmit][sample] */
+LIB_FN uint32_t beamformer_export_rf_data(void *out_data, uint32_t size, int32_t timeout_ms);
+
+/* NOTE: downloads the last 32 frames worth of compute timings into output along with the
+ * effective per shader throughput of the current pipeline */
 LIB_FN uint32_t beamformer_compute_timings(BeamformerComputeStatsTable *output, int32_t timeout_ms);
+/* NOTE: clears the latency histograms; takes effect before the next timings are coalesced */
+LIB_FN uint32_t beamformer_reset_compute_timings(void);
 
 /* NOTE: tells the beamformer to start beamforming */
 LIB_FN uint32_t beamformer_start_compute(void);
@@ -64,8 +79,24 @@ LIB_FN uint32_t beamformer_push_channel_mapping(int16_t *mapping,  uint32_t coun
 LIB_FN uint32_t beamformer_push_sparse_elements(int16_t *elements, uint32_t count);
 LIB_FN uint32_t beamformer_push_focal_vectors(float     *vectors,  uint32_t count);
 
+/* NOTE: the meaning of parameter depends on the stage:
+ *   Filter/Demodulate: filter slot
+ *   DAS:               BeamformerDASFlags
+ *   Sum:               BeamformerSumMode */
 LIB_FN uint32_t beamformer_set_pipeline_stage_parameters(int32_t stage_index, int32_t parameter);
 LIB_FN uint32_t beamformer_push_pipeline(int32_t *shaders, int32_t shader_count, BeamformerDataKind data_kind);
+/* NOTE: flags is a combination of BeamformerPipelineFlags */
+LIB_FN uint32_t beamformer_set_pipeline_flags(uint32_t flags);
+/* NOTE: format is a BeamformerOutputFormat; exported data is stored in this format */
+LIB_FN uint32_t beamformer_set_output_format(uint32_t format);
+/* NOTE: parameters for the LogCompress stage; see render_3d.frag.glsl for the mapping.
+ * dynamic_range and threshold are in dB and bit_depth must be 8 or 16 */
+LIB_FN uint32_t beamformer_set_log_compression(float dynamic_range, float threshold, float gamma,
+                                               uint32_t bit_depth);
+/* NOTE: beamform up to count consecutive frames with a single DAS dispatch series. only
+ * applies to 2D (XZ) outputs without frame averaging. frames are batched while more data
+ * is already queued; a partial batch is flushed as soon as the queue runs dry */
+LIB_FN uint32_t beamformer_set_das_batch(uint32_t count);
 LIB_FN uint32_t beamformer_push_parameters(BeamformerParameters *);
 LIB_FN uint32_t beamformer_push_parameters_ui(BeamformerUIParameters *);
 LIB_FN uint32_t beamformer_push_parameters_head(BeamformerParametersHead *);
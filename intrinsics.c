@@ -45,6 +45,7 @@
   #define sin_f32(a)      sinf(a)
   #define tan_f32(a)      tanf(a)
   #define ceil_f32(a)     ceilf(a)
+  #define floor_f32(a)    floorf(a)
   #define sqrt_f32(a)     sqrtf(a)
 
   #define exp_f64(a)      exp(a)
@@ -82,6 +83,7 @@
   #define sin_f32(a)      __builtin_sinf(a)
   #define tan_f32(a)      __builtin_tanf(a)
   #define ceil_f32(a)     __builtin_ceilf(a)
+  #define floor_f32(a)    __builtin_floorf(a)
   #define sqrt_f32(a)     __builtin_sqrtf(a)
 
   #define exp_f64(a)      __builtin_exp(a)
@@ -9,12 +9,17 @@
 
 #include "os_linux.c"
 
+#include <signal.h>
+
 #define OS_DEBUG_LIB_NAME      "./beamformer.so"
 #define OS_DEBUG_LIB_TEMP_NAME "./beamformer_temp.so"
 
 #define OS_CUDA_LIB_NAME       "./external/cuda_toolkit.so"
 #define OS_CUDA_LIB_TEMP_NAME  "./external/cuda_toolkit_temp.so"
 
+#define OS_CPU_STAGES_LIB_NAME      "./external/cpu_stages.so"
+#define OS_CPU_STAGES_LIB_TEMP_NAME "./external/cpu_stages_temp.so"
+
 #define OS_RENDERDOC_SONAME    "librenderdoc.so"
 
 /* TODO(rnp): what do if not X11? */
@@ -32,6 +37,133 @@ os_gl_proc_address(char *name)
 	return glfwGetProcAddress(name);
 }
 
+/* NOTE(rnp): headless contexts come from EGL so that no display server is required. libEGL
+ * is loaded at runtime so that it is only a dependency when running headless. the
+ * surfaceless platform is preferred (Mesa, including llvmpipe); otherwise the default
+ * display is used. contexts are made current without a surface when the implementation
+ * allows it and with a 1x1 pbuffer otherwise */
+#define EGL_NONE                             0x3038
+#define EGL_EXTENSIONS                       0x3055
+#define EGL_HEIGHT                           0x3056
+#define EGL_WIDTH                            0x3057
+#define EGL_SURFACE_TYPE                     0x3033
+#define EGL_RENDERABLE_TYPE                  0x3040
+#define EGL_PBUFFER_BIT                      0x0001
+#define EGL_OPENGL_BIT                       0x0008
+#define EGL_OPENGL_API                       0x30A2
+#define EGL_CONTEXT_MAJOR_VERSION            0x3098
+#define EGL_CONTEXT_MINOR_VERSION            0x30FB
+#define EGL_CONTEXT_OPENGL_PROFILE_MASK      0x30FD
+#define EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT  0x0001
+#define EGL_PLATFORM_SURFACELESS_MESA        0x31DD
+
+#define EGL_PROCEDURES \
+	X(eglBindAPI,            u32,    (u32 api)) \
+	X(eglChooseConfig,       u32,    (iptr display, i32 *attributes, iptr *configs, i32 size, i32 *count)) \
+	X(eglCreateContext,      iptr,   (iptr display, iptr config, iptr share, i32 *attributes)) \
+	X(eglCreatePbufferSurface, iptr, (iptr display, iptr config, i32 *attributes)) \
+	X(eglGetDisplay,         iptr,   (iptr native_display)) \
+	X(eglGetPlatformDisplay, iptr,   (u32 platform, void *native_display, iptr *attributes)) \
+	X(eglGetProcAddress,     iptr,   (char *name)) \
+	X(eglInitialize,         u32,    (iptr display, i32 *major, i32 *minor)) \
+	X(eglMakeCurrent,        u32,    (iptr display, iptr draw, iptr read, iptr context)) \
+	X(eglQueryString,        char *, (iptr display, i32 name))
+
+#define X(name, ret, params) typedef ret name##_fn params;
+EGL_PROCEDURES
+#undef X
+
+typedef struct {
+	#define X(name, ...) name##_fn *name;
+	EGL_PROCEDURES
+	#undef X
+	iptr display;
+	iptr config;
+	iptr surface;
+} LinuxEGL;
+
+global LinuxEGL linux_egl;
+
+function b32
+os_headless_gl_init(Stream *err)
+{
+	LinuxEGL *egl = &linux_egl;
+	void *lib = os_load_library("libEGL.so.1", 0, err);
+	#define X(name, ...) egl->name = os_lookup_dynamic_symbol(lib, #name, 0);
+	EGL_PROCEDURES
+	#undef X
+
+	b32 result = lib && egl->eglGetDisplay && egl->eglInitialize && egl->eglChooseConfig &&
+	             egl->eglCreateContext && egl->eglMakeCurrent && egl->eglBindAPI &&
+	             egl->eglGetProcAddress;
+	if (result) {
+		if (egl->eglGetPlatformDisplay)
+			egl->display = egl->eglGetPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, 0, 0);
+		if (!egl->display)
+			egl->display = egl->eglGetDisplay(0);
+
+		i32 config_attributes[] = {
+			EGL_SURFACE_TYPE,    EGL_PBUFFER_BIT,
+			EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+			EGL_NONE,
+		};
+		i32 config_count = 0;
+		result = egl->display && egl->eglInitialize(egl->display, 0, 0) &&
+		         egl->eglBindAPI(EGL_OPENGL_API) &&
+		         egl->eglChooseConfig(egl->display, config_attributes, &egl->config, 1, &config_count) &&
+		         config_count > 0;
+	}
+
+	if (result) {
+		s8 extensions = s8("");
+		if (egl->eglQueryString)
+			extensions = c_str_to_s8(egl->eglQueryString(egl->display, EGL_EXTENSIONS));
+		s8 surfaceless = s8("EGL_KHR_surfaceless_context");
+		b32 found = 0;
+		for (iz i = 0; !found && i + surfaceless.len <= extensions.len; i++) {
+			found = 1;
+			for (iz j = 0; found && j < surfaceless.len; j++)
+				found = extensions.data[i + j] == surfaceless.data[j];
+		}
+		if (!found) {
+			i32 surface_attributes[] = {EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE};
+			if (egl->eglCreatePbufferSurface)
+				egl->surface = egl->eglCreatePbufferSurface(egl->display, egl->config, surface_attributes);
+			result = egl->surface != 0;
+		}
+	}
+
+	if (!result) stream_append_s8(err, s8("failed to initialize EGL for headless operation\n"));
+	return result;
+}
+
+function iptr
+os_headless_gl_context_create(iptr share)
+{
+	LinuxEGL *egl = &linux_egl;
+	i32 attributes[] = {
+		EGL_CONTEXT_MAJOR_VERSION,       4,
+		EGL_CONTEXT_MINOR_VERSION,       5,
+		EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+		EGL_NONE,
+	};
+	iptr result = egl->eglCreateContext(egl->display, egl->config, share, attributes);
+	return result;
+}
+
+function void
+os_headless_gl_make_current(iptr context)
+{
+	LinuxEGL *egl = &linux_egl;
+	egl->eglMakeCurrent(egl->display, egl->surface, egl->surface, context);
+}
+
+function iptr
+os_headless_gl_proc_address(char *name)
+{
+	return linux_egl.eglGetProcAddress(name);
+}
+
 #include "static.c"
 
 function void
@@ -70,15 +202,32 @@ dispatch_file_watch_events(OS *os, Arena arena)
 	}
 }
 
+/* NOTE(rnp): bound on how long a headless step sleeps waiting for file watch events */
+#define HEADLESS_POLL_TIMEOUT_MS 1
+
+global b32 exit_requested;
+
+function void
+request_exit(i32 signal_number)
+{
+	atomic_store_u32(&exit_requested, 1);
+}
+
 extern i32
-main(void)
+main(i32 argc, char *argv[])
 {
 	Arena program_memory = os_alloc_arena(MB(16));
 
 	BeamformerCtx   *ctx   = 0;
 	BeamformerInput *input = 0;
 
-	setup_beamformer(&program_memory, &ctx, &input);
+	b32 headless = command_line_has_flag(argc, argv, s8("--headless"));
+	if (headless) {
+		signal(SIGINT,  request_exit);
+		signal(SIGTERM, request_exit);
+	}
+
+	setup_beamformer(&program_memory, &ctx, &input, headless);
 	os_wake_waiters(&ctx->os.compute_worker.sync_variable);
 
 	struct pollfd fds[1] = {{0}};
@@ -87,23 +236,24 @@ main(void)
 
 	u64 last_time = os_get_timer_counter();
 	while (!ctx->should_exit) {
-		poll(fds, countof(fds), 0);
+		poll(fds, countof(fds), headless ? HEADLESS_POLL_TIMEOUT_MS : 0);
 		if (fds[0].revents & POLLIN)
 			dispatch_file_watch_events(&ctx->os, program_memory);
 
 		u64 now = os_get_timer_counter();
 		input->last_mouse = input->mouse;
-		input->mouse.rl   = GetMousePosition();
+		if (!headless) input->mouse.rl = GetMousePosition();
 		input->dt         = (f32)((f64)(now - last_time) / (f64)os_get_timer_frequency());
 		last_time         = now;
 
 		beamformer_frame_step(ctx, input);
 
 		input->executable_reloaded = 0;
+		ctx->should_exit |= atomic_load_u32(&exit_requested);
 	}
 
 	beamformer_invalidate_shared_memory(ctx);
-	beamformer_debug_ui_deinit(ctx);
+	if (!headless) beamformer_debug_ui_deinit(ctx);
 
 	/* NOTE: make sure this will get cleaned up after external
 	 * programs release their references */
@@ -15,6 +15,9 @@
 #define OS_CUDA_LIB_NAME       "external\\cuda_toolkit.dll"
 #define OS_CUDA_LIB_TEMP_NAME  "external\\cuda_toolkit_temp.dll"
 
+#define OS_CPU_STAGES_LIB_NAME      "external\\cpu_stages.dll"
+#define OS_CPU_STAGES_LIB_TEMP_NAME "external\\cpu_stages_temp.dll"
+
 #define OS_RENDERDOC_SONAME    "renderdoc.dll"
 
 iptr glfwGetWGLContext(iptr);
@@ -30,6 +33,12 @@ os_gl_proc_address(char *name)
 	return wglGetProcAddress(name);
 }
 
+/* NOTE(rnp): win32 has no surfaceless contexts; headless mode falls back to a hidden window */
+function b32  os_headless_gl_init(Stream *err)               { return 0; }
+function iptr os_headless_gl_context_create(iptr share)      { return 0; }
+function void os_headless_gl_make_current(iptr context)      { }
+function iptr os_headless_gl_proc_address(char *name)        { return 0; }
+
 #include "static.c"
 
 function void
@@ -99,15 +108,33 @@ clear_io_queue(OS *os, BeamformerInput *input, Arena arena)
 	}
 }
 
+W32(b32)  SetConsoleCtrlHandler(iptr, b32);
+W32(void) Sleep(u32);
+
+/* NOTE(rnp): bound on how long a headless step sleeps */
+#define HEADLESS_SLEEP_MS 1
+
+global b32 exit_requested;
+
+function b32 __stdcall
+request_exit(u32 ctrl_type)
+{
+	atomic_store_u32(&exit_requested, 1);
+	return 1;
+}
+
 extern i32
-main(void)
+main(i32 argc, char *argv[])
 {
 	Arena program_memory = os_alloc_arena(MB(16));
 
 	BeamformerCtx   *ctx   = 0;
 	BeamformerInput *input = 0;
 
-	setup_beamformer(&program_memory, &ctx, &input);
+	b32 headless = command_line_has_flag(argc, argv, s8("--headless"));
+	if (headless) SetConsoleCtrlHandler((iptr)request_exit, 1);
+
+	setup_beamformer(&program_memory, &ctx, &input, headless);
 	os_wake_waiters(&ctx->os.compute_worker.sync_variable);
 
 	w32_context *w32_ctx = (w32_context *)ctx->os.context;
@@ -117,15 +144,17 @@ main(void)
 
 		u64 now = os_get_timer_counter();
 		input->last_mouse = input->mouse;
-		input->mouse.rl   = GetMousePosition();
+		if (!headless) input->mouse.rl = GetMousePosition();
 		input->dt         = (f32)((f64)(now - last_time) / (f64)w32_ctx->timer_frequency);
 		last_time         = now;
 
 		beamformer_frame_step(ctx, input);
 
 		input->executable_reloaded = 0;
+		ctx->should_exit |= atomic_load_u32(&exit_requested);
+		if (headless) Sleep(HEADLESS_SLEEP_MS);
 	}
 
 	beamformer_invalidate_shared_memory(ctx);
-	beamformer_debug_ui_deinit(ctx);
+	if (!headless) beamformer_debug_ui_deinit(ctx);
 }
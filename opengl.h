@@ -11,15 +11,22 @@
 #include <GL/gl.h>
 
 /* NOTE: do not add extra 0s to these, even at the start -> garbage compilers will complain */
+#define GL_MAP_READ_BIT                    0x0001
 #define GL_MAP_WRITE_BIT                   0x0002
 #define GL_MAP_FLUSH_EXPLICIT_BIT          0x0010
 #define GL_MAP_UNSYNCHRONIZED_BIT          0x0020
 #define GL_MAP_PERSISTENT_BIT              0x0040
+#define GL_MAP_COHERENT_BIT                0x0080
 #define GL_DYNAMIC_STORAGE_BIT             0x0100
+#define GL_CLIENT_STORAGE_BIT              0x0200
+#define GL_SYNC_FLUSH_COMMANDS_BIT         0x00000001
 #define GL_SHADER_IMAGE_ACCESS_BARRIER_BIT 0x00000020
 #define GL_TEXTURE_UPDATE_BARRIER_BIT      0x00000100
+#define GL_BUFFER_UPDATE_BARRIER_BIT       0x00000200
 #define GL_SHADER_STORAGE_BARRIER_BIT      0x00002000
+#define GL_CLIENT_MAPPED_BUFFER_BARRIER_BIT 0x00004000
 
+#define GL_HALF_FLOAT                      0x140B
 #define GL_UNSIGNED_INT_8_8_8_8            0x8035
 #define GL_TEXTURE_3D                      0x806F
 #define GL_MAX_3D_TEXTURE_SIZE             0x8073
@@ -30,15 +37,24 @@
 #define GL_MAJOR_VERSION                   0x821B
 #define GL_MINOR_VERSION                   0x821C
 #define GL_RG                              0x8227
+#define GL_R8                              0x8229
+#define GL_R16                             0x822A
+#define GL_R16F                            0x822D
 #define GL_R32F                            0x822E
+#define GL_RG16F                           0x822F
 #define GL_RG32F                           0x8230
 #define GL_R8I                             0x8231
 #define GL_R16I                            0x8233
+#define GL_R32UI                           0x8236
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
 #define GL_MAX_COMPUTE_SHARED_MEMORY_SIZE  0x8262
 #define GL_BUFFER                          0x82E0
 #define GL_PROGRAM                         0x82E2
 #define GL_MIRRORED_REPEAT                 0x8370
+#define GL_PROGRAM_BINARY_LENGTH           0x8741
+#define GL_NUM_PROGRAM_BINARY_FORMATS      0x87FE
 #define GL_QUERY_RESULT                    0x8866
+#define GL_QUERY_RESULT_AVAILABLE          0x8867
 #define GL_READ_ONLY                       0x88B8
 #define GL_WRITE_ONLY                      0x88B9
 #define GL_READ_WRITE                      0x88BA
@@ -46,6 +62,7 @@
 #define GL_STATIC_DRAW                     0x88E4
 #define GL_UNIFORM_BUFFER                  0x8A11
 #define GL_MAX_UNIFORM_BLOCK_SIZE          0x8A30
+#define GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT 0x8A34
 #define GL_FRAGMENT_SHADER                 0x8B30
 #define GL_VERTEX_SHADER                   0x8B31
 #define GL_COMPILE_STATUS                  0x8B81
@@ -94,6 +111,7 @@ typedef struct __GLsync *GLsync;
 	X(glClientWaitSync,                      GLenum, (GLsync sync, GLbitfield flags, GLuint64 timeout)) \
 	X(glCompileShader,                       void,   (GLuint shader)) \
 	X(glCopyImageSubData,                    void,   (GLuint srcName, GLenum srcTarget, GLint srcLevel, GLint srcX, GLint srcY, GLint srcZ, GLuint dstName, GLenum dstTarget, GLint dstLevel, GLint dstX, GLint dstY, GLint dstZ, GLsizei srcWidth, GLsizei srcHeight, GLsizei srcDepth)) \
+	X(glCopyNamedBufferSubData,              void,   (GLuint readBuffer, GLuint writeBuffer, GLintptr readOffset, GLintptr writeOffset, GLsizeiptr size)) \
 	X(glCreateBuffers,                       void,   (GLsizei n, GLuint *buffers)) \
 	X(glCreateFramebuffers,                  void,   (GLsizei n, GLuint *ids)) \
 	X(glCreateProgram,                       GLuint, (void)) \
@@ -113,6 +131,8 @@ typedef struct __GLsync *GLsync;
 	X(glFenceSync,                           GLsync, (GLenum condition, GLbitfield flags)) \
 	X(glFlushMappedNamedBufferRange,         void,   (GLuint buffer, GLintptr offset, GLsizei length)) \
 	X(glGenerateTextureMipmap,               void,   (GLuint texture)) \
+	X(glGetNamedBufferSubData,               void,   (GLuint buffer, GLintptr offset, GLsizeiptr size, void *data)) \
+	X(glGetProgramBinary,                    void,   (GLuint program, GLsizei bufSize, GLsizei *length, GLenum *binaryFormat, void *binary)) \
 	X(glGetProgramInfoLog,                   void,   (GLuint program, GLsizei maxLength, GLsizei *length, GLchar *infoLog)) \
 	X(glGetProgramiv,                        void,   (GLuint program, GLenum pname, GLint *params)) \
 	X(glGetQueryObjectui64v,                 void,   (GLuint id, GLenum pname, GLuint64 *params)) \
@@ -129,6 +149,8 @@ typedef struct __GLsync *GLsync;
 	X(glNamedFramebufferTexture,             void,   (GLuint fb, GLenum attachment, GLuint texture, GLint level)) \
 	X(glNamedRenderbufferStorageMultisample, void,   (GLuint rb, GLsizei samples, GLenum internalformat, GLsizei width, GLsizei height)) \
 	X(glObjectLabel,                         void,   (GLenum identifier, GLuint name, GLsizei length, const char *label)) \
+	X(glProgramBinary,                       void,   (GLuint program, GLenum binaryFormat, const void *binary, GLsizei length)) \
+	X(glProgramParameteri,                   void,   (GLuint program, GLenum pname, GLint value)) \
 	X(glProgramUniform1f,                    void,   (GLuint program, GLint location, GLfloat v0)) \
 	X(glProgramUniform1i,                    void,   (GLuint program, GLint location, GLint v0)) \
 	X(glProgramUniform1ui,                   void,   (GLuint program, GLint location, GLuint v0)) \
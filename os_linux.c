@@ -89,6 +89,13 @@ os_round_up_to_page_size(iz value)
 	return result;
 }
 
+function u32
+os_get_cpu_count(void)
+{
+	u32 result = (u32)MAX(1, sysconf(_SC_NPROCESSORS_ONLN));
+	return result;
+}
+
 function OS_ALLOC_ARENA_FN(os_alloc_arena)
 {
 	Arena result = {0};
@@ -137,6 +144,12 @@ os_file_exists(char *path)
 	return result;
 }
 
+function OS_MAKE_DIRECTORY_FN(os_make_directory)
+{
+	b32 result = mkdir(path, 0770) == 0 || os_file_exists(path);
+	return result;
+}
+
 function SharedMemoryRegion
 os_create_shared_memory_area(Arena *arena, char *name, i32 lock_count, iz requested_capacity)
 {
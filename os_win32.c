@@ -85,10 +85,25 @@ typedef struct {
 	iptr *semaphores;
 } w32_shared_memory_context;
 
+typedef struct {
+	u16  architecture;
+	u16  _pad1;
+	u32  page_size;
+	iz   minimum_application_address;
+	iz   maximum_application_address;
+	u64  active_processor_mask;
+	u32  number_of_processors;
+	u32  processor_type;
+	u32  allocation_granularity;
+	u16  processor_level;
+	u16  processor_revision;
+} w32_system_info;
+
 #define W32(r) __declspec(dllimport) r __stdcall
 W32(b32)    CloseHandle(iptr);
 W32(b32)    CopyFileA(c8 *, c8 *, b32);
 W32(iptr)   CreateFileA(c8 *, u32, u32, void *, u32, u32, void *);
+W32(b32)    CreateDirectoryA(c8 *, void *);
 W32(iptr)   CreateFileMappingA(iptr, void *, u32, u32, u32, c8 *);
 W32(iptr)   CreateIoCompletionPort(iptr, iptr, uptr, u32);
 W32(iptr)   CreateSemaphoreA(iptr, i32, i32, c8 *);
@@ -174,24 +189,21 @@ os_get_timer_counter(void)
 function iz
 os_round_up_to_page_size(iz value)
 {
-	struct {
-		u16  architecture;
-		u16  _pad1;
-		u32  page_size;
-		iz   minimum_application_address;
-		iz   maximum_application_address;
-		u64  active_processor_mask;
-		u32  number_of_processors;
-		u32  processor_type;
-		u32  allocation_granularity;
-		u16  processor_level;
-		u16  processor_revision;
-	} info;
+	w32_system_info info;
 	GetSystemInfo(&info);
 	iz result = round_up_to(value, info.page_size);
 	return result;
 }
 
+function u32
+os_get_cpu_count(void)
+{
+	w32_system_info info;
+	GetSystemInfo(&info);
+	u32 result = MAX(1, info.number_of_processors);
+	return result;
+}
+
 function OS_ALLOC_ARENA_FN(os_alloc_arena)
 {
 	Arena result = {0};
@@ -249,6 +261,12 @@ os_file_exists(char *path)
 	return result;
 }
 
+function OS_MAKE_DIRECTORY_FN(os_make_directory)
+{
+	b32 result = CreateDirectoryA(path, 0) || os_file_exists(path);
+	return result;
+}
+
 function SharedMemoryRegion
 os_create_shared_memory_area(Arena *arena, char *name, i32 lock_count, iz requested_capacity)
 {
@@ -1,29 +1,116 @@
 /* See LICENSE for license details. */
+#if RF_DATA_HALF
+layout(std430, binding = 1) readonly restrict buffer buffer_1 {
+	uint rf_data[];
+};
+#define RF_SAMPLE(i) unpackHalf2x16(rf_data[rf_batch_offset + (i)])
+#else
 layout(std430, binding = 1) readonly restrict buffer buffer_1 {
 	vec2 rf_data[];
 };
+#define RF_SAMPLE(i) rf_data[rf_batch_offset + (i)]
+#endif
+
+/* NOTE: when u_rf_batch_stride is non zero several 2D frames are stacked along y of the
+ * output and the frame in slice y reads slot y of the rf data (see main) */
+int rf_batch_offset = 0;
 
+/* NOTE: the fast path accumulates in place so it needs full precision complex storage.
+ * for any other output format the host binds an accumulator here and the frame below */
 #if DAS_FAST
-layout(rg32f, binding = 0)           restrict uniform image3D  u_out_data_tex;
+layout(rg32f,         binding = 0)           restrict uniform image3D  u_out_data_tex;
 #else
-layout(rg32f, binding = 0) writeonly restrict uniform image3D  u_out_data_tex;
+layout(OUTPUT_FORMAT, binding = 0) writeonly restrict uniform image3D  u_out_data_tex;
+#endif
+
+#define DAS_FAST_RESOLVE (DAS_FAST && !OUTPUT_COMPLEX32)
+#if DAS_FAST_RESOLVE
+layout(OUTPUT_FORMAT, binding = 3) writeonly restrict uniform image3D  u_out_resolved_tex;
 #endif
 
 layout(r16i,  binding = 1) readonly  restrict uniform iimage1D sparse_elements;
 layout(rg32f, binding = 2) readonly  restrict uniform image1D  focal_vectors;
 
+#if DAS_DELAY_TABLES || DAS_BUILD_DELAY_TABLES
+#if DAS_BUILD_DELAY_TABLES
+  #define DELAY_TABLE_ACCESS writeonly
+#else
+  #define DELAY_TABLE_ACCESS readonly
+#endif
+/* NOTE: transmit_delays:      [transmit][voxel]    transmit portion of the sample index
+ *       receive_delays:       [channel][voxel]     receive portion of the sample index
+ *                                                  (including the time offset)
+ *       receive_apodization:  [channel / 2][voxel] receive apodization of a channel pair
+ *
+ * delays are 16.16 fixed point sample indices; the integer sample and the interpolation
+ * fraction are split off exactly and resolution doesn't drop with depth as it would with
+ * fp16. apodization only weights the sum so it is stored as fp16 (packHalf2x16) */
+layout(std430, binding = 3) DELAY_TABLE_ACCESS restrict buffer buffer_3 {
+	int transmit_delays[];
+};
+
+layout(std430, binding = 4) DELAY_TABLE_ACCESS restrict buffer buffer_4 {
+	int receive_delays[];
+};
+
+layout(std430, binding = 5) DELAY_TABLE_ACCESS restrict buffer buffer_5 {
+	uint receive_apodization[];
+};
+
+/* NOTE: clamped so that the sum of a transmit and a receive delay can't overflow */
+int encode_delay(float index)
+{
+	const float limit = float(DAS_DELAY_TABLES_MAX_SAMPLES);
+	return int(round(clamp(index, -limit, limit - 1) * 65536.0));
+}
+
+/* NOTE: delay tables are shared by every frame in a batch */
+int voxel_count()
+{
+	ivec3 dim = imageSize(u_out_data_tex);
+	if (u_rf_batch_stride > 0) dim.y = 1;
+	return dim.x * dim.y * dim.z;
+}
+
+int voxel_index(ivec3 voxel)
+{
+	ivec3 dim = imageSize(u_out_data_tex);
+	if (u_rf_batch_stride > 0) {
+		dim.y   = 1;
+		voxel.y = 0;
+	}
+	return voxel.x + dim.x * (voxel.y + dim.y * voxel.z);
+}
+#endif
+
 #define C_SPLINE 0.5
 
 #define TX_ROWS 0
 #define TX_COLS 1
 
+/* NOTE: specialized programs define this (and redefine das_shader_id, interpolate, and
+ * coherency_weighting) as constants */
+#if !defined(DAS_IQ_DATA)
+  #define DAS_IQ_DATA (center_frequency > 0)
+#endif
+
+vec4 output_value(vec2 iq)
+{
+#if OUTPUT_MAGNITUDE
+	vec4 result = vec4(length(iq), 0, 0, 0);
+#else
+	vec4 result = vec4(iq, 0, 0);
+#endif
+	return result;
+}
+
 #define TX_MODE_TX_COLS(a) (((a) & 2) != 0)
 #define TX_MODE_RX_COLS(a) (((a) & 1) != 0)
 
 vec2 rotate_iq(vec2 iq, float time)
 {
 	vec2 result = iq;
-	if (center_frequency > 0) {
+	if (DAS_IQ_DATA) {
 		float arg    = radians(360) * center_frequency * time;
 		mat2  phasor = mat2( cos(arg), sin(arg),
 		                    -sin(arg), cos(arg));
@@ -33,7 +120,7 @@ vec2 rotate_iq(vec2 iq, float time)
 }
 
 /* NOTE: See: https://cubic.org/docs/hermite.htm */
-vec2 cubic(int base_index, float index)
+vec2 cubic(vec2 samples[4], float t)
 {
 	mat4 h = mat4(
 		 2, -3,  0, 1,
@@ -42,14 +129,6 @@ vec2 cubic(int base_index, float index)
 		 1, -1,  0, 0
 	);
 
-	float tk, t = modf(index, tk);
-	vec2 samples[4] = {
-		rf_data[base_index + int(tk) - 1],
-		rf_data[base_index + int(tk) + 0],
-		rf_data[base_index + int(tk) + 1],
-		rf_data[base_index + int(tk) + 2],
-	};
-
 	vec4 S  = vec4(t * t * t, t * t, t, 1);
 	vec2 P1 = samples[1];
 	vec2 P2 = samples[2];
@@ -61,22 +140,152 @@ vec2 cubic(int base_index, float index)
 	return result;
 }
 
+vec2 cubic(int base_index, float index)
+{
+	float tk, t = modf(index, tk);
+	vec2 samples[4] = {
+		RF_SAMPLE(base_index + int(tk) - 1),
+		RF_SAMPLE(base_index + int(tk) + 0),
+		RF_SAMPLE(base_index + int(tk) + 1),
+		RF_SAMPLE(base_index + int(tk) + 2),
+	};
+	return cubic(samples, t);
+}
+
 vec2 sample_rf(int channel, int transmit, float index)
 {
 	vec2 result     = vec2(index >= 0.0f) * vec2(int(index) + 2 * int(interpolate) < dec_data_dim.x);
 	int  base_index = channel * dec_data_dim.x * dec_data_dim.z + transmit * dec_data_dim.x;
 	if (interpolate) result *= cubic(base_index, index);
-	else             result *= rf_data[base_index + int(round(index))];
+	else             result *= RF_SAMPLE(base_index + int(round(index)));
 	result = rotate_iq(result, index / sampling_frequency);
 	return result;
 }
 
+#if DAS_TILED_RF
+/* NOTE: the invocations of a workgroup all beamform the same channel/transmit pair at
+ * the same time and their sample windows mostly overlap. the union of the windows is
+ * loaded into shared memory once and every invocation interpolates from there. if the
+ * union doesn't fit the samples are read from the SSBO as usual */
+#define DAS_TILE_SAMPLES     2048
+#define DAS_TILE_INVOCATIONS int(gl_WorkGroupSize.x * gl_WorkGroupSize.y * gl_WorkGroupSize.z)
+
+shared vec2 tile_samples[DAS_TILE_SAMPLES];
+shared int  tile_min_index;
+shared int  tile_max_index;
+
+int tile_first_index;
+
+/* IMPORTANT: must be called from workgroup uniform control flow */
+bool load_rf_tile(int channel, int transmit, float index, bool active)
+{
+	if (gl_LocalInvocationIndex == 0) {
+		tile_min_index = dec_data_dim.x;
+		tile_max_index = -1;
+	}
+	barrier();
+
+	if (active && index >= 0.0f && int(index) + 2 * int(interpolate) < dec_data_dim.x) {
+		atomicMin(tile_min_index, int(index) - 1);
+		atomicMax(tile_max_index, int(index) + 2);
+	}
+	barrier();
+
+	tile_first_index = max(tile_min_index, 0);
+	int  count  = min(tile_max_index, dec_data_dim.x - 1) - tile_first_index + 1;
+	bool result = count <= DAS_TILE_SAMPLES;
+	if (result) {
+		int base_index = channel * dec_data_dim.x * dec_data_dim.z + transmit * dec_data_dim.x + tile_first_index;
+		for (int i = int(gl_LocalInvocationIndex); i < count; i += DAS_TILE_INVOCATIONS)
+			tile_samples[i] = RF_SAMPLE(base_index + i);
+	}
+	barrier();
+
+	return result;
+}
+
+vec2 tile_sample(int index)
+{
+	return tile_samples[clamp(index - tile_first_index, 0, DAS_TILE_SAMPLES - 1)];
+}
+
+vec2 sample_rf_tile(float index)
+{
+	vec2 result = vec2(index >= 0.0f) * vec2(int(index) + 2 * int(interpolate) < dec_data_dim.x);
+	if (interpolate) {
+		float tk, t = modf(index, tk);
+		vec2 samples[4] = {
+			tile_sample(int(tk) - 1),
+			tile_sample(int(tk) + 0),
+			tile_sample(int(tk) + 1),
+			tile_sample(int(tk) + 2),
+		};
+		result *= cubic(samples, t);
+	} else {
+		result *= tile_sample(int(round(index)));
+	}
+	result = rotate_iq(result, index / sampling_frequency);
+	return result;
+}
+#endif
+
+/* NOTE: when DAS_TILED_RF is enabled this must be called by every invocation of the
+ * workgroup; inactive invocations still help with loading the tile */
+vec2 sample_rf_cooperative(int channel, int transmit, float index, bool active)
+{
+	vec2 result = vec2(0);
+#if DAS_TILED_RF
+	if (load_rf_tile(channel, transmit, index, active)) {
+		if (active) result = sample_rf_tile(index);
+	} else if (active) {
+		result = sample_rf(channel, transmit, index);
+	}
+#else
+	if (active) result = sample_rf(channel, transmit, index);
+#endif
+	return result;
+}
+
 float sample_index(float distance)
 {
 	float  time = distance / speed_of_sound + time_offset;
 	return time * sampling_frequency;
 }
 
+float sample_index_delta(float distance)
+{
+	return distance / speed_of_sound * sampling_frequency;
+}
+
+#if DAS_FAST && DAS_DELAY_TABLES
+float receive_apodization_at(int channel, int voxel, int voxels)
+{
+	return unpackHalf2x16(receive_apodization[(channel / 2) * voxels + voxel])[channel & 1];
+}
+
+/* NOTE: same as sample_rf() for a 16.16 fixed point index (see the delay tables above) */
+vec2 sample_rf_fixed(int channel, int transmit, int index)
+{
+	int   whole      = index >> 16;
+	float t          = float(index & 0xFFFF) / 65536.0;
+	vec2  result     = vec2(whole >= 0) * vec2(whole + 2 * int(interpolate) < dec_data_dim.x);
+	int   base_index = channel * dec_data_dim.x * dec_data_dim.z + transmit * dec_data_dim.x + whole;
+	if (interpolate) {
+		vec2 samples[4] = {
+			RF_SAMPLE(base_index - 1),
+			RF_SAMPLE(base_index + 0),
+			RF_SAMPLE(base_index + 1),
+			RF_SAMPLE(base_index + 2),
+		};
+		result *= cubic(samples, t);
+	} else {
+		result *= RF_SAMPLE(base_index + int(t >= 0.5));
+	}
+	result = rotate_iq(result, (float(whole) + t) / sampling_frequency);
+	return result;
+}
+#endif
+
 float apodize(float arg)
 {
 	/* NOTE: used for constant F# dynamic receive apodization. This is implemented as:
@@ -107,7 +316,24 @@ float cylindrical_wave_transmit_distance(vec3 point, float focal_depth, float tr
 	return distance(rca_plane_projection(point, tx_rows), f);
 }
 
-#if DAS_FAST
+#if DAS_FAST && DAS_DELAY_TABLES
+vec3 RCA(vec3 world_point)
+{
+	int voxel          = voxel_index(ivec3(gl_GlobalInvocationID));
+	int voxels         = voxel_count();
+	int transmit_delay = transmit_delays[u_channel * voxels + voxel];
+
+	vec2 result = vec2(0);
+	for (int channel = 0; channel < dec_data_dim.y; channel++) {
+		float apodization = receive_apodization_at(channel, voxel, voxels);
+		if (apodization > 0) {
+			int delay = receive_delays[channel * voxels + voxel] + transmit_delay;
+			result   += apodization * sample_rf_fixed(channel, u_channel, delay);
+		}
+	}
+	return vec3(result, 0);
+}
+#elif DAS_FAST
 vec3 RCA(vec3 world_point)
 {
 	bool  tx_rows         = !TX_MODE_TX_COLS(transmit_mode);
@@ -131,10 +357,8 @@ vec3 RCA(vec3 world_point)
 		float receive_distance = length(receive_vector);
 		float apodization      = apodize(f_number * radians(180) / abs(xdc_world_point.y) * receive_vector.x);
 
-		if (apodization > 0) {
-			float sidx  = sample_index(transmit_distance + receive_distance);
-			result     += apodization * sample_rf(channel, u_channel, sidx);
-		}
+		float sidx  = sample_index(transmit_distance + receive_distance);
+		result     += apodization * sample_rf_cooperative(channel, u_channel, sidx, apodization > 0);
 	}
 	return vec3(result, 0);
 }
@@ -256,7 +480,25 @@ vec3 HERCULES(vec3 world_point)
 }
 #endif
 
-#if DAS_FAST
+#if DAS_FAST && DAS_DELAY_TABLES
+vec3 FORCES(vec3 world_point)
+{
+	bool  uforces     = das_shader_id == DAS_ID_UFORCES;
+	int   voxel       = voxel_index(ivec3(gl_GlobalInvocationID));
+	int   voxels      = voxel_count();
+	float apodization = receive_apodization_at(u_channel, voxel, voxels);
+
+	vec2 result = vec2(0);
+	if (apodization > 0) {
+		int receive_delay = receive_delays[u_channel * voxels + voxel];
+		for (int transmit = int(uforces); transmit < dec_data_dim.z; transmit++) {
+			int delay  = receive_delay + transmit_delays[transmit * voxels + voxel];
+			result    += apodization * sample_rf_fixed(u_channel, transmit, delay);
+		}
+	}
+	return vec3(result, 0);
+}
+#elif DAS_FAST
 vec3 FORCES(vec3 world_point)
 {
 	bool  uforces          = das_shader_id == DAS_ID_UFORCES;
@@ -266,13 +508,14 @@ vec3 FORCES(vec3 world_point)
 	                                 (xdc_world_point.x - u_channel * xdc_element_pitch.x));
 
 	vec2 result = vec2(0);
-	if (apodization > 0) {
+	/* NOTE: with DAS_TILED_RF the whole workgroup must run the loop */
+	if (bool(DAS_TILED_RF) || apodization > 0) {
 		for (int transmit = int(uforces); transmit < dec_data_dim.z; transmit++) {
 			int   tx_channel      = uforces ? imageLoad(sparse_elements, transmit - int(uforces)).x : transmit;
 			vec3  transmit_center = vec3(xdc_element_pitch * vec2(tx_channel, floor(dec_data_dim.y / 2)), 0);
 
 			float sidx  = sample_index(distance(xdc_world_point, transmit_center) + receive_distance);
-			result     += apodization * sample_rf(u_channel, transmit, sidx);
+			result     += apodization * sample_rf_cooperative(u_channel, transmit, sidx, apodization > 0);
 		}
 	}
 	return vec3(result, 0);
@@ -294,7 +537,7 @@ vec3 FORCES(vec3 world_point)
 				vec3  transmit_center = vec3(xdc_element_pitch * vec2(tx_channel, floor(dec_data_dim.y / 2)), 0);
 
 				float sidx   = sample_index(distance(xdc_world_point, transmit_center) + receive_distance);
-				vec2  value  = apodization * sample_rf(rx_channel, tx_channel, sidx);
+				vec2  value  = apodization * sample_rf(rx_channel, transmit, sidx);
 				result      += vec3(value, length(value));
 			}
 		}
@@ -303,9 +546,98 @@ vec3 FORCES(vec3 world_point)
 }
 #endif
 
+#if DAS_BUILD_DELAY_TABLES
+/* NOTE: a channel pair's apodization is written once its second channel (or the last
+ * channel) is reached so that a single invocation writes each packed value */
+void store_receive(int channel, int voxel, int voxels, float delay, float apodization, inout vec2 pair)
+{
+	receive_delays[channel * voxels + voxel] = encode_delay(delay + time_offset * sampling_frequency);
+	pair[channel & 1] = apodization;
+	if ((channel & 1) == 1 || channel == dec_data_dim.y - 1) {
+		receive_apodization[(channel / 2) * voxels + voxel] = packHalf2x16(pair);
+		pair = vec2(0);
+	}
+}
+
+void build_forces_delay_tables(vec3 world_point, int voxel, int voxels)
+{
+	bool uforces         = das_shader_id == DAS_ID_UFORCES;
+	vec3 xdc_world_point = (xdc_transform * vec4(world_point, 1)).xyz;
+
+	for (int transmit = int(uforces); transmit < dec_data_dim.z; transmit++) {
+		int  tx_channel      = uforces ? imageLoad(sparse_elements, transmit - int(uforces)).x : transmit;
+		vec3 transmit_center = vec3(xdc_element_pitch * vec2(tx_channel, floor(dec_data_dim.y / 2)), 0);
+		float transmit_delay = sample_index_delta(distance(xdc_world_point, transmit_center));
+		transmit_delays[transmit * voxels + voxel] = encode_delay(transmit_delay);
+	}
+
+	vec2 apodization_pair = vec2(0);
+	for (int channel = 0; channel < dec_data_dim.y; channel++) {
+		float receive_distance = distance(xdc_world_point.xz, vec2(channel * xdc_element_pitch.x, 0));
+		float apodization      = apodize(f_number * radians(180) / abs(xdc_world_point.z) *
+		                                 (xdc_world_point.x - channel * xdc_element_pitch.x));
+		store_receive(channel, voxel, voxels, sample_index_delta(receive_distance), apodization, apodization_pair);
+	}
+}
+
+void build_rca_delay_tables(vec3 world_point, int voxel, int voxels)
+{
+	bool tx_rows         = !TX_MODE_TX_COLS(transmit_mode);
+	bool rx_rows         = !TX_MODE_RX_COLS(transmit_mode);
+	vec2 xdc_world_point = rca_plane_projection((xdc_transform * vec4(world_point, 1)).xyz, rx_rows);
+
+	for (int transmit = 0; transmit < dec_data_dim.z; transmit++) {
+		vec2  focal_vector   = imageLoad(focal_vectors, transmit).xy;
+		float transmit_angle = radians(focal_vector.x);
+		float focal_depth    = focal_vector.y;
+
+		float transmit_distance;
+		if (isinf(focal_depth)) {
+			transmit_distance = plane_wave_transmit_distance(world_point, transmit_angle, tx_rows);
+		} else {
+			transmit_distance = cylindrical_wave_transmit_distance(world_point, focal_depth,
+			                                                       transmit_angle, tx_rows);
+		}
+		transmit_delays[transmit * voxels + voxel] = encode_delay(sample_index_delta(transmit_distance));
+	}
+
+	vec2 apodization_pair = vec2(0);
+	for (int channel = 0; channel < dec_data_dim.y; channel++) {
+		vec2  receive_vector = xdc_world_point - rca_plane_projection(vec3(channel * xdc_element_pitch, 0), rx_rows);
+		float apodization    = apodize(f_number * radians(180) / abs(xdc_world_point.y) * receive_vector.x);
+		store_receive(channel, voxel, voxels, sample_index_delta(length(receive_vector)), apodization, apodization_pair);
+	}
+}
+
 void main()
 {
 	ivec3 out_voxel = ivec3(gl_GlobalInvocationID);
+	if (any(greaterThanEqual(out_voxel, imageSize(u_out_data_tex))))
+		return;
+
+	vec3 world_point = (u_voxel_transform * vec4(out_voxel, 1)).xyz;
+	switch (das_shader_id) {
+	case DAS_ID_FORCES:
+	case DAS_ID_UFORCES:
+	{
+		build_forces_delay_tables(world_point, voxel_index(out_voxel), voxel_count());
+	}break;
+	case DAS_ID_FLASH:
+	case DAS_ID_RCA_TPW:
+	case DAS_ID_RCA_VLS:
+	{
+		build_rca_delay_tables(world_point, voxel_index(out_voxel), voxel_count());
+	}break;
+	}
+}
+#else
+void main()
+{
+	ivec3 out_voxel = ivec3(gl_GlobalInvocationID);
+#if DAS_DELAY_TABLES
+	if (any(greaterThanEqual(out_voxel, imageSize(u_out_data_tex))))
+		return;
+#endif
 #if DAS_FAST
 	vec3 sum = vec3(imageLoad(u_out_data_tex, out_voxel).xy, 0);
 #else
@@ -313,7 +645,13 @@ void main()
 	out_voxel += u_voxel_offset;
 #endif
 
-	vec3 world_point = (u_voxel_transform * vec4(out_voxel, 1)).xyz;
+	ivec3 frame_voxel = out_voxel;
+	if (u_rf_batch_stride > 0) {
+		rf_batch_offset = out_voxel.y * u_rf_batch_stride;
+		frame_voxel.y   = 0;
+	}
+
+	vec3 world_point = (u_voxel_transform * vec4(frame_voxel, 1)).xyz;
 
 	switch (das_shader_id) {
 	case DAS_ID_FORCES:
@@ -337,5 +675,16 @@ void main()
 	/* TODO(rnp): scale such that brightness remains ~constant */
 	if (coherency_weighting) sum.xy *= sum.xy / (sum.z + float(sum.z == 0));
 
+#if DAS_FAST_RESOLVE
+	if (u_channel == u_last_channel) {
+		imageStore(u_out_resolved_tex, out_voxel, output_value(sum.xy));
+		return;
+	}
+	imageStore(u_out_data_tex, out_voxel, vec4(sum.xy, 0, 0));
+#elif DAS_FAST
 	imageStore(u_out_data_tex, out_voxel, vec4(sum.xy, 0, 0));
+#else
+	imageStore(u_out_data_tex, out_voxel, output_value(sum.xy));
+#endif
 }
+#endif
@@ -6,6 +6,10 @@
  * (unless decode_mode == DECODE_MODE_NONE). The result of this dot product is stored in the
  * output. In bulk this has the effect of computing a matrix multiply of the
  * sample-transmit plane with the bound hadamard matrix.
+ *
+ * When DECODE_FWHT is set the second pass is instead dispatched with a single workgroup
+ * along z and each workgroup decodes all transmits of its samples with a fast
+ * Walsh-Hadamard transform in shared memory.
  */
 
 #if   defined(INPUT_DATA_TYPE_FLOAT)
@@ -14,6 +18,16 @@
 	#define RESULT_TYPE_CAST(x)  vec4((x), 0, 0, 0)
 	#define SAMPLE_DATA_TYPE     float
 	#define SAMPLE_TYPE_CAST(x)  (x)
+#elif defined(INPUT_DATA_TYPE_FLOAT_COMPLEX) && RF_DATA_HALF
+	/* NOTE(rnp): raw data is read as pairs of uints and reordered into packed halfs. this
+	 * is also the format of the intermediate data when decode is not the first stage */
+	#define INPUT_DATA_TYPE      uint
+	#define RF_SAMPLES_PER_INDEX 1
+	#define RESULT_TYPE_CAST(x)  vec4((x), 0, 0)
+	#define SAMPLE_DATA_TYPE     vec2
+	#define SAMPLE_TYPE_CAST(x)  unpackHalf2x16(x)
+	#define RAW_SAMPLE(i)        packHalf2x16(vec2(uintBitsToFloat(rf_data[2 * (i) + 0]), \
+	                                               uintBitsToFloat(rf_data[2 * (i) + 1])))
 #elif defined(INPUT_DATA_TYPE_FLOAT_COMPLEX)
 	#define INPUT_DATA_TYPE      vec2
 	#define RF_SAMPLES_PER_INDEX 1
@@ -39,6 +53,18 @@
 	#endif
 #endif
 
+#if !defined(RAW_SAMPLE)
+	#define RAW_SAMPLE(i) rf_data[i]
+#endif
+
+#if RF_DATA_HALF
+	#define OUTPUT_DATA_TYPE    uint
+	#define OUTPUT_TYPE_CAST(x) packHalf2x16(x)
+#else
+	#define OUTPUT_DATA_TYPE    vec2
+	#define OUTPUT_TYPE_CAST(x) (x)
+#endif
+
 layout(std430, binding = 1) readonly restrict buffer buffer_1 {
 	INPUT_DATA_TYPE rf_data[];
 };
@@ -48,7 +74,7 @@ layout(std430, binding = 2) writeonly restrict buffer buffer_2 {
 };
 
 layout(std430, binding = 3) writeonly restrict buffer buffer_3 {
-	vec2 out_data[];
+	OUTPUT_DATA_TYPE out_data[];
 };
 
 layout(r8i,  binding = 0) readonly restrict uniform iimage2D hadamard;
@@ -60,6 +86,79 @@ SAMPLE_DATA_TYPE sample_rf_data(uint index)
 	return result;
 }
 
+void store_result(uint channel, uint transmit, uint time_sample, vec4 result)
+{
+	uint out_off = output_channel_stride  * channel +
+	               output_transmit_stride * transmit +
+	               output_sample_stride   * time_sample;
+	out_data[out_off + 0] = OUTPUT_TYPE_CAST(result.xy);
+	#if RF_SAMPLES_PER_INDEX == 2 && !defined(OUTPUT_DATA_TYPE_FLOAT)
+	out_data[out_off + 1] = OUTPUT_TYPE_CAST(result.zw);
+	#endif
+}
+
+#if DECODE_FWHT
+shared SAMPLE_DATA_TYPE fwht_data[gl_WorkGroupSize.x][DECODE_FWHT_MAX_TRANSMITS];
+
+/* NOTE(rnp): the bound matrix is H = S ⊗ B where S is a natural order (Sylvester)
+ * hadamard matrix and B is either [1] or the 12x12/20x20 base matrix. y = H x is found
+ * by first multiplying each contiguous block of x by B and then running the O(N log N)
+ * butterflies of S across the blocks. each invocation handles every
+ * gl_WorkGroupSize.z'th transmit of one time sample */
+void decode_fwht(uint rf_offset, uint channel, uint time_sample)
+{
+	uint sample  = gl_LocalInvocationID.x;
+	uint thread  = gl_LocalInvocationID.z;
+	uint threads = gl_WorkGroupSize.z;
+	uint order   = transmit_count;
+	bool valid   = time_sample < output_transmit_stride;
+
+	uint base_order = 1;
+	if ((order & (order - 1)) != 0)
+		base_order = order % 20 == 0 ? 20 : 12;
+
+	for (uint t = thread; t < order; t += threads)
+		fwht_data[sample][t] = valid ? sample_rf_data(rf_offset + t) : SAMPLE_DATA_TYPE(0);
+	barrier();
+
+	if (base_order > 1) {
+		SAMPLE_DATA_TYPE block_values[DECODE_FWHT_MAX_TRANSMITS / gl_WorkGroupSize.z];
+		for (uint t = thread, i = 0; t < order; t += threads, i++) {
+			uint row   = t % base_order;
+			uint block = t - row;
+			SAMPLE_DATA_TYPE sum = SAMPLE_DATA_TYPE(0);
+			for (uint j = 0; j < base_order; j++)
+				sum += imageLoad(hadamard, ivec2(j, row)).x * fwht_data[sample][block + j];
+			block_values[i] = sum;
+		}
+		barrier();
+
+		for (uint t = thread, i = 0; t < order; t += threads, i++)
+			fwht_data[sample][t] = block_values[i];
+		barrier();
+	}
+
+	uint blocks = order / base_order;
+	for (uint h = 1; h < blocks; h *= 2) {
+		for (uint p = thread; p < order / 2; p += threads) {
+			uint pair = p / base_order;
+			uint i0   = ((pair / h) * 2 * h + pair % h) * base_order + p % base_order;
+			uint i1   = i0 + h * base_order;
+			SAMPLE_DATA_TYPE a = fwht_data[sample][i0];
+			SAMPLE_DATA_TYPE b = fwht_data[sample][i1];
+			fwht_data[sample][i0] = a + b;
+			fwht_data[sample][i1] = a - b;
+		}
+		barrier();
+	}
+
+	if (valid) {
+		for (uint t = thread; t < order; t += threads)
+			store_result(channel, t, time_sample, RESULT_TYPE_CAST(fwht_data[sample][t]) / float(order));
+	}
+}
+#endif
+
 void main()
 {
 	uint time_sample = gl_GlobalInvocationID.x * RF_SAMPLES_PER_INDEX;
@@ -72,7 +171,7 @@ void main()
 			uint in_off = input_channel_stride  * imageLoad(channel_mapping, int(channel)).x +
 			              input_transmit_stride * transmit +
 			              input_sample_stride   * time_sample;
-			out_rf_data[rf_offset + transmit] = rf_data[in_off / RF_SAMPLES_PER_INDEX];
+			out_rf_data[rf_offset + transmit] = RAW_SAMPLE(in_off / RF_SAMPLES_PER_INDEX);
 		}
 	} else {
 		#if defined(OUTPUT_DATA_TYPE_FLOAT)
@@ -80,11 +179,10 @@ void main()
 		 * output should end up densely packed */
 		time_sample = gl_GlobalInvocationID.x;
 		#endif
+		#if DECODE_FWHT
+		decode_fwht(rf_offset, channel, time_sample);
+		#else
 		if (time_sample < output_transmit_stride) {
-			uint out_off = output_channel_stride  * channel +
-			               output_transmit_stride * transmit +
-			               output_sample_stride   * time_sample;
-
 			vec4 result = vec4(0);
 			switch (decode_mode) {
 			case DECODE_MODE_NONE: {
@@ -97,10 +195,8 @@ void main()
 				result = RESULT_TYPE_CAST(sum) / float(imageSize(hadamard).x);
 			} break;
 			}
-			out_data[out_off + 0] = result.xy;
-			#if RF_SAMPLES_PER_INDEX == 2 && !defined(OUTPUT_DATA_TYPE_FLOAT)
-			out_data[out_off + 1] = result.zw;
-			#endif
+			store_result(channel, transmit, time_sample, result);
 		}
+		#endif
 	}
 }
@@ -0,0 +1,111 @@
+/* See LICENSE for license details. */
+layout(std430, binding = 1) readonly restrict buffer buffer_1 {
+	vec2 in_data[];
+};
+
+layout(std430, binding = 2) writeonly restrict buffer buffer_2 {
+	vec2 out_data[];
+};
+
+/* NOTE: exp(-2 pi i k / u_fft_size) for k in [0, u_fft_size) */
+layout(std430, binding = 3) readonly restrict buffer buffer_3 {
+	vec2 twiddles[];
+};
+
+vec2 complex_mul(vec2 a, vec2 b)
+{
+	vec2 result = vec2(a.x * b.x - a.y * b.y, a.x * b.y + a.y * b.x);
+	return result;
+}
+
+/* NOTE: multiply by exp(-i pi / 2) for the forward transform and by its conjugate for the
+ * inverse transform */
+vec2 rotate_quarter(vec2 a)
+{
+	vec2 result = u_direction * vec2(a.y, -a.x);
+	return result;
+}
+
+void dft2(inout vec2 a, inout vec2 b)
+{
+	vec2 t = a;
+	a = t + b;
+	b = t - b;
+}
+
+void dft4(inout vec2 a0, inout vec2 a1, inout vec2 a2, inout vec2 a3)
+{
+	dft2(a0, a2);
+	dft2(a1, a3);
+	a3 = rotate_quarter(a3);
+	dft2(a0, a1);
+	dft2(a2, a3);
+	/* NOTE: undo the bit reversed order of the outputs */
+	vec2 t = a1;
+	a1 = a2;
+	a2 = t;
+}
+
+/* NOTE: analytic signal spectrum; keep DC and nyquist, double positive frequencies and
+ * drop negative frequencies */
+float analytic_mask(uint frequency)
+{
+	float result = 2;
+	if (frequency == 0 || frequency == u_fft_size / 2) result = 1;
+	if (frequency >  u_fft_size / 2)                   result = 0;
+	return result;
+}
+
+/* NOTE: one radix FFT_RADIX Stockham pass. u_stride is the length of the sub transforms
+ * completed by earlier passes. the input and output are both in natural order so no bit
+ * reversal is ever needed */
+void main()
+{
+	uint butterfly_count = u_fft_size / FFT_RADIX;
+	uint j    = gl_GlobalInvocationID.x;
+	uint line = gl_WorkGroupID.z * gl_NumWorkGroups.y + gl_WorkGroupID.y;
+	if (j >= butterfly_count || line >= u_line_count)
+		return;
+
+	uint offset = line * u_fft_size;
+	uint k      = j % u_stride;
+
+	vec2 v[FFT_RADIX];
+	for (uint r = 0; r < FFT_RADIX; r++) {
+		uint index = j + r * butterfly_count;
+		v[r] = in_data[offset + index];
+		if ((u_flags & FFT_FLAG_RealInput)    != 0) v[r].y  = 0;
+		if ((u_flags & FFT_FLAG_AnalyticMask) != 0) v[r]   *= analytic_mask(index);
+		if ((u_flags & FFT_FLAG_Normalize)    != 0) v[r]   /= float(u_fft_size);
+	}
+
+	uint twiddle_step = (u_fft_size / (u_stride * FFT_RADIX)) * k;
+	for (uint r = 1; r < FFT_RADIX; r++) {
+		vec2 w = twiddles[r * twiddle_step];
+		v[r] = complex_mul(v[r], vec2(w.x, u_direction * w.y));
+	}
+
+#if FFT_RADIX == 2
+	dft2(v[0], v[1]);
+#elif FFT_RADIX == 4
+	dft4(v[0], v[1], v[2], v[3]);
+#elif FFT_RADIX == 8
+	dft4(v[0], v[2], v[4], v[6]);
+	dft4(v[1], v[3], v[5], v[7]);
+	float c = sqrt(0.5);
+	v[3] = complex_mul(v[3], vec2(c, -u_direction * c));
+	v[5] = rotate_quarter(v[5]);
+	v[7] = complex_mul(v[7], vec2(-c, -u_direction * c));
+	dft2(v[0], v[1]);
+	dft2(v[2], v[3]);
+	dft2(v[4], v[5]);
+	dft2(v[6], v[7]);
+	/* NOTE: outputs are X0 X4 X1 X5 X2 X6 X3 X7 */
+	vec2 t[8] = vec2[8](v[0], v[2], v[4], v[6], v[1], v[3], v[5], v[7]);
+	for (uint r = 0; r < 8; r++) v[r] = t[r];
+#endif
+
+	uint base = (j / u_stride) * u_stride * FFT_RADIX + k;
+	for (uint r = 0; r < FFT_RADIX; r++)
+		out_data[offset + base + r * u_stride] = v[r];
+}
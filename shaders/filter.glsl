@@ -1,5 +1,9 @@
 /* See LICENSE for license details. */
-#if   defined(INPUT_DATA_TYPE_FLOAT)
+#if   defined(INPUT_DATA_TYPE_FLOAT) && RF_DATA_HALF
+  #define DATA_TYPE           uint
+  #define RESULT_TYPE_CAST(v) packHalf2x16(v)
+  #define SAMPLE_TYPE_CAST(v) unpackHalf2x16(v)
+#elif defined(INPUT_DATA_TYPE_FLOAT)
   #define DATA_TYPE           vec2
   #define RESULT_TYPE_CAST(v) (v)
   #define SAMPLE_TYPE_CAST(v) (v)
@@ -37,7 +41,17 @@ vec2 rotate_iq(vec2 iq, int index)
 
 vec2 sample_rf(uint index)
 {
-	vec2 result = SAMPLE_TYPE_CAST(in_data[index]);
+	vec2 result;
+#if defined(INPUT_DATA_TYPE_FLOAT) && RF_DATA_HALF
+	/* NOTE(rnp): as the first stage the input is the raw f32 data */
+	if (map_channels) {
+		result = vec2(uintBitsToFloat(in_data[2 * index + 0]), uintBitsToFloat(in_data[2 * index + 1]));
+	} else {
+		result = SAMPLE_TYPE_CAST(in_data[index]);
+	}
+#else
+	result = SAMPLE_TYPE_CAST(in_data[index]);
+#endif
 	return result;
 }
 
@@ -62,6 +76,95 @@ vec2 demodulate(uint out_sample, uint in_offset, int index, int start, int targe
 	return result;
 }
 
+#if FILTER_FFT
+layout(rg32f, binding = 2) readonly restrict uniform image1D filter_spectrum;
+
+shared vec2 fft_data[FILTER_FFT_SIZE];
+
+vec2 complex_mul(vec2 a, vec2 b)
+{
+	vec2 result = vec2(a.x * b.x - a.y * b.y, a.x * b.y + a.y * b.x);
+	return result;
+}
+
+uint fft_bit_reverse(uint index)
+{
+	uint result = bitfieldReverse(index) >> (32 - findMSB(uint(FILTER_FFT_SIZE)));
+	return result;
+}
+
+/* NOTE(rnp): in place radix-2 decimation in time FFT. input must be in bit reversed order */
+void fft(void)
+{
+	for (uint half_size = 1; half_size < FILTER_FFT_SIZE; half_size *= 2) {
+		for (uint b = gl_LocalInvocationIndex; b < FILTER_FFT_SIZE / 2; b += gl_WorkGroupSize.x) {
+			uint  position = b % half_size;
+			uint  i0       = 2 * (b - position) + position;
+			uint  i1       = i0 + half_size;
+			float arg      = -radians(180) * float(position) / float(half_size);
+			vec2  t        = complex_mul(vec2(cos(arg), sin(arg)), fft_data[i1]);
+			vec2  a        = fft_data[i0];
+			fft_data[i0]   = a + t;
+			fft_data[i1]   = a - t;
+		}
+		barrier();
+	}
+}
+
+/* NOTE(rnp): overlap-save convolution. block samples [taps, FILTER_FFT_SIZE) of the
+ * circular convolution are free of wrap around and are exactly the direct form output.
+ * the spectrum is precomputed for the filter shifted by 1 sample (to match filter_base)
+ * and already includes the 1/N scale of the inverse transform */
+void main()
+{
+	uint channel  = gl_WorkGroupID.y;
+	uint transmit = gl_WorkGroupID.z;
+
+	int taps        = imageSize(filter_coefficients).x;
+	int target      = int(output_transmit_stride);
+	int block_start = int(gl_WorkGroupID.x) * (FILTER_FFT_SIZE - taps);
+
+	uint in_offset  = input_channel_stride  * channel + input_transmit_stride  * transmit;
+	uint out_offset = output_channel_stride * channel + output_transmit_stride * transmit;
+
+	for (uint i = gl_LocalInvocationIndex; i < FILTER_FFT_SIZE; i += gl_WorkGroupSize.x) {
+		int  index = block_start - taps + int(i);
+		vec2 value = vec2(0);
+		if (index >= 0 && index < target) value = sample_rf(in_offset + index);
+		fft_data[fft_bit_reverse(i)] = value;
+	}
+	barrier();
+
+	fft();
+
+	/* NOTE(rnp): ifft(X) = conj(fft(conj(X))) / N */
+	for (uint i = gl_LocalInvocationIndex; i < FILTER_FFT_SIZE; i += gl_WorkGroupSize.x) {
+		vec2 value  = complex_mul(fft_data[i], imageLoad(filter_spectrum, int(i)).xy);
+		fft_data[i] = value * vec2(1, -1);
+	}
+	barrier();
+
+	for (uint i = gl_LocalInvocationIndex; i < FILTER_FFT_SIZE; i += gl_WorkGroupSize.x) {
+		uint j = fft_bit_reverse(i);
+		if (i < j) {
+			vec2 swap   = fft_data[i];
+			fft_data[i] = fft_data[j];
+			fft_data[j] = swap;
+		}
+	}
+	barrier();
+
+	fft();
+
+	for (uint i = taps + gl_LocalInvocationIndex; i < FILTER_FFT_SIZE; i += gl_WorkGroupSize.x) {
+		int out_sample = block_start + int(i) - taps;
+		if (out_sample < target) {
+			vec2 result = fft_data[i] * vec2(1, -1);
+			out_data[out_offset + output_sample_stride * out_sample] = RESULT_TYPE_CAST(result);
+		}
+	}
+}
+#else
 void main()
 {
 	uint in_sample  = gl_GlobalInvocationID.x * decimation_rate;
@@ -90,3 +193,4 @@ void main()
 		out_data[out_offset] = RESULT_TYPE_CAST(result);
 	}
 }
+#endif
@@ -0,0 +1,93 @@
+/* See LICENSE for license details. */
+#if RF_DATA_HALF
+  #define DATA_TYPE           uint
+  #define RESULT_TYPE_CAST(v) packHalf2x16(v)
+  #define SAMPLE_TYPE_CAST(v) unpackHalf2x16(v)
+#else
+  #define DATA_TYPE           vec2
+  #define RESULT_TYPE_CAST(v) (v)
+  #define SAMPLE_TYPE_CAST(v) (v)
+#endif
+
+layout(std430, binding = 1) readonly restrict buffer buffer_1 {
+	DATA_TYPE in_data[];
+};
+
+layout(std430, binding = 2) writeonly restrict buffer buffer_2 {
+	DATA_TYPE out_data[];
+};
+
+shared vec2 fft_data[HILBERT_FFT_MAX_SIZE];
+
+vec2 complex_mul(vec2 a, vec2 b)
+{
+	vec2 result = vec2(a.x * b.x - a.y * b.y, a.x * b.y + a.y * b.x);
+	return result;
+}
+
+uint fft_bit_reverse(uint index)
+{
+	uint result = bitfieldReverse(index) >> (32 - findMSB(u_fft_size));
+	return result;
+}
+
+/* NOTE(rnp): in place radix-2 decimation in time FFT. input must be in bit reversed order */
+void fft(void)
+{
+	for (uint half_size = 1; half_size < u_fft_size; half_size *= 2) {
+		for (uint b = gl_LocalInvocationIndex; b < u_fft_size / 2; b += gl_WorkGroupSize.x) {
+			uint  position = b % half_size;
+			uint  i0       = 2 * (b - position) + position;
+			uint  i1       = i0 + half_size;
+			float arg      = -radians(180) * float(position) / float(half_size);
+			vec2  t        = complex_mul(vec2(cos(arg), sin(arg)), fft_data[i1]);
+			vec2  a        = fft_data[i0];
+			fft_data[i0]   = a + t;
+			fft_data[i1]   = a - t;
+		}
+		barrier();
+	}
+}
+
+/* NOTE(rnp): analytic signal of the real part of each line. the spectrum keeps DC and
+ * nyquist, doubles positive frequencies and drops negative frequencies. lines are zero
+ * padded to u_fft_size so samples near the end of a line differ slightly from an exact
+ * length transform (the CPU backend does the same) */
+void main()
+{
+	uint line   = gl_WorkGroupID.y * gl_NumWorkGroups.x + gl_WorkGroupID.x;
+	uint offset = line * u_sample_count;
+
+	for (uint i = gl_LocalInvocationIndex; i < u_fft_size; i += gl_WorkGroupSize.x) {
+		vec2 value = vec2(0);
+		if (i < u_sample_count) value.x = SAMPLE_TYPE_CAST(in_data[offset + i]).x;
+		fft_data[fft_bit_reverse(i)] = value;
+	}
+	barrier();
+
+	fft();
+
+	/* NOTE(rnp): ifft(X) = conj(fft(conj(X))) / N; the 1/N is applied on output */
+	for (uint i = gl_LocalInvocationIndex; i < u_fft_size; i += gl_WorkGroupSize.x) {
+		float scale = (i == 0 || i == u_fft_size / 2) ? 1 : (i < u_fft_size / 2 ? 2 : 0);
+		fft_data[i] = scale * fft_data[i] * vec2(1, -1);
+	}
+	barrier();
+
+	for (uint i = gl_LocalInvocationIndex; i < u_fft_size; i += gl_WorkGroupSize.x) {
+		uint j = fft_bit_reverse(i);
+		if (i < j) {
+			vec2 swap   = fft_data[i];
+			fft_data[i] = fft_data[j];
+			fft_data[j] = swap;
+		}
+	}
+	barrier();
+
+	fft();
+
+	for (uint i = gl_LocalInvocationIndex; i < u_sample_count; i += gl_WorkGroupSize.x) {
+		vec2 result = fft_data[i] * vec2(1, -1) / float(u_fft_size);
+		out_data[offset + i] = RESULT_TYPE_CAST(result);
+	}
+}
@@ -0,0 +1,21 @@
+/* See LICENSE for license details. */
+layout(OUTPUT_FORMAT, binding = 0) readonly  restrict uniform image3D u_in_img;
+/* NOTE: r8 or r16; write only images do not need to declare their format */
+layout(binding = 1)                writeonly restrict uniform image3D u_out_img;
+
+/* NOTE: same mapping as render_3d.frag.glsl with log scale enabled */
+void main()
+{
+	ivec3 voxel = ivec3(gl_GlobalInvocationID);
+	if (!all(lessThan(voxel, imageSize(u_out_img))))
+		return;
+
+	float threshold_value = pow(10.0f, threshold / 20.0f);
+	float smp = length(imageLoad(u_in_img, voxel).xy);
+	smp = clamp(smp, 0.0f, threshold_value) / threshold_value;
+	smp = pow(smp, gamma);
+	smp = 20 * log(smp) / log(10);
+	smp = 1 - clamp(smp, -dynamic_range, 0) / -dynamic_range;
+
+	imageStore(u_out_img, voxel, vec4(smp));
+}
@@ -1,24 +1,113 @@
 /* See LICENSE for license details. */
 
-/* NOTE: Does a binary search in 3D for smallest and largest output values */
-layout(local_size_x = 32, local_size_y = 1, local_size_z = 32) in;
+/* NOTE: Does a binary search in 3D for smallest and largest output values.
+ *
+ * Each workgroup reduces a tile of the input level through up to three mip levels using
+ * shared memory. If the host requests tail levels the last workgroup to finish (found
+ * with an atomic counter) then reduces the third of those levels through the remaining
+ * ones. Texels outside of a level read as zero, exactly as they do with imageLoad().
+ *
+ * IMPORTANT: the tiling below assumes a local size of 4x4x4 */
 
-layout(rg32f, binding = 0) readonly  uniform image3D u_out_data_tex;
-layout(rg32f, binding = 1) writeonly uniform image3D u_mip_view_tex;
+layout(OUTPUT_FORMAT, binding = 0) readonly  restrict uniform image3D u_in_level;
+layout(OUTPUT_FORMAT, binding = 1) writeonly restrict uniform image3D u_level_1;
+layout(OUTPUT_FORMAT, binding = 2) writeonly restrict uniform image3D u_level_2;
+layout(OUTPUT_FORMAT, binding = 3) coherent  restrict uniform image3D u_level_3;
+layout(OUTPUT_FORMAT, binding = 4) writeonly restrict uniform image3D u_level_4;
+layout(OUTPUT_FORMAT, binding = 5) writeonly restrict uniform image3D u_level_5;
+layout(OUTPUT_FORMAT, binding = 6) writeonly restrict uniform image3D u_level_6;
+
+/* NOTE: magnitude formats only have room for a single value per texel; their levels
+ * hold the maximum */
+#if OUTPUT_MAGNITUDE
+  #define MIN_MAX_LOAD(image, p) imageLoad(image, p).xx
+  #define MIN_MAX_TEXEL(value)   vec4((value).y, 0, 0, 1)
+#else
+  #define MIN_MAX_LOAD(image, p) imageLoad(image, p).xy
+  #define MIN_MAX_TEXEL(value)   vec4(value, 0, 1)
+#endif
+
+layout(std430, binding = 0) coherent restrict buffer min_max_counter {
+	uint finished_workgroups;
+};
+
+shared vec2 level_1_values[64];
+shared vec2 level_2_values[8];
+shared bool last_workgroup;
+
+#define MIN_MAX_INIT vec2(1000000000, 0)
+
+vec2 min_max_combine(vec2 a, vec2 b)
+{
+	return vec2(min(a.x, b.x), max(a.y, b.y));
+}
+
+ivec3 block_offset(int index)
+{
+	return ivec3(index & 1, (index >> 1) & 1, index >> 2);
+}
+
+#define REDUCE_BLOCK(image, base, result) \
+	for (int i = 0; i < 8; i++) \
+		result = min_max_combine(result, MIN_MAX_LOAD(image, (base) + block_offset(i)))
+
+/* NOTE: value holds this invocation's texel of level a. group is the workgroup's texel in
+ * level c. barrier() calls are kept outside of the branches so this must be reached by the
+ * whole workgroup with the same level count */
+#define REDUCE_LEVELS(a, b, c, group, value, levels) {                                        \
+	ivec3 local_id = ivec3(gl_LocalInvocationID);                                             \
+	ivec3 voxel_a  = (group) * 4 + local_id;                                                  \
+	bool  inside_a = all(lessThan(voxel_a, imageSize(a)));                                    \
+	if (inside_a) imageStore(a, voxel_a, MIN_MAX_TEXEL(value));                               \
+	level_1_values[gl_LocalInvocationIndex] = inside_a ? value : vec2(0);                     \
+	memoryBarrierShared();                                                                    \
+	barrier();                                                                                \
+	if ((levels) > 1 && all(lessThan(local_id, ivec3(2)))) {                                  \
+		vec2 value_b = MIN_MAX_INIT;                                                          \
+		for (int i = 0; i < 8; i++) {                                                         \
+			ivec3 p = 2 * local_id + block_offset(i);                                         \
+			value_b = min_max_combine(value_b, level_1_values[p.x + 4 * p.y + 16 * p.z]);     \
+		}                                                                                     \
+		ivec3 voxel_b  = (group) * 2 + local_id;                                              \
+		bool  inside_b = all(lessThan(voxel_b, imageSize(b)));                                \
+		if (inside_b) imageStore(b, voxel_b, MIN_MAX_TEXEL(value_b));                         \
+		level_2_values[local_id.x + 2 * local_id.y + 4 * local_id.z] = inside_b ? value_b : vec2(0); \
+	}                                                                                         \
+	memoryBarrierShared();                                                                    \
+	barrier();                                                                                \
+	if ((levels) > 2 && gl_LocalInvocationIndex == 0) {                                       \
+		vec2 value_c = MIN_MAX_INIT;                                                          \
+		for (int i = 0; i < 8; i++)                                                           \
+			value_c = min_max_combine(value_c, level_2_values[i]);                            \
+		if (all(lessThan((group), imageSize(c))))                                             \
+			imageStore(c, (group), MIN_MAX_TEXEL(value_c));                                   \
+	}                                                                                         \
+}
 
 void main()
 {
-	ivec3 out_coord = ivec3(gl_GlobalInvocationID.xyz);
-
-	ivec3 idx = out_coord * 2;
-	vec2 min_max = vec2(1000000000, 0);
-	for (int i = 0; i < 2; i++) {
-		for (int j = 0; j < 2; j++) {
-			vec2 a    = imageLoad(u_out_data_tex, idx + ivec3(i, j, 0)).xy;
-			vec2 b    = imageLoad(u_out_data_tex, idx + ivec3(i, j, 1)).xy;
-			min_max.x = min(min_max.x, min(a.x, b.x));
-			min_max.y = max(min_max.y, max(a.y, b.y));
+	ivec3 group = ivec3(gl_WorkGroupID);
+
+	vec2 value = MIN_MAX_INIT;
+	REDUCE_BLOCK(u_in_level, 2 * ivec3(gl_GlobalInvocationID), value);
+	REDUCE_LEVELS(u_level_1, u_level_2, u_level_3, group, value, u_pass_levels);
+
+	if (u_tail_levels > 0) {
+		memoryBarrierImage();
+		barrier();
+		if (gl_LocalInvocationIndex == 0) {
+			uint workgroups = gl_NumWorkGroups.x * gl_NumWorkGroups.y * gl_NumWorkGroups.z;
+			last_workgroup  = atomicAdd(finished_workgroups, 1) == workgroups - 1;
 		}
+		barrier();
+
+		/* NOTE: the whole workgroup leaves here so the barriers below remain uniform */
+		if (!last_workgroup) return;
+
+		if (gl_LocalInvocationIndex == 0) finished_workgroups = 0;
+
+		value = MIN_MAX_INIT;
+		REDUCE_BLOCK(u_level_3, 2 * ivec3(gl_LocalInvocationID), value);
+		REDUCE_LEVELS(u_level_4, u_level_5, u_level_6, ivec3(0), value, u_tail_levels);
 	}
-	imageStore(u_mip_view_tex, out_coord, vec4(min_max, 0, 1));
 }
@@ -23,18 +23,21 @@ float sdf_wire_box_outside(vec3 p, vec3 b, float e)
 void main()
 {
 	float smp = length(texture(u_texture, texture_coordinate).xy);
-	float threshold_val = pow(10.0f, u_threshold / 20.0f);
-	smp = clamp(smp, 0.0f, threshold_val);
-	smp = smp / threshold_val;
-	smp = pow(smp, u_gamma);
-
-	//float t = test_texture_coordinate.y;
-	//smp = smp * smoothstep(-0.4, 1.1, t) * u_gain;
-
-	if (u_log_scale) {
-		smp = 20 * log(smp) / log(10);
-		smp = clamp(smp, -u_db_cutoff, 0) / -u_db_cutoff;
-		smp = 1 - smp;
+	/* NOTE: compressed textures were already mapped by the LogCompress stage (log_compress.glsl) */
+	if (!u_compressed) {
+		float threshold_val = pow(10.0f, u_threshold / 20.0f);
+		smp = clamp(smp, 0.0f, threshold_val);
+		smp = smp / threshold_val;
+		smp = pow(smp, u_gamma);
+
+		//float t = test_texture_coordinate.y;
+		//smp = smp * smoothstep(-0.4, 1.1, t) * u_gain;
+
+		if (u_log_scale) {
+			smp = 20 * log(smp) / log(10);
+			smp = clamp(smp, -u_db_cutoff, 0) / -u_db_cutoff;
+			smp = 1 - smp;
+		}
 	}
 
 	vec3  p = 2.0f * test_texture_coordinate - 1.0f;
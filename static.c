@@ -111,6 +111,10 @@ get_gl_params(GLParams *gl, Stream *err)
 		os_fatal(stream_to_s8(err));
 	}
 
+	gl->driver_hash = s8_hash(c_str_to_s8(vendor));
+	gl->driver_hash = gl->driver_hash * 31 + s8_hash(c_str_to_s8((char *)glGetString(GL_RENDERER)));
+	gl->driver_hash = gl->driver_hash * 31 + s8_hash(c_str_to_s8((char *)glGetString(GL_VERSION)));
+
 	#define X(glname, name, suffix) glGetIntegerv(GL_##glname, &gl->name);
 	GL_PARAMETERS
 	#undef X
@@ -188,30 +192,50 @@ function FILE_WATCH_CALLBACK_FN(reload_shader_indirect)
 	return 1;
 }
 
-function FILE_WATCH_CALLBACK_FN(load_cuda_lib)
+function void
+external_stage_lib_fill_stubs(ExternalStageLib *lib)
+{
+	#define X(name, ...) if (!lib->name) lib->name = external_stage_ ## name ## _stub;
+	EXTERNAL_STAGE_LIB_FNS
+	#undef X
+}
+
+function b32
+load_external_stage_lib(OS *os, s8 path, char *temp_name, ExternalStageLib *lib, Arena arena)
 {
-	CudaLib *cl = (CudaLib *)user_data;
-	b32 result  = os_file_exists((c8 *)path.data);
+	b32 result = os_file_exists((c8 *)path.data);
 	if (result) {
 		Stream err = arena_stream(arena);
 
-		stream_append_s8(&err, s8("loading CUDA lib: " OS_CUDA_LIB_NAME "\n"));
-		os_unload_library(cl->lib);
-		cl->lib = os_load_library((c8 *)path.data, OS_CUDA_LIB_TEMP_NAME, &err);
-		#define X(name, symname) cl->name = os_lookup_dynamic_symbol(cl->lib, symname, &err);
-		CUDA_LIB_FNS
+		stream_append_s8s(&err, s8("loading external stage lib: "), path, s8("\n"));
+		os_unload_library(lib->lib);
+		lib->lib = os_load_library((c8 *)path.data, temp_name, &err);
+		b32 cuda = lib->backend == ExternalStageBackend_CUDA;
+		#define X(name, cuda_symbol, cpu_symbol) { \
+			char *symbol = cuda ? cuda_symbol : cpu_symbol; \
+			lib->name = symbol ? os_lookup_dynamic_symbol(lib->lib, symbol, &err) : 0; \
+		}
+		EXTERNAL_STAGE_LIB_FNS
 		#undef X
 
 		os_write_file(os->error_handle, stream_to_s8(&err));
 	}
 
-	#define X(name, symname) if (!cl->name) cl->name = cuda_ ## name ## _stub;
-	CUDA_LIB_FNS
-	#undef X
+	external_stage_lib_fill_stubs(lib);
 
 	return result;
 }
 
+function FILE_WATCH_CALLBACK_FN(load_cuda_lib)
+{
+	return load_external_stage_lib(os, path, OS_CUDA_LIB_TEMP_NAME, (ExternalStageLib *)user_data, arena);
+}
+
+function FILE_WATCH_CALLBACK_FN(load_cpu_stages_lib)
+{
+	return load_external_stage_lib(os, path, OS_CPU_STAGES_LIB_TEMP_NAME, (ExternalStageLib *)user_data, arena);
+}
+
 function BeamformerRenderModel
 render_model_from_arrays(f32 *vertices, f32 *normals, i32 vertices_size, u16 *indices, i32 index_count)
 {
@@ -252,6 +276,30 @@ void glfwWindowHint(i32, i32);
 iptr glfwCreateWindow(i32, i32, char *, iptr, iptr);
 void glfwMakeContextCurrent(iptr);
 
+/* NOTE(rnp): set when the GL contexts come from os_headless_gl_* instead of GLFW */
+global b32 headless_gl_contexts;
+
+function iptr
+gl_context_create(iptr share)
+{
+	iptr result;
+	if (headless_gl_contexts) result = os_headless_gl_context_create(share);
+	else                      result = glfwCreateWindow(1, 1, "", 0, share);
+	return result;
+}
+
+function void
+gl_context_make_current(GLWorkerThreadContext *ctx)
+{
+	if (headless_gl_contexts) {
+		os_headless_gl_make_current(ctx->window_handle);
+		ctx->gl_context = ctx->window_handle;
+	} else {
+		glfwMakeContextCurrent(ctx->window_handle);
+		ctx->gl_context = os_get_native_gl_context(ctx->window_handle);
+	}
+}
+
 function void
 worker_thread_sleep(GLWorkerThreadContext *ctx)
 {
@@ -270,8 +318,7 @@ function OS_THREAD_ENTRY_POINT_FN(compute_worker_thread_entry_point)
 {
 	GLWorkerThreadContext *ctx = (GLWorkerThreadContext *)_ctx;
 
-	glfwMakeContextCurrent(ctx->window_handle);
-	ctx->gl_context = os_get_native_gl_context(ctx->window_handle);
+	gl_context_make_current(ctx);
 
 	beamformer_compute_setup(ctx->user_context);
 
@@ -289,13 +336,13 @@ function OS_THREAD_ENTRY_POINT_FN(compute_worker_thread_entry_point)
 function OS_THREAD_ENTRY_POINT_FN(upload_worker_thread_entry_point)
 {
 	GLWorkerThreadContext *ctx = (GLWorkerThreadContext *)_ctx;
-	glfwMakeContextCurrent(ctx->window_handle);
-	ctx->gl_context = os_get_native_gl_context(ctx->window_handle);
+	gl_context_make_current(ctx);
 
 	BeamformerUploadThreadContext *up = (typeof(up))ctx->user_context;
-	glCreateQueries(GL_TIMESTAMP, 1, &up->rf_buffer->data_timestamp_query);
-	/* NOTE(rnp): start this here so we don't have to worry about it being started or not */
-	glQueryCounter(up->rf_buffer->data_timestamp_query, GL_TIMESTAMP);
+	BeamformerRFBuffer *rf = up->rf_buffer;
+	glCreateQueries(GL_TIMESTAMP, countof(rf->data_timestamp_queries), rf->data_timestamp_queries);
+	/* NOTE(rnp): start this here so that the first upload has a time to compare against */
+	glQueryCounter(rf->data_timestamp_queries[rf->data_timestamp_queries_issued++], GL_TIMESTAMP);
 
 	for (;;) {
 		worker_thread_sleep(ctx);
@@ -308,8 +355,23 @@ function OS_THREAD_ENTRY_POINT_FN(upload_worker_thread_entry_point)
 	return 0;
 }
 
+function b32
+command_line_has_flag(i32 argc, char *argv[], s8 flag)
+{
+	b32 result = 0;
+	for (i32 i = 1; !result && i < argc; i++) {
+		s8 arg = c_str_to_s8(argv[i]);
+		result = arg.len == flag.len;
+		for (iz j = 0; result && j < flag.len; j++)
+			result = arg.data[j] == flag.data[j];
+	}
+	return result;
+}
+
+/* NOTE(rnp): headless mode only runs the compute and upload workers against the shared
+ * memory interface. no UI is created and nothing is ever rendered */
 function void
-setup_beamformer(Arena *memory, BeamformerCtx **o_ctx, BeamformerInput **o_input)
+setup_beamformer(Arena *memory, BeamformerCtx **o_ctx, BeamformerInput **o_input, b32 headless)
 {
 	Arena  compute_arena = sub_arena(memory, MB(2),  KB(4));
 	Arena  upload_arena  = sub_arena(memory, KB(64), KB(4));
@@ -321,6 +383,7 @@ setup_beamformer(Arena *memory, BeamformerCtx **o_ctx, BeamformerInput **o_input
 
 	ctx->window_size = (iv2){{1280, 840}};
 	ctx->error_stream = error;
+	ctx->headless     = headless;
 	ctx->ui_backing_store = ui_arena;
 	input->executable_reloaded = 1;
 
@@ -332,18 +395,38 @@ setup_beamformer(Arena *memory, BeamformerCtx **o_ctx, BeamformerInput **o_input
 
 	debug_init(&ctx->os, (iptr)input, memory);
 
-	SetConfigFlags(FLAG_VSYNC_HINT|FLAG_WINDOW_ALWAYS_RUN);
-	InitWindow(ctx->window_size.w, ctx->window_size.h, "OGL Beamformer");
-	/* NOTE: do this after initing so that the window starts out floating in tiling wm */
-	SetWindowState(FLAG_WINDOW_RESIZABLE);
-	SetWindowMinSize(840, ctx->window_size.h);
+	iptr main_gl_context = 0;
+	if (headless && os_headless_gl_init(&ctx->error_stream)) {
+		headless_gl_contexts = 1;
+		main_gl_context      = os_headless_gl_context_create(0);
+		if (!main_gl_context) os_fatal(s8("failed to create headless GL context\n"));
+		os_headless_gl_make_current(main_gl_context);
 
-	glfwWindowHint(GLFW_VISIBLE, 0);
-	iptr raylib_window_handle = (iptr)GetPlatformWindowHandle();
+		#define X(name, ret, params) name = (name##_fn *)os_headless_gl_proc_address(#name);
+		OGLProcedureList
+		#undef X
+	} else {
+		if (headless) {
+			/* NOTE(rnp): no way to get a context without a window; keep it hidden */
+			os_write_file(ctx->os.error_handle, stream_to_s8(&ctx->error_stream));
+			stream_reset(&ctx->error_stream, 0);
+			SetConfigFlags(FLAG_WINDOW_HIDDEN|FLAG_WINDOW_ALWAYS_RUN);
+			InitWindow(1, 1, "OGL Beamformer");
+		} else {
+			SetConfigFlags(FLAG_VSYNC_HINT|FLAG_WINDOW_ALWAYS_RUN);
+			InitWindow(ctx->window_size.w, ctx->window_size.h, "OGL Beamformer");
+			/* NOTE: do this after initing so that the window starts out floating in tiling wm */
+			SetWindowState(FLAG_WINDOW_RESIZABLE);
+			SetWindowMinSize(840, ctx->window_size.h);
+		}
 
-	#define X(name, ret, params) name = (name##_fn *)os_gl_proc_address(#name);
-	OGLProcedureList
-	#undef X
+		glfwWindowHint(GLFW_VISIBLE, 0);
+		main_gl_context = (iptr)GetPlatformWindowHandle();
+
+		#define X(name, ret, params) name = (name##_fn *)os_gl_proc_address(#name);
+		OGLProcedureList
+		#undef X
+	}
 	/* NOTE: Gather information about the GPU */
 	get_gl_params(&ctx->gl, &ctx->error_stream);
 	dump_gl_params(&ctx->gl, *memory, &ctx->os);
@@ -367,12 +450,18 @@ setup_beamformer(Arena *memory, BeamformerCtx **o_ctx, BeamformerInput **o_input
 	sm->shaders[1]   = BeamformerShaderKind_DAS;
 	sm->shader_count = 2;
 
+	/* NOTE: matches the frame view defaults */
+	sm->log_compress_parameters.dynamic_range = 50.0f;
+	sm->log_compress_parameters.threshold     = 55.0f;
+	sm->log_compress_parameters.gamma         = 1.0f;
+	sm->log_compress_parameters.bit_depth     = 8;
+
 	ComputeShaderCtx *cs = &ctx->csctx;
 
 	GLWorkerThreadContext *worker = &ctx->os.compute_worker;
 	/* TODO(rnp): we should lock this down after we have something working */
 	worker->user_context  = (iptr)ctx;
-	worker->window_handle = glfwCreateWindow(1, 1, "", 0, raylib_window_handle);
+	worker->window_handle = gl_context_create(main_gl_context);
 	worker->handle        = os_create_thread(*memory, (iptr)worker, s8("[compute]"),
 	                                         compute_worker_thread_entry_point);
 
@@ -383,20 +472,27 @@ setup_beamformer(Arena *memory, BeamformerCtx **o_ctx, BeamformerInput **o_input
 	upctx->shared_memory = &ctx->shared_memory;
 	upctx->compute_timing_table = ctx->compute_timing_table;
 	upctx->compute_worker_sync  = &ctx->os.compute_worker.sync_variable;
-	upload->window_handle = glfwCreateWindow(1, 1, "", 0, raylib_window_handle);
+	upload->window_handle = gl_context_create(main_gl_context);
 	upload->handle        = os_create_thread(*memory, (iptr)upload, s8("[upload]"),
 	                                         upload_worker_thread_entry_point);
 
-	glfwMakeContextCurrent(raylib_window_handle);
+	if (headless_gl_contexts) os_headless_gl_make_current(main_gl_context);
+	else                      glfwMakeContextCurrent(main_gl_context);
 
+	/* NOTE(rnp): prefer CUDA when available; otherwise fall back to the CPU implementation */
+	ExternalStageLib *esl = &cs->external_stages;
+	esl->backend = ExternalStageBackend_CUDA;
 	if (ctx->gl.vendor_id == GL_VENDOR_NVIDIA
-	    && load_cuda_lib(&ctx->os, s8(OS_CUDA_LIB_NAME), (iptr)&cs->cuda_lib, *memory))
+	    && load_cuda_lib(&ctx->os, s8(OS_CUDA_LIB_NAME), (iptr)esl, *memory))
 	{
-		os_add_file_watch(&ctx->os, memory, s8(OS_CUDA_LIB_NAME), load_cuda_lib, (iptr)&cs->cuda_lib);
+		os_add_file_watch(&ctx->os, memory, s8(OS_CUDA_LIB_NAME), load_cuda_lib, (iptr)esl);
 	} else {
-		#define X(name, symname) if (!cs->cuda_lib.name) cs->cuda_lib.name = cuda_ ## name ## _stub;
-		CUDA_LIB_FNS
-		#undef X
+		esl->backend = ExternalStageBackend_CPU;
+		if (load_cpu_stages_lib(&ctx->os, s8(OS_CPU_STAGES_LIB_NAME), (iptr)esl, *memory)) {
+			os_add_file_watch(&ctx->os, memory, s8(OS_CPU_STAGES_LIB_NAME), load_cpu_stages_lib, (iptr)esl);
+		} else {
+			esl->backend = ExternalStageBackend_None;
+		}
 	}
 
 	/* NOTE: set up OpenGL debug logging */
@@ -428,6 +524,12 @@ setup_beamformer(Arena *memory, BeamformerCtx **o_ctx, BeamformerInput **o_input
 			"};\n\n"
 		),
 		#undef X
+		#define X(name, t, gltype, comment) "\t" #gltype " " #name "; " comment "\n"
+		[BeamformerShaderKind_LogCompress] = s8_comp("layout(std140, binding = 0) uniform parameters {\n"
+			BEAMFORMER_LOG_COMPRESS_PARAMETERS_LIST
+			"};\n\n"
+		),
+		#undef X
 	};
 
 	#define X(e, sn, f, pretty_name) do if (s8(f).len > 0) { \
@@ -440,6 +542,7 @@ setup_beamformer(Arena *memory, BeamformerCtx **o_ctx, BeamformerInput **o_input
 		src->gl_type = GL_COMPUTE_SHADER;                             \
 		src->kind    = BeamformerShaderKind_##e;                      \
 		src->link    = src;                                           \
+		cs->shader_reload_contexts[BeamformerShaderKind_##e] = src;   \
 		os_add_file_watch(&ctx->os, memory, src->path, reload_shader_indirect, (iptr)src); \
 		reload_shader_indirect(&ctx->os, src->path, (iptr)src, *memory); \
 	} while (0);
@@ -447,6 +550,8 @@ setup_beamformer(Arena *memory, BeamformerCtx **o_ctx, BeamformerInput **o_input
 	#undef X
 	os_wake_waiters(&worker->sync_variable);
 
+	if (headless) return;
+
 	FrameViewRenderContext *fvr = &ctx->frame_view_render_context;
 	glCreateFramebuffers(countof(fvr->framebuffers), fvr->framebuffers);
 	LABEL_GL_OBJECT(GL_FRAMEBUFFER, fvr->framebuffers[0], s8("Frame View Framebuffer"));
@@ -478,6 +583,7 @@ setup_beamformer(Arena *memory, BeamformerCtx **o_ctx, BeamformerInput **o_input
 	"layout(location = " str(FRAME_VIEW_BB_COLOUR_LOC)     ") uniform vec4  u_bb_colour   = vec4(" str(FRAME_VIEW_BB_COLOUR) ");\n"
 	"layout(location = " str(FRAME_VIEW_BB_FRACTION_LOC)   ") uniform float u_bb_fraction = " str(FRAME_VIEW_BB_FRACTION) ";\n"
 	"layout(location = " str(FRAME_VIEW_SOLID_BB_LOC)      ") uniform bool  u_solid_bb;\n"
+	"layout(location = " str(FRAME_VIEW_COMPRESSED_LOC)    ") uniform bool  u_compressed;\n"
 	"\n"
 	"layout(binding = 0) uniform sampler3D u_texture;\n");
 
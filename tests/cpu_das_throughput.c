@@ -0,0 +1,149 @@
+/* See LICENSE for license details. */
+#include "compiler.h"
+
+#include "util.h"
+#include "beamformer_parameters.h"
+
+#if OS_LINUX
+#include "os_linux.c"
+#elif OS_WINDOWS
+#include "os_win32.c"
+#else
+#error Unsupported Platform
+#endif
+
+#include "thread_pool.c"
+#include "cpu_das.c"
+
+#include "harness.c"
+
+#define RF_TIME_SAMPLES    2048
+#define CHANNEL_COUNT       128
+#define MAX_TRANSMIT_COUNT  128
+#define OUTPUT_POINTS_X     128
+#define OUTPUT_POINTS_Z     128
+#define SAMPLING_FREQUENCY 40e6f
+#define CENTER_FREQUENCY    5e6f
+#define SPEED_OF_SOUND     1540.0f
+#define ELEMENT_PITCH      0.1e-3f
+
+#define SAMPLE_RUNS           4
+
+/* X(das kind, transmit count, focal depth [m]) */
+#define STUDIES \
+	X(FORCES,    128,  F32_INFINITY) \
+	X(UFORCES,    32,  F32_INFINITY) \
+	X(HERCULES,  128,  F32_INFINITY) \
+	X(UHERCULES,  32,  F32_INFINITY) \
+	X(RCA_TPW,    32,  F32_INFINITY) \
+	X(RCA_VLS,    32, -0.02f)        \
+	X(FLASH,       1,  F32_INFINITY)
+
+typedef struct {
+	b32 interpolate;
+	u32 threads;
+} Options;
+
+function void
+setup_study(CPUDASParameters *dp, Options *options, DASShaderKind kind, u32 transmits, f32 focal_depth)
+{
+	BeamformerParameters *bp = &dp->parameters;
+	zero_struct(bp);
+	bp->das_shader_id       = kind;
+	bp->sampling_frequency  = SAMPLING_FREQUENCY;
+	bp->center_frequency    = CENTER_FREQUENCY;
+	bp->speed_of_sound      = SPEED_OF_SOUND;
+	bp->f_number            = 0.5f;
+	bp->interpolate         = options->interpolate;
+	bp->coherency_weighting = 0;
+	bp->dec_data_dim[0]     = RF_TIME_SAMPLES;
+	bp->dec_data_dim[1]     = CHANNEL_COUNT;
+	bp->dec_data_dim[2]     = transmits;
+	bp->dec_data_dim[3]     = 1;
+	bp->xdc_element_pitch[0] = ELEMENT_PITCH;
+	bp->xdc_element_pitch[1] = ELEMENT_PITCH;
+	for (u32 i = 0; i < 4; i++)
+		bp->xdc_transform[5 * i] = 1;
+
+	/* NOTE: XZ plane under the centre of the aperture from 5mm to 25mm */
+	f32 width = ELEMENT_PITCH * (CHANNEL_COUNT - 1);
+	zero_struct(&dp->voxel_transform);
+	dp->voxel_transform.c[0] = (v4){{width / (OUTPUT_POINTS_X - 1), 0, 0, 0}};
+	dp->voxel_transform.c[2] = (v4){{0, 0, 20e-3f / (OUTPUT_POINTS_Z - 1), 0}};
+	dp->voxel_transform.c[3] = (v4){{0, width / 2, 5e-3f, 1}};
+	dp->output_dim = (iv3){{OUTPUT_POINTS_X, 1, OUTPUT_POINTS_Z}};
+
+	for (u32 i = 0; i < transmits; i++) {
+		f32 angle = transmits > 1 ? -15.0f + 30.0f * (f32)i / (f32)(transmits - 1) : 0;
+		if (kind == DASShaderKind_RCA_VLS)
+			angle = 0.5f * angle;
+		dp->focal_vectors[i] = (v2){{angle, focal_depth}};
+	}
+
+	for (u32 i = 0; i < transmits - 1; i++)
+		dp->sparse_elements[i] = (i16)((i * CHANNEL_COUNT) / transmits);
+}
+
+function f64
+execute_study(HarnessOptions *options, ThreadPool *pool, CPUDASParameters *dp)
+{
+	for (u32 i = 0; !g_should_exit && i < options->warmup_count; i++)
+		cpu_das_beamform(pool, dp);
+
+	f64 start = os_get_time();
+	for (u32 i = 0; !g_should_exit && i < SAMPLE_RUNS; i++)
+		cpu_das_beamform(pool, dp);
+	f64 result = (os_get_time() - start) / SAMPLE_RUNS;
+	return result;
+}
+
+function void
+run_studies(HarnessOptions *harness, Options *options, ThreadPool *pool, CPUDASParameters *dp)
+{
+	#define X(kind, transmits, depth) \
+	if (!g_should_exit) { \
+		setup_study(dp, options, DASShaderKind_##kind, transmits, depth); \
+		f64 time = execute_study(harness, pool, dp); \
+		f64 work = (f64)OUTPUT_POINTS_X * OUTPUT_POINTS_Z * CHANNEL_COUNT * transmits; \
+		if (!g_should_exit) \
+			printf("%-9s | %3u transmits | %9.3f [ms] | %8.1f [Mvoxel·channel·transmit/s]\n", \
+			       #kind, transmits, time * 1e3, work / time / 1e6); \
+	}
+	STUDIES
+	#undef X
+}
+
+extern i32
+main(i32 argc, char *argv[])
+{
+	Options options = {0};
+	HarnessOption study_options[] = {
+		{"--interpolate", 0,   "use cubic interpolation of rf samples",       &options.interpolate},
+		{"--threads",     "n", "beamform with n threads (default: all cpus)", &options.threads},
+	};
+	HarnessOptions harness = harness_init(argc, argv, study_options, countof(study_options));
+
+	ThreadPool *pool = calloc(1, sizeof(*pool));
+	if (!pool) die("calloc\n");
+	thread_pool_start(pool, options.threads, KB(64), s8("cpu_das"));
+
+	uz rf_count = (uz)RF_TIME_SAMPLES * CHANNEL_COUNT * MAX_TRANSMIT_COUNT;
+	CPUDASParameters dp = {0};
+	dp.rf_data         = malloc(rf_count * sizeof(*dp.rf_data));
+	dp.output          = malloc(OUTPUT_POINTS_X * OUTPUT_POINTS_Z * sizeof(*dp.output));
+	dp.focal_vectors   = malloc(MAX_TRANSMIT_COUNT * sizeof(*dp.focal_vectors));
+	dp.sparse_elements = malloc(MAX_TRANSMIT_COUNT * sizeof(*dp.sparse_elements));
+	if (!dp.rf_data || !dp.output || !dp.focal_vectors || !dp.sparse_elements)
+		die("malloc\n");
+
+	for (uz i = 0; i < rf_count; i++) {
+		dp.rf_data[i].x = (f32)((i32)((i * 7919) & 0x7FF) - 0x400);
+		dp.rf_data[i].y = (f32)((i32)((i * 6007) & 0x7FF) - 0x400);
+	}
+
+	printf("cpu das: %u lanes, %u threads\n", CPU_DAS_LANES, pool->thread_count);
+
+	do { run_studies(&harness, &options, pool, &dp); } while (harness.loop && !g_should_exit);
+
+	return 0;
+}
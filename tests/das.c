@@ -0,0 +1,223 @@
+/* See LICENSE for license details. */
+
+/* NOTE(rnp): beamforms the same data on the GPU and with the CPU implementation in
+ * cpu_das.c and reports the error between them for each DAS kind. the GPU side is run
+ * with and without BeamformerDASFlags_TiledRF and the average time of the DAS stage is
+ * reported for both so that the tiled variant can be compared against the plain one */
+
+#define LIB_FN function
+#include "ogl_beamformer_lib.c"
+
+#include "thread_pool.c"
+#include "cpu_das.c"
+
+#include "harness.c"
+
+#include <math.h>
+
+#define RF_TIME_SAMPLES    2048
+#define CHANNEL_COUNT       128
+#define MAX_TRANSMIT_COUNT  128
+#define OUTPUT_POINTS_X     128
+#define OUTPUT_POINTS_Z     128
+#define SAMPLING_FREQUENCY 40e6f
+#define SPEED_OF_SOUND     1540.0f
+#define ELEMENT_PITCH      0.1e-3f
+
+/* NOTE(rnp): the GPU must match the CPU to within these errors. they leave room for
+ * differences in f32 trigonometry and delay table precision but not for a sample taken
+ * from the wrong line */
+#define MAX_ERROR_TOLERANCE 1e-2
+#define RMS_ERROR_TOLERANCE 2e-3
+
+/* X(das kind, transmit count, focal depth [m]) */
+#define STUDIES \
+	X(FORCES,    128,  F32_INFINITY) \
+	X(UFORCES,    32,  F32_INFINITY) \
+	X(HERCULES,  128,  F32_INFINITY) \
+	X(UHERCULES,  32,  F32_INFINITY) \
+	X(RCA_TPW,    32,  F32_INFINITY) \
+	X(RCA_VLS,    32, -0.02f)        \
+	X(FLASH,       1,  F32_INFINITY)
+
+typedef struct {
+	b32 nearest;
+	u32 threads;
+} Options;
+
+/* NOTE(rnp): two tones with a phase which changes across channels and transmits. it is
+ * smooth enough that small differences in delay only cause small differences in output */
+function void
+fill_rf_data(i16 *restrict data, v2 *restrict rf_data, u32 transmits)
+{
+	for (u32 channel = 0; channel < CHANNEL_COUNT; channel++) {
+		for (u32 transmit = 0; transmit < transmits; transmit++) {
+			uz  base  = ((uz)channel * transmits + transmit) * RF_TIME_SAMPLES;
+			f64 phase = 0.37 * channel + 1.3 * transmit;
+			for (u32 i = 0; i < RF_TIME_SAMPLES; i++) {
+				f64 t     = 2 * 3.14159265358979323846 * (f64)i / SAMPLING_FREQUENCY;
+				f64 value = 1000 * sin(3e6 * t + phase) + 500 * sin(5e6 * t - 2 * phase);
+				data[base + i]    = (i16)value;
+				rf_data[base + i] = (v2){{(f32)data[base + i], 0}};
+			}
+		}
+	}
+}
+
+function void
+setup_study(CPUDASParameters *dp, Options *options, DASShaderKind kind, u32 transmits, f32 focal_depth)
+{
+	BeamformerParameters *bp = &dp->parameters;
+	zero_struct(bp);
+	bp->das_shader_id        = kind;
+	bp->decode               = BeamformerDecodeMode_NONE;
+	bp->sampling_frequency   = SAMPLING_FREQUENCY;
+	bp->speed_of_sound       = SPEED_OF_SOUND;
+	bp->f_number             = 0.5f;
+	bp->interpolate          = !options->nearest;
+	bp->beamform_plane       = 1;
+	bp->dec_data_dim[0]      = RF_TIME_SAMPLES;
+	bp->dec_data_dim[1]      = CHANNEL_COUNT;
+	bp->dec_data_dim[2]      = transmits;
+	bp->dec_data_dim[3]      = 1;
+	bp->rf_raw_dim[0]        = RF_TIME_SAMPLES * transmits;
+	bp->rf_raw_dim[1]        = CHANNEL_COUNT;
+	bp->xdc_element_pitch[0] = ELEMENT_PITCH;
+	bp->xdc_element_pitch[1] = ELEMENT_PITCH;
+	for (u32 i = 0; i < 4; i++)
+		bp->xdc_transform[5 * i] = 1;
+
+	/* NOTE: XZ plane under the aperture from 5mm to 25mm */
+	f32 width = ELEMENT_PITCH * (CHANNEL_COUNT - 1);
+	bp->output_min_coordinate[2] = 5e-3f;
+	bp->output_max_coordinate[0] = width;
+	bp->output_max_coordinate[2] = 25e-3f;
+	bp->output_points[0] = OUTPUT_POINTS_X;
+	bp->output_points[1] = 1;
+	bp->output_points[2] = OUTPUT_POINTS_Z;
+	bp->output_points[3] = 1;
+
+	/* NOTE: same mapping as das_voxel_transform_matrix() for an XZ plane */
+	f32 scale_x = width / OUTPUT_POINTS_X;
+	f32 scale_z = 20e-3f / OUTPUT_POINTS_Z;
+	zero_struct(&dp->voxel_transform);
+	dp->voxel_transform.c[0] = (v4){{scale_x, 0, 0, 0}};
+	dp->voxel_transform.c[2] = (v4){{0, 0, scale_z, 0}};
+	dp->voxel_transform.c[3] = (v4){{width  / 2 - scale_x * (OUTPUT_POINTS_X - 1) / 2.0f, 0,
+	                                 15e-3f     - scale_z * (OUTPUT_POINTS_Z - 1) / 2.0f, 1}};
+	dp->output_dim = (iv3){{OUTPUT_POINTS_X, 1, OUTPUT_POINTS_Z}};
+
+	for (u32 i = 0; i < transmits; i++) {
+		f32 angle = transmits > 1 ? -15.0f + 30.0f * (f32)i / (f32)(transmits - 1) : 0;
+		if (kind == DASShaderKind_RCA_VLS)
+			angle = 0.5f * angle;
+		dp->focal_vectors[i] = (v2){{angle, focal_depth}};
+	}
+
+	dp->sparse_elements[0] = 0;
+	for (u32 i = 0; i < transmits - 1; i++)
+		dp->sparse_elements[i] = (i16)((i * CHANNEL_COUNT) / transmits);
+
+	beamformer_push_parameters(bp);
+	beamformer_push_focal_vectors((f32 *)dp->focal_vectors, transmits);
+	beamformer_push_sparse_elements(dp->sparse_elements, MAX(1, transmits - 1));
+
+	i32 shader_stages[] = {BeamformerShaderKind_Decode, BeamformerShaderKind_DAS};
+	beamformer_push_pipeline(shader_stages, countof(shader_stages), BeamformerDataKind_Int16);
+}
+
+/* NOTE(rnp): times the DAS stage with the current study and reads back the last frame.
+ * returns 0 if the GPU output did not match the CPU output */
+function b32
+execute_gpu_study(HarnessOptions *harness, CPUDASParameters *dp, u32 transmits, b32 tiled,
+                  i16 *data, f32 *gpu_output)
+{
+	/* NOTE: DAS is stage 1 of the pipeline pushed in setup_study */
+	beamformer_set_pipeline_stage_parameters(1, tiled ? BeamformerDASFlags_TiledRF : 0);
+	BeamformerShaderKind kind = tiled ? BeamformerShaderKind_DASFastTiled : BeamformerShaderKind_DASFast;
+
+	b32 result = 0;
+	i32 output_points[3] = {OUTPUT_POINTS_X, 1, OUTPUT_POINTS_Z};
+	uz  data_size = (uz)RF_TIME_SAMPLES * CHANNEL_COUNT * transmits * sizeof(*data);
+	f32 time      = harness_average_stage_time(harness, kind, data, data_size);
+	if (!g_should_exit && beamform_data_synchronized(data, (u32)data_size, output_points, gpu_output, 10000)) {
+		HarnessError error = harness_compare((f32 *)dp->output, gpu_output, 2 * OUTPUT_POINTS_X * OUTPUT_POINTS_Z);
+		result = error.max_error <= MAX_ERROR_TOLERANCE && error.rms_error <= RMS_ERROR_TOLERANCE;
+		printf("%s: %8.3f [ms] max %.2e rms %.2e%s", tiled ? "tiled" : "fast", time * 1e3,
+		       error.max_error, error.rms_error, result ? "" : " (FAILED)");
+	} else if (!g_should_exit) {
+		printf("lib error: %s", beamformer_get_last_error_string());
+	}
+	return result;
+}
+
+/* NOTE(rnp): returns 0 if either GPU output did not match the CPU output */
+function b32
+execute_study(HarnessOptions *harness, Options *options, ThreadPool *pool, CPUDASParameters *dp,
+              DASShaderKind kind, u32 transmits, f32 focal_depth, i16 *data, f32 *gpu_output)
+{
+	setup_study(dp, options, kind, transmits, focal_depth);
+	fill_rf_data(data, dp->rf_data, transmits);
+
+	cpu_das_beamform(pool, dp);
+
+	b32 result = execute_gpu_study(harness, dp, transmits, 0, data, gpu_output);
+	printf(" | ");
+	result &= execute_gpu_study(harness, dp, transmits, 1, data, gpu_output);
+	printf("\n");
+	return result;
+}
+
+/* NOTE(rnp): returns 0 if any study failed */
+function b32
+run_studies(HarnessOptions *harness, Options *options, ThreadPool *pool, CPUDASParameters *dp,
+            i16 *data, f32 *gpu_output)
+{
+	b32 result = 1;
+	#define X(kind, transmits, depth) \
+	if (!g_should_exit) { \
+		printf("%-9s | %3u transmits | ", #kind, transmits); \
+		result &= execute_study(harness, options, pool, dp, DASShaderKind_##kind, transmits, depth, data, gpu_output); \
+	}
+	STUDIES
+	#undef X
+	return result;
+}
+
+extern i32
+main(i32 argc, char *argv[])
+{
+	Options options = {0};
+	HarnessOption study_options[] = {
+		{"--nearest", 0,   "sample rf data with nearest neighbour instead of cubic interpolation", &options.nearest},
+		{"--threads", "n", "beamform on the CPU with n threads (default: all cpus)",               &options.threads},
+	};
+	HarnessOptions harness = harness_init(argc, argv, study_options, countof(study_options));
+
+	ThreadPool *pool = calloc(1, sizeof(*pool));
+	if (!pool) die("calloc\n");
+	thread_pool_start(pool, options.threads, KB(64), s8("cpu_das"));
+
+	uz rf_count = (uz)RF_TIME_SAMPLES * CHANNEL_COUNT * MAX_TRANSMIT_COUNT;
+	CPUDASParameters dp = {0};
+	dp.rf_data         = malloc(rf_count * sizeof(*dp.rf_data));
+	dp.output          = malloc(OUTPUT_POINTS_X * OUTPUT_POINTS_Z * sizeof(*dp.output));
+	dp.focal_vectors   = malloc(MAX_TRANSMIT_COUNT * sizeof(*dp.focal_vectors));
+	dp.sparse_elements = malloc(MAX_TRANSMIT_COUNT * sizeof(*dp.sparse_elements));
+	i16 *data          = malloc(rf_count * sizeof(*data));
+	f32 *gpu_output    = malloc(OUTPUT_POINTS_X * OUTPUT_POINTS_Z * 2 * sizeof(*gpu_output));
+	if (!dp.rf_data || !dp.output || !dp.focal_vectors || !dp.sparse_elements || !data || !gpu_output)
+		die("malloc\n");
+
+	i16 channel_mapping[CHANNEL_COUNT];
+	for (i16 i = 0; i < CHANNEL_COUNT; i++)
+		channel_mapping[i] = i;
+	beamformer_push_channel_mapping(channel_mapping, countof(channel_mapping));
+	beamformer_set_output_format(BeamformerOutputFormat_Complex32);
+	beamformer_set_pipeline_flags(0);
+
+	b32 passed = 1;
+	do { passed &= run_studies(&harness, &options, pool, &dp, data, gpu_output); } while (harness.loop && !g_should_exit);
+
+	return !passed;
+}
@@ -59,16 +59,8 @@ os_get_time(void)
 	return result;
 }
 
-function void
-os_make_directory(char *name)
-{
-	mkdir(name, 0770);
-}
-
 #elif OS_WINDOWS
 
-W32(b32) CreateDirectoryA(c8 *, void *);
-
 global w32_context os_context;
 
 function void
@@ -84,12 +76,6 @@ os_get_time(void)
 	return result;
 }
 
-function void
-os_make_directory(char *name)
-{
-	CreateDirectoryA(name, 0);
-}
-
 #else
 #error Unsupported Platform
 #endif
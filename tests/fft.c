@@ -0,0 +1,255 @@
+/* See LICENSE for license details. */
+#define LIB_FN function
+#include "ogl_beamformer_lib.c"
+
+#include "harness.c"
+
+#include <math.h>
+
+#define CHANNEL_COUNT  256
+#define TRANSMIT_COUNT 256
+
+read_only global u32 fft_sizes[] = {2048, 4096, 8192};
+
+/* NOTE(rnp): sizes for the numerical check. together they cover every combination of
+ * radix 2, 4, and 8 passes and there are more than the plan cache holds so revisiting
+ * them mixes cached plans with evicted and rebuilt ones */
+read_only global u32 check_sizes[] = {2, 4, 8, 16, 32, 1024, 2048, 4096, 8192, 32, 4096, 16, 8192, 8};
+
+#define CHECK_CHANNELS  2
+#define CHECK_TRANSMITS 2
+#define CHECK_LINES     (CHECK_CHANNELS * CHECK_TRANSMITS)
+
+/* NOTE(rnp): the analytic signal must match a naive DFT to within these errors */
+#define MAX_ERROR_TOLERANCE 1e-3
+#define RMS_ERROR_TOLERANCE 1e-4
+
+function uz
+data_size(u32 fft_size, u32 transmit_count)
+{
+	uz result = (uz)fft_size * transmit_count * CHANNEL_COUNT * sizeof(i16);
+	return result;
+}
+
+function void
+send_parameters(u32 fft_size, u32 channel_count, u32 transmit_count, b32 batched)
+{
+	BeamformerParameters bp = {0};
+	bp.decode          = BeamformerDecodeMode_NONE;
+	bp.dec_data_dim[0] = fft_size;
+	bp.dec_data_dim[1] = channel_count;
+	bp.dec_data_dim[2] = transmit_count;
+	bp.dec_data_dim[3] = 1;
+	bp.rf_raw_dim[0]   = fft_size * transmit_count;
+	bp.rf_raw_dim[1]   = channel_count;
+	beamformer_push_parameters(&bp);
+
+	beamformer_set_pipeline_flags(batched ? BeamformerPipelineFlags_BatchedFFTHilbert : 0);
+
+	i32 shader_stages[] = {BeamformerShaderKind_Decode, BeamformerShaderKind_CudaHilbert};
+	beamformer_push_pipeline(shader_stages, countof(shader_stages), BeamformerDataKind_Int16);
+}
+
+/* NOTE(rnp): returns the average GPU time of the Hilbert stage in seconds. the stage is a
+ * forward and an inverse FFT of every line */
+function f32
+execute_study(HarnessOptions *options, u32 fft_size, u32 transmit_count, b32 batched, i16 *restrict data)
+{
+	send_parameters(fft_size, CHANNEL_COUNT, transmit_count, batched);
+	BeamformerShaderKind kind = batched ? BeamformerShaderKind_HilbertBatchedFFT
+	                                    : BeamformerShaderKind_Hilbert;
+	f32 result = harness_average_stage_time(options, kind, data, data_size(fft_size, transmit_count));
+	return result;
+}
+
+/* NOTE(rnp): analytic signal of a real line computed with a naive DFT in double precision.
+ * it applies the same spectral mask as the GPU: DC and nyquist are kept, positive
+ * frequencies are doubled, and negative frequencies are dropped */
+function void
+reference_analytic_signal(f32 *restrict out, i16 *restrict line, u32 size, f64 *restrict scratch)
+{
+	f64 *table    = scratch;
+	f64 *spectrum = scratch + 2 * size;
+	for (u32 i = 0; i < size; i++) {
+		f64 arg = 2 * 3.14159265358979323846 * (f64)i / (f64)size;
+		table[2 * i + 0] = cos(arg);
+		table[2 * i + 1] = sin(arg);
+	}
+
+	for (u32 k = 0; k <= size / 2; k++) {
+		f64 re = 0, im = 0;
+		for (u32 n = 0; n < size; n++) {
+			u32 index = (u32)(((u64)k * n) % size);
+			re += line[n] * table[2 * index + 0];
+			im -= line[n] * table[2 * index + 1];
+		}
+		f64 mask = (k == 0 || k == size / 2) ? 1 : 2;
+		spectrum[2 * k + 0] = mask * re;
+		spectrum[2 * k + 1] = mask * im;
+	}
+
+	for (u32 n = 0; n < size; n++) {
+		f64 re = 0, im = 0;
+		for (u32 k = 0; k <= size / 2; k++) {
+			u32 index = (u32)(((u64)k * n) % size);
+			f64 c = table[2 * index + 0], s = table[2 * index + 1];
+			re += spectrum[2 * k + 0] * c - spectrum[2 * k + 1] * s;
+			im += spectrum[2 * k + 0] * s + spectrum[2 * k + 1] * c;
+		}
+		out[2 * n + 0] = (f32)(re / size);
+		out[2 * n + 1] = (f32)(im / size);
+	}
+}
+
+/* NOTE(rnp): one line each of an impulse, a sinusoid on a bin, a sinusoid between bins,
+ * and noise */
+function void
+fill_check_lines(i16 *restrict data, u32 size)
+{
+	mem_clear(data, 0, CHECK_LINES * size * sizeof(*data));
+	data[MIN(1, size - 1)] = 1000;
+
+	f64 on_bin  = (f64)MAX(1, size / 8);
+	f64 off_bin = 0.3183 * (f64)size;
+	for (u32 n = 0; n < size; n++) {
+		f64 t = 2 * 3.14159265358979323846 * (f64)n / (f64)size;
+		data[1 * size + n] = (i16)(1000 * cos(on_bin  * t));
+		data[2 * size + n] = (i16)(1000 * sin(off_bin * t));
+		data[3 * size + n] = (i16)((i32)((n * 7919) & 0x7FF) - 0x400);
+	}
+}
+
+/* NOTE(rnp): runs the check lines through the Hilbert stage and compares the result
+ * against the reference. returns the error of the worst line */
+function HarnessError
+check_study(u32 size, b32 batched, i16 *restrict data, f32 *restrict reference, f32 *restrict output)
+{
+	HarnessError result = {1, 1};
+	send_parameters(size, CHECK_CHANNELS, CHECK_TRANSMITS, batched);
+	u32 output_size = CHECK_LINES * size * 2 * sizeof(f32);
+	if (send_frame(data, CHECK_LINES * size * sizeof(*data)) &&
+	    beamformer_export_rf_data(output, output_size, 1000))
+	{
+		result = (HarnessError){0};
+		for (u32 line = 0; line < CHECK_LINES; line++) {
+			HarnessError error = harness_compare(reference + 2 * size * line,
+			                                     output    + 2 * size * line, 2 * size);
+			result.max_error = MAX(result.max_error, error.max_error);
+			result.rms_error = MAX(result.rms_error, error.rms_error);
+		}
+	}
+	return result;
+}
+
+function b32
+check_error(HarnessError error)
+{
+	b32 result = error.max_error <= MAX_ERROR_TOLERANCE && error.rms_error <= RMS_ERROR_TOLERANCE;
+	printf("max %.2e rms %.2e%s", error.max_error, error.rms_error, result ? "" : " (FAILED)");
+	return result;
+}
+
+/* NOTE(rnp): returns 0 if any FFT path did not match the reference */
+function b32
+run_checks(void)
+{
+	u32 max_size = 0;
+	for (iz i = 0; i < countof(check_sizes); i++)
+		max_size = MAX(max_size, check_sizes[i]);
+
+	i16 *data      = malloc(CHECK_LINES * max_size * sizeof(*data));
+	f32 *reference = malloc(CHECK_LINES * max_size * 2 * sizeof(*reference));
+	f32 *output    = malloc(CHECK_LINES * max_size * 2 * sizeof(*output));
+	f64 *scratch   = malloc(4 * max_size * sizeof(*scratch));
+	if (!data || !reference || !output || !scratch) die("malloc\n");
+
+	b32 result = 1;
+	for (iz i = 0; !g_should_exit && i < countof(check_sizes); i++) {
+		u32 size = check_sizes[i];
+		fill_check_lines(data, size);
+		for (u32 line = 0; line < CHECK_LINES; line++)
+			reference_analytic_signal(reference + 2 * size * line, data + size * line, size, scratch);
+
+		printf("check %5u | batched: ", size);
+		result &= check_error(check_study(size, 1, data, reference, output));
+		if (size <= HILBERT_FFT_MAX_SIZE) {
+			printf(" | single workgroup: ");
+			result &= check_error(check_study(size, 0, data, reference, output));
+		}
+		printf("\n");
+	}
+
+	free(data);
+	free(reference);
+	free(output);
+	free(scratch);
+
+	return result;
+}
+
+function f64
+gflops(u32 fft_size, u32 transmit_count, f32 time)
+{
+	/* NOTE(rnp): conventional 5 N log2(N) flop count per transform; two transforms per line */
+	f64 lines  = (f64)CHANNEL_COUNT * transmit_count;
+	f64 flops  = 2 * 5 * (f64)fft_size * (f64)ctz_u32(fft_size) * lines;
+	f64 result = time > 0 ? flops / time / 1e9 : 0;
+	return result;
+}
+
+function void
+run_studies(HarnessOptions *options, u32 transmit_count, i16 *data)
+{
+	for (iz i = 0; !g_should_exit && i < countof(fft_sizes); i++) {
+		u32 size    = fft_sizes[i];
+		f32 batched = execute_study(options, size, transmit_count, 1, data);
+		f32 single  = 0;
+		if (size <= HILBERT_FFT_MAX_SIZE)
+			single = execute_study(options, size, transmit_count, 0, data);
+		if (!g_should_exit) {
+			printf("fft %5u x %3u x %3u | batched: %8.3f [ms] (%7.1f GFLOP/s)",
+			       size, CHANNEL_COUNT, transmit_count,
+			       batched * 1e3, gflops(size, transmit_count, batched));
+			if (size <= HILBERT_FFT_MAX_SIZE) {
+				printf(" | single workgroup: %8.3f [ms] (%7.1f GFLOP/s)\n",
+				       single * 1e3, gflops(size, transmit_count, single));
+			} else {
+				printf(" | single workgroup: unsupported\n");
+			}
+		}
+	}
+}
+
+extern i32
+main(i32 argc, char *argv[])
+{
+	u32 transmit_count = TRANSMIT_COUNT;
+	HarnessOption study_options[] = {
+		{"--transmits", "n", "transform n transmits per channel (default: 256)", &transmit_count},
+	};
+	HarnessOptions options = harness_init(argc, argv, study_options, countof(study_options));
+	if (transmit_count == 0)
+		harness_usage(argv[0], study_options, countof(study_options));
+
+	i16 channel_mapping[CHANNEL_COUNT];
+	for (i16 i = 0; i < CHANNEL_COUNT; i++)
+		channel_mapping[i] = i;
+	beamformer_push_channel_mapping(channel_mapping, countof(channel_mapping));
+
+	b32 passed = run_checks();
+
+	uz max_size = data_size(fft_sizes[countof(fft_sizes) - 1], transmit_count);
+	if (max_size > BEAMFORMER_MAX_RF_DATA_SIZE)
+		die("%u transmits do not fit in the shared memory region\n", transmit_count);
+
+	i16 *data = malloc(max_size);
+	if (!data) die("malloc\n");
+	for (uz i = 0; i < max_size / sizeof(*data); i++)
+		data[i] = (i16)((i * 7919) & 0x7FF) - 0x400;
+
+	do { run_studies(&options, transmit_count, data); } while (options.loop && !g_should_exit);
+
+	beamformer_set_pipeline_flags(0);
+
+	return !passed;
+}
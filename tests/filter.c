@@ -0,0 +1,120 @@
+/* See LICENSE for license details. */
+#define LIB_FN function
+#include "ogl_beamformer_lib.c"
+
+#include "harness.c"
+
+#define RF_TIME_SAMPLES    4096
+#define CHANNEL_COUNT       128
+#define TRANSMIT_COUNT       32
+#define SAMPLING_FREQUENCY 50e6f
+#define CENTER_FREQUENCY    5e6f
+
+/* NOTE(rnp): FFT filtering must match direct form filtering to within these errors */
+#define MAX_ERROR_TOLERANCE 1e-3
+#define RMS_ERROR_TOLERANCE 1e-4
+
+read_only global i16 filter_lengths[] = {
+	16, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, FILTER_FFT_MAX_TAPS
+};
+
+function uz
+data_size(void)
+{
+	uz result = (uz)RF_TIME_SAMPLES * TRANSMIT_COUNT * CHANNEL_COUNT * sizeof(i16);
+	return result;
+}
+
+function uz
+output_size(void)
+{
+	uz result = (uz)RF_TIME_SAMPLES * TRANSMIT_COUNT * CHANNEL_COUNT * 2 * sizeof(f32);
+	return result;
+}
+
+function void
+send_parameters(i16 filter_length, b32 direct_form)
+{
+	BeamformerParameters bp = {0};
+	bp.decode             = BeamformerDecodeMode_NONE;
+	bp.sampling_frequency = SAMPLING_FREQUENCY;
+	bp.dec_data_dim[0]    = RF_TIME_SAMPLES;
+	bp.dec_data_dim[1]    = CHANNEL_COUNT;
+	bp.dec_data_dim[2]    = TRANSMIT_COUNT;
+	bp.dec_data_dim[3]    = 1;
+	bp.rf_raw_dim[0]      = RF_TIME_SAMPLES * TRANSMIT_COUNT;
+	bp.rf_raw_dim[1]      = CHANNEL_COUNT;
+	beamformer_push_parameters(&bp);
+
+	beamformer_create_matched_filter(CENTER_FREQUENCY, CENTER_FREQUENCY, SAMPLING_FREQUENCY,
+	                                 filter_length, 0);
+	beamformer_set_pipeline_flags(direct_form ? BeamformerPipelineFlags_DirectFormFilter : 0);
+
+	i32 shader_stages[] = {BeamformerShaderKind_Decode, BeamformerShaderKind_Filter};
+	beamformer_push_pipeline(shader_stages, countof(shader_stages), BeamformerDataKind_Int16);
+}
+
+/* NOTE(rnp): returns the average GPU time of the filter stage in seconds. the filtered
+ * RF data of the last frame is read back into output */
+function f32
+execute_study(HarnessOptions *options, i16 filter_length, b32 direct_form, i16 *restrict data,
+              f32 *restrict output)
+{
+	send_parameters(filter_length, direct_form);
+	BeamformerShaderKind kind = BeamformerShaderKind_Filter;
+	if (!direct_form && BETWEEN(filter_length, FILTER_FFT_MIN_TAPS, FILTER_FFT_MAX_TAPS))
+		kind = BeamformerShaderKind_FilterFFT;
+	f32 result = harness_average_stage_time(options, kind, data, data_size());
+	if (!g_should_exit && !beamformer_export_rf_data(output, (u32)output_size(), 1000))
+		die("failed to read back filter output: %s\n", beamformer_get_last_error_string());
+	return result;
+}
+
+/* NOTE(rnp): returns 0 if the FFT filter output did not match the direct form output */
+function b32
+run_studies(HarnessOptions *options, i16 *data, f32 *direct_output, f32 *fft_output)
+{
+	b32 result = 1;
+	for (iz i = 0; !g_should_exit && i < countof(filter_lengths); i++) {
+		i16 length = filter_lengths[i];
+		f32 direct = execute_study(options, length, 1, data, direct_output);
+		f32 fft    = execute_study(options, length, 0, data, fft_output);
+		if (!g_should_exit) {
+			f64 outputs = (f64)RF_TIME_SAMPLES * CHANNEL_COUNT * TRANSMIT_COUNT;
+			printf("filter %4d taps | direct: %8.3f [ms] (%7.1f MS/s) | fft: %8.3f [ms] (%7.1f MS/s)",
+			       length, direct * 1e3, outputs / direct / 1e6, fft * 1e3, outputs / fft / 1e6);
+			if (length < FILTER_FFT_MIN_TAPS) {
+				printf(" | fft path unused\n");
+			} else {
+				HarnessError error = harness_compare(direct_output, fft_output, output_size() / sizeof(f32));
+				b32 match = error.max_error <= MAX_ERROR_TOLERANCE && error.rms_error <= RMS_ERROR_TOLERANCE;
+				printf(" | error: max %.2e rms %.2e%s\n", error.max_error, error.rms_error,
+				       match ? "" : " (FAILED)");
+				result &= match;
+			}
+		}
+	}
+	return result;
+}
+
+extern i32
+main(i32 argc, char *argv[])
+{
+	HarnessOptions options = harness_init(argc, argv, 0, 0);
+
+	i16 *data = malloc(data_size());
+	if (!data) die("malloc\n");
+	for (uz i = 0; i < data_size() / sizeof(*data); i++)
+		data[i] = (i16)((i * 7919) & 0x7FF) - 0x400;
+
+	f32 *direct_output = malloc(output_size());
+	f32 *fft_output    = malloc(output_size());
+	if (!direct_output || !fft_output) die("malloc\n");
+
+	b32 passed = 1;
+	do { passed &= run_studies(&options, data, direct_output, fft_output); } while (options.loop && !g_should_exit);
+
+	beamformer_set_pipeline_flags(0);
+
+	return !passed;
+}
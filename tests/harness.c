@@ -0,0 +1,220 @@
+/* See LICENSE for license details. */
+
+/* NOTE(rnp): scaffolding shared by the benchmark programs in this directory. include it
+ * after the OS layer (directly or through ogl_beamformer_lib.c). programs which include
+ * the beamformer library also get helpers for pushing frames and reading stage times.
+ *
+ * every program accepts --loop and --warmup n; study specific options are described by
+ * a HarnessOption table passed to harness_init().
+ */
+
+#include <signal.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef struct {
+	char *name;
+	/* NOTE: 0 for a flag which stores a b32, otherwise the option stores a u32 */
+	char *argument;
+	char *help;
+	void *store;
+} HarnessOption;
+
+typedef struct {
+	b32 loop;
+	u32 warmup_count;
+} HarnessOptions;
+
+typedef struct {
+	f64 max_error;
+	f64 rms_error;
+} HarnessError;
+
+global b32 g_should_exit;
+
+#define die(...) die_((char *)__func__, __VA_ARGS__)
+function no_return void
+die_(char *function_name, char *format, ...)
+{
+	if (function_name)
+		fprintf(stderr, "%s: ", function_name);
+
+	va_list ap;
+
+	va_start(ap, format);
+	vfprintf(stderr, format, ap);
+	va_end(ap);
+
+	os_exit(1);
+}
+
+#if OS_LINUX
+
+function void os_init_timer(void) { }
+
+function f64
+os_get_time(void)
+{
+	f64 result = (f64)os_get_timer_counter() / (f64)os_get_timer_frequency();
+	return result;
+}
+
+#elif OS_WINDOWS
+
+global w32_context os_context;
+
+function void
+os_init_timer(void)
+{
+	os_context.timer_frequency = os_get_timer_frequency();
+}
+
+function f64
+os_get_time(void)
+{
+	f64 result = (f64)os_get_timer_counter() / (f64)os_context.timer_frequency;
+	return result;
+}
+
+#else
+#error Unsupported Platform
+#endif
+
+#define shift_n(v, c, n) v += n, c -= n
+#define shift(v, c)   shift_n(v, c, 1)
+#define unshift(v, c) shift_n(v, c, -1)
+
+function b32
+s8_equal(s8 a, s8 b)
+{
+	b32 result = a.len == b.len;
+	for (iz i = 0; result && i < a.len; i++)
+		result &= a.data[i] == b.data[i];
+	return result;
+}
+
+/* NOTE(rnp): error of test against reference. the maximum is relative to the peak
+ * magnitude of reference and the RMS is relative to the RMS of reference */
+function HarnessError
+harness_compare(f32 *restrict reference, f32 *restrict test, uz count)
+{
+	f64 peak = 0, reference_sum = 0, max_error = 0, error_sum = 0;
+	for (uz i = 0; i < count; i++) {
+		f64 value      = reference[i];
+		f64 error      = (f64)test[i] - value;
+		peak           = MAX(peak,      ABS(value));
+		max_error      = MAX(max_error, ABS(error));
+		reference_sum += value * value;
+		error_sum     += error * error;
+	}
+
+	HarnessError result;
+	result.max_error = peak          > 0 ? max_error / peak          : max_error;
+	result.rms_error = reference_sum > 0 ? error_sum / reference_sum : error_sum;
+	result.rms_error = sqrt_f32((f32)result.rms_error);
+	return result;
+}
+
+function no_return void
+harness_usage(char *argv0, HarnessOption *options, iz option_count)
+{
+	fprintf(stderr, "usage: %s [--loop] [--warmup n]", argv0);
+	for (iz i = 0; i < option_count; i++) {
+		if (options[i].argument) fprintf(stderr, " [%s %s]", options[i].name, options[i].argument);
+		else                     fprintf(stderr, " [%s]", options[i].name);
+	}
+	fprintf(stderr, "\n    --loop: repeat the study forever\n    --warmup: warmup with n runs\n");
+	for (iz i = 0; i < option_count; i++)
+		fprintf(stderr, "    %s: %s\n", options[i].name, options[i].help);
+	os_exit(1);
+}
+
+function void
+sigint(i32 _signo)
+{
+	g_should_exit = 1;
+}
+
+/* NOTE(rnp): parses argv into the common options and the study specific option table,
+ * exits with usage on anything unrecognized, then starts the timer and installs the
+ * SIGINT handler which requests a clean exit */
+function HarnessOptions
+harness_init(i32 argc, char *argv[], HarnessOption *options, iz option_count)
+{
+	HarnessOptions result = {0};
+
+	char *argv0 = argv[0];
+	shift(argv, argc);
+
+	while (argc > 0) {
+		s8 arg = c_str_to_s8(*argv);
+		shift(argv, argc);
+
+		b32 matched = 0;
+		if (s8_equal(arg, s8("--loop"))) {
+			result.loop = matched = 1;
+		} else if (s8_equal(arg, s8("--warmup"))) {
+			if (!argc) harness_usage(argv0, options, option_count);
+			result.warmup_count = (u32)atoi(*argv);
+			shift(argv, argc);
+			matched = 1;
+		}
+
+		for (iz i = 0; !matched && i < option_count; i++) {
+			if (s8_equal(arg, c_str_to_s8(options[i].name))) {
+				if (options[i].argument) {
+					if (!argc) harness_usage(argv0, options, option_count);
+					*(u32 *)options[i].store = (u32)atoi(*argv);
+					shift(argv, argc);
+				} else {
+					*(b32 *)options[i].store = 1;
+				}
+				matched = 1;
+			}
+		}
+
+		if (!matched) harness_usage(argv0, options, option_count);
+	}
+
+	os_init_timer();
+	signal(SIGINT, sigint);
+
+	return result;
+}
+
+#if defined(LIB_FN)
+
+#define AVERAGE_SAMPLES countof(((BeamformerComputeStatsTable *)0)->times)
+
+function b32
+send_frame(i16 *restrict i16_data, uz data_size)
+{
+	b32 result = 0;
+	if (beamformer_wait_for_compute_dispatch(10000))
+		result = beamformer_push_data_with_compute(i16_data, (u32)data_size, BeamformerViewPlaneTag_XZ);
+	if (!result && !g_should_exit) printf("lib error: %s\n", beamformer_get_last_error_string());
+	return result;
+}
+
+/* NOTE(rnp): pushes the warmup frames followed by a full table of timed frames using the
+ * currently configured pipeline and returns the average GPU time of the stage in seconds */
+function f32
+harness_average_stage_time(HarnessOptions *options, BeamformerShaderKind kind, i16 *restrict data, uz size)
+{
+	for (u32 i = 0; !g_should_exit && i < options->warmup_count; i++)
+		send_frame(data, size);
+
+	for (u32 i = 0; !g_should_exit && i < AVERAGE_SAMPLES; i++)
+		send_frame(data, size);
+
+	f32 result = 0;
+	BeamformerComputeStatsTable stats = {0};
+	if (!g_should_exit && beamformer_compute_timings(&stats, 1000)) {
+		for (u32 i = 0; i < AVERAGE_SAMPLES; i++)
+			result += stats.times[i][kind] / (f32)AVERAGE_SAMPLES;
+	}
+	return result;
+}
+
+#endif /* LIB_FN */
@@ -0,0 +1,105 @@
+/* See LICENSE for license details. */
+
+/* NOTE(rnp): minimal fork/join pool for CPU side processing. a job is split into
+ * independent items which are claimed by the pool threads; the thread which runs the job
+ * participates and returns once every item has completed. each thread owns a scratch
+ * arena which is reset for every item. requires the OS layer to be included first. */
+
+#define THREAD_POOL_MAX_THREADS 64
+
+#define THREAD_POOL_JOB_FN(name) void name(void *user_context, Arena scratch, u32 item)
+typedef THREAD_POOL_JOB_FN(thread_pool_job_fn);
+
+typedef struct ThreadPool ThreadPool;
+
+typedef struct {
+	ThreadPool *pool;
+	Arena       scratch;
+} ThreadPoolThread;
+
+struct ThreadPool {
+	ThreadPoolThread threads[THREAD_POOL_MAX_THREADS];
+	u32              thread_count;
+	u32              sync_variable;
+
+	/* NOTE: claims are (job_id << 32 | item). a claim is only valid when its
+	 * job_id matches the current job and item is less than job_items */
+	u64                 job_claim;
+	u32                 job_id;
+	u32                 job_items;
+	u32                 job_items_done;
+	thread_pool_job_fn *job;
+	void               *job_context;
+};
+
+function b32
+thread_pool_work(ThreadPoolThread *thread)
+{
+	ThreadPool *pool = thread->pool;
+	b32 result = 0;
+	for (;;) {
+		u64 claim = atomic_add_u64(&pool->job_claim, 1);
+		u32 item  = (u32)claim;
+		if ((u32)(claim >> 32) != atomic_load_u32(&pool->job_id) || item >= pool->job_items)
+			break;
+		pool->job(pool->job_context, thread->scratch, item);
+		atomic_add_u32(&pool->job_items_done, 1);
+		result = 1;
+	}
+	return result;
+}
+
+function OS_THREAD_ENTRY_POINT_FN(thread_pool_entry_point)
+{
+	ThreadPoolThread *thread = (ThreadPoolThread *)_ctx;
+	ThreadPool       *pool   = thread->pool;
+	for (;;) {
+		/* NOTE(rnp): the pool clears the sync variable after publishing a job so any
+		 * job published after this store is seen by the following check */
+		atomic_store_u32(&pool->sync_variable, 1);
+		if (!thread_pool_work(thread))
+			os_wait_on_value((i32 *)&pool->sync_variable, 1, (u32)-1);
+	}
+	return 0;
+}
+
+/* NOTE(rnp): thread_count of 0 uses every available cpu */
+function void
+thread_pool_start(ThreadPool *pool, u32 thread_count, iz scratch_size, s8 name)
+{
+	if (thread_count == 0) thread_count = os_get_cpu_count();
+	pool->thread_count = MIN(thread_count, THREAD_POOL_MAX_THREADS);
+
+	Arena  arena       = os_alloc_arena(KB(4));
+	Stream thread_name = stream_alloc(&arena, 64);
+	stream_append_s8s(&thread_name, s8("["), name, s8("_"));
+	i32 name_widx = thread_name.widx;
+	for (u32 i = 0; i < pool->thread_count; i++) {
+		ThreadPoolThread *thread = pool->threads + i;
+		thread->pool    = pool;
+		thread->scratch = os_alloc_arena(scratch_size);
+		/* NOTE(rnp): thread 0 is whoever runs the job */
+		if (i > 0) {
+			stream_append_u64(&thread_name, i);
+			stream_append_s8s(&thread_name, s8("]"), s8("\0"));
+			os_create_thread(arena, (iptr)thread, stream_to_s8(&thread_name), thread_pool_entry_point);
+			stream_reset(&thread_name, name_widx);
+		}
+	}
+}
+
+function void
+thread_pool_run(ThreadPool *pool, thread_pool_job_fn *job, void *user_context, u32 items)
+{
+	pool->job            = job;
+	pool->job_context    = user_context;
+	pool->job_items      = items;
+	pool->job_items_done = 0;
+	u32 job_id = pool->job_id + 1;
+	atomic_store_u32(&pool->job_id, job_id);
+	atomic_store_u64(&pool->job_claim, (u64)job_id << 32);
+	os_wake_waiters((i32 *)&pool->sync_variable);
+
+	thread_pool_work(pool->threads + 0);
+	spin_wait(atomic_load_u32(&pool->job_items_done) != items);
+}
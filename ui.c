@@ -121,8 +121,10 @@ typedef struct {
 } RegionSplit;
 
 #define COMPUTE_STATS_VIEW_LIST \
-	X(Average, "Average") \
-	X(Bar,     "Bar")
+	X(Average,    "Average")    \
+	X(Bar,        "Bar")        \
+	X(Throughput, "Throughput") \
+	X(Latency,    "Latency")
 
 #define X(kind, ...) ComputeStatsViewKind_ ##kind,
 typedef enum {COMPUTE_STATS_VIEW_LIST ComputeStatsViewKind_Count} ComputeStatsViewKind;
@@ -202,11 +204,15 @@ typedef struct {
 	X(GM_OPEN_VIEW_RIGHT,   "Open View Right") \
 	X(GM_OPEN_VIEW_BELOW,   "Open View Below")
 
+#define COMPUTE_STATS_VIEW_BUTTONS \
+	X(CSV_RESET_LATENCY, "Reset Latency")
+
 #define X(id, text) UI_BID_ ##id,
 typedef enum {
 	UI_BID_VIEW_CLOSE,
 	GLOBAL_MENU_BUTTONS
 	FRAME_VIEW_BUTTONS
+	COMPUTE_STATS_VIEW_BUTTONS
 } UIButtonID;
 #undef X
 
@@ -1343,6 +1349,9 @@ add_compute_stats_view(BeamformerUI *ui, Variable *parent, Arena *arena, Beamfor
 	csv->compute_shader_stats = ctx->compute_shader_stats;
 	csv->cycler = add_variable_cycler(ui, menu, arena, 0, ui->small_font, s8("Stats View:"),
 	                                  &csv->kind, labels, countof(labels));
+	#define X(id, text) add_button(ui, menu, arena, s8(text), UI_BID_ ##id, 0, ui->small_font);
+	COMPUTE_STATS_VIEW_BUTTONS
+	#undef X
 	add_global_menu_to_group(ui, arena, menu);
 	return result;
 }
@@ -1415,7 +1424,11 @@ ui_beamformer_frame_view_copy_frame(BeamformerUI *ui, BeamformerFrameView *new,
 	mem_copy(new->frame, old->frame, sizeof(*new->frame));
 	new->frame->texture = 0;
 	new->frame->next    = 0;
-	alloc_beamform_frame(0, new->frame, old->frame->dim, s8("Frame Copy: "), ui->arena);
+	/* NOTE: the log compressed image stays with the original frame */
+	new->frame->compressed_texture = 0;
+	new->frame->compressed_dim     = (iv3){0};
+	new->frame->compressed_valid   = 0;
+	alloc_beamform_frame(0, new->frame, old->frame->dim, old->frame->format, s8("Frame Copy: "), ui->arena);
 
 	glCopyImageSubData(old->frame->texture, GL_TEXTURE_3D, 0, 0, 0, 0,
 	                   new->frame->texture, GL_TEXTURE_3D, 0, 0, 0, 0,
@@ -1615,14 +1628,29 @@ view_plane_tag_from_x_plane_shift(BeamformerFrameView *view, Variable *x_plane_s
 	return result;
 }
 
+/* NOTE(rnp): frames which went through the LogCompress stage with the same settings as
+ * the view are displayed directly from the compressed image */
+function void
+frame_view_bind_frame_texture(BeamformerFrameView *view, BeamformerFrame *frame, u32 program)
+{
+	u32 texture    = 0;
+	b32 compressed = 0;
+	if (frame) {
+		BeamformerLogCompressParameters *lp = &frame->compressed_parameters;
+		compressed = frame->compressed_valid && view->log_scale->bool32 &&
+		             f32_cmp(lp->dynamic_range, view->dynamic_range.real32) &&
+		             f32_cmp(lp->threshold,     view->threshold.real32)     &&
+		             f32_cmp(lp->gamma,         view->gamma.scaled_real32.val);
+		texture = compressed ? frame->compressed_texture : frame->texture;
+	}
+	glProgramUniform1ui(program, FRAME_VIEW_COMPRESSED_LOC, compressed);
+	glBindTextureUnit(0, texture);
+}
+
 function void
 render_single_xplane(BeamformerUI *ui, BeamformerFrameView *view, Variable *x_plane_shift,
                      u32 program, f32 rotation_turns, v3 translate, BeamformerViewPlaneTag tag)
 {
-	u32 texture = 0;
-	if (ui->latest_plane[tag])
-		texture = ui->latest_plane[tag]->texture;
-
 	v3 scale = beamformer_frame_view_plane_size(ui, view);
 	m4 model_transform = y_aligned_volume_transform(scale, translate, rotation_turns);
 
@@ -1630,7 +1658,7 @@ render_single_xplane(BeamformerUI *ui, BeamformerFrameView *view, Variable *x_pl
 	glProgramUniformMatrix4fv(program, FRAME_VIEW_MODEL_MATRIX_LOC, 1, 0, model_transform.E);
 	glProgramUniform4fv(program, FRAME_VIEW_BB_COLOUR_LOC, 1, colour.E);
 	glProgramUniform1ui(program, FRAME_VIEW_SOLID_BB_LOC, 0);
-	glBindTextureUnit(0, texture);
+	frame_view_bind_frame_texture(view, ui->latest_plane[tag], program);
 	glDrawElements(GL_TRIANGLES, ui->unit_cube_model.elements, GL_UNSIGNED_SHORT,
 	               (void *)ui->unit_cube_model.elements_offset);
 
@@ -1692,7 +1720,7 @@ render_2D_plane(BeamformerUI *ui, BeamformerFrameView *view, u32 program)
 	glProgramUniformMatrix4fv(program, FRAME_VIEW_PROJ_MATRIX_LOC,  1, 0, projection.E);
 
 	glProgramUniform1f(program, FRAME_VIEW_BB_FRACTION_LOC, 0);
-	glBindTextureUnit(0, view->frame->texture);
+	frame_view_bind_frame_texture(view, view->frame, program);
 	glDrawElements(GL_TRIANGLES, ui->unit_cube_model.elements, GL_UNSIGNED_SHORT,
 	               (void *)ui->unit_cube_model.elements_offset);
 }
@@ -2740,6 +2768,34 @@ push_table_memory_size_row(Table *table, Arena *arena, s8 label, u64 memory_size
 		cells[2].text = s8("[B/F]");
 }
 
+function void
+push_table_latency_rows(Table *table, Arena *arena, s8 label, BeamformerLatencyHistogram *h)
+{
+	TableCell *cells = table_push_row(table, arena, TRK_CELLS)->data;
+	Stream sb = arena_stream(*arena);
+	stream_append_u64(&sb, h->count);
+	cells[0].text = label;
+	cells[1].text = arena_stream_commit(arena, &sb);
+	cells[2].text = s8("[frames]");
+
+	push_table_time_row(table, arena, s8("  p50:"), h->p50);
+	push_table_time_row(table, arena, s8("  p90:"), h->p90);
+	push_table_time_row(table, arena, s8("  p99:"), h->p99);
+	push_table_time_row(table, arena, s8("  max:"), h->max);
+}
+
+function void
+push_table_rate_row(Table *table, Arena *arena, s8 label, f32 rate, s8 unit)
+{
+	assert(table->columns == 3);
+	TableCell *cells = table_push_row(table, arena, TRK_CELLS)->data;
+	Stream sb = arena_stream(*arena);
+	stream_append_f64_e(&sb, rate);
+	cells[0].text = label;
+	cells[1].text = arena_stream_commit(arena, &sb);
+	cells[2].text = unit;
+}
+
 function v2
 draw_compute_stats_view(BeamformerUI *ui, Arena arena, Variable *view, Rect r, v2 mouse)
 {
@@ -2775,6 +2831,30 @@ draw_compute_stats_view(BeamformerUI *ui, Arena arena, Variable *view, Rect r, v
 			                    stats->average_times[cp->shaders[i]]);
 		}
 	}break;
+	case ComputeStatsViewKind_Throughput:{
+		#define X(e, n, s, pn) [BeamformerShaderKind_##e] = s8_comp(pn ":"),
+		read_only local_persist s8 labels[BeamformerShaderKind_ComputeCount] = {COMPUTE_SHADERS_INTERNAL};
+		#undef X
+		for (i32 i = 0; i < stages; i++) {
+			BeamformerComputeStageMetrics *m = stats->table.metrics + cp->shaders[i];
+			TableCell *cells = table_push_row(table, &arena, TRK_CELLS)->data;
+			cells[0].text = labels[cp->shaders[i]];
+			#define X(name, pretty, unit) \
+				if (m->name > 0) push_table_rate_row(table, &arena, s8("  " pretty ":"), m->name, s8(unit));
+			BEAMFORMER_COMPUTE_STAGE_METRICS
+			#undef X
+		}
+	}break;
+	case ComputeStatsViewKind_Latency:{
+		#define X(e, n, s, pn) [BeamformerShaderKind_##e] = s8_comp(pn ":"),
+		read_only local_persist s8 labels[BeamformerShaderKind_ComputeCount] = {COMPUTE_SHADERS_INTERNAL};
+		#undef X
+		for (i32 i = 0; i < stages; i++) {
+			push_table_latency_rows(table, &arena, labels[cp->shaders[i]],
+			                        stats->table.latency + cp->shaders[i]);
+		}
+		push_table_latency_rows(table, &arena, s8("Compute Frame:"), &stats->table.frame_latency);
+	}break;
 	case ComputeStatsViewKind_Bar:{
 		result = draw_compute_stats_bar_view(ui, arena, stats, cp->shaders, stages, compute_time_sum,
 		                                     text_spec, r, mouse);
@@ -3479,6 +3559,10 @@ ui_button_interaction(BeamformerUI *ui, Variable *button)
 	case UI_BID_GM_OPEN_VIEW_BELOW:{
 		ui_add_live_frame_view(ui, button->parent->parent, RSD_VERTICAL, BeamformerFrameViewKind_Latest);
 	}break;
+	case UI_BID_CSV_RESET_LATENCY:{
+		BeamformerSharedMemory *sm = ui->shared_memory.region;
+		atomic_add_u32(&sm->compute_stats_reset_count, 1);
+	}break;
 	}
 }
 
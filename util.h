@@ -307,6 +307,9 @@ typedef OS_ADD_FILE_WATCH_FN(os_add_file_watch_fn);
 #define OS_WAKE_WORKER_FN(name) void name(GLWorkerThreadContext *ctx)
 typedef OS_WAKE_WORKER_FN(os_wake_worker_fn);
 
+#define OS_MAKE_DIRECTORY_FN(name) b32 name(char *path)
+typedef OS_MAKE_DIRECTORY_FN(os_make_directory_fn);
+
 #define OS_READ_WHOLE_FILE_FN(name) s8 name(Arena *arena, char *file)
 typedef OS_READ_WHOLE_FILE_FN(os_read_whole_file_fn);
 
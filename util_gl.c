@@ -1,4 +1,66 @@
 /* See LICENSE for license details. */
+#define PROGRAM_CACHE_DIRECTORY "shader_cache"
+
+typedef struct {
+	u64 key;
+	u32 format;
+	u32 size;
+} ProgramCacheHeader;
+
+function c8 *
+program_cache_path(Arena *arena, u64 key)
+{
+	Stream sb = arena_stream(*arena);
+	stream_append_s8(&sb, s8(PROGRAM_CACHE_DIRECTORY "/"));
+	stream_append_hex_u64(&sb, key);
+	stream_append_s8(&sb, s8(".bin"));
+	return (c8 *)arena_stream_commit_zero(arena, &sb).data;
+}
+
+/* NOTE(rnp): a key of 0 disables the cache. drivers are free to reject a binary at any
+ * time (e.g. after an update that didn't change the version string) so a failed load
+ * is not an error; the caller just falls back to compiling from source */
+function u32
+program_cache_load(Arena arena, u64 key)
+{
+	u32 result = 0;
+	if (key) {
+		s8 raw = os_read_whole_file(&arena, program_cache_path(&arena, key));
+		ProgramCacheHeader header;
+		if (raw.len > (iz)sizeof(header)) {
+			mem_copy(&header, raw.data, sizeof(header));
+			s8 binary = s8_cut_head(raw, sizeof(header));
+			if (header.key == key && header.size == binary.len) {
+				i32 success = 0;
+				result = glCreateProgram();
+				glProgramBinary(result, header.format, binary.data, (i32)binary.len);
+				glGetProgramiv(result, GL_LINK_STATUS, &success);
+				if (success == GL_FALSE) {
+					glDeleteProgram(result);
+					result = 0;
+				}
+			}
+		}
+	}
+	return result;
+}
+
+function void
+program_cache_store(Arena arena, u32 program, u64 key)
+{
+	i32 length = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (key && length > 0 && os_make_directory(PROGRAM_CACHE_DIRECTORY)) {
+		c8 *path = program_cache_path(&arena, key);
+		ProgramCacheHeader *header = push_struct(&arena, ProgramCacheHeader);
+		u8 *binary = push_array(&arena, u8, length);
+		glGetProgramBinary(program, length, &length, &header->format, binary);
+		header->key  = key;
+		header->size = (u32)length;
+		os_write_new_file(path, (s8){.len = (iz)sizeof(*header) + length, .data = (u8 *)header});
+	}
+}
+
 function u32
 compile_shader(OS *os, Arena a, u32 type, s8 shader, s8 name)
 {
@@ -33,6 +95,7 @@ link_program(OS *os, Arena a, u32 *shader_ids, i32 shader_id_count)
 	u32 result  = glCreateProgram();
 	for (i32 i = 0; i < shader_id_count; i++)
 		glAttachShader(result, shader_ids[i]);
+	glProgramParameteri(result, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
 	glLinkProgram(result);
 	glGetProgramiv(result, GL_LINK_STATUS, &success);
 	if (success == GL_FALSE) {
@@ -50,22 +113,27 @@ link_program(OS *os, Arena a, u32 *shader_ids, i32 shader_id_count)
 }
 
 function u32
-load_shader(OS *os, Arena arena, s8 *shader_texts, u32 *shader_types, i32 count, s8 name)
+load_shader(OS *os, Arena arena, s8 *shader_texts, u32 *shader_types, i32 count, s8 name, u64 cache_key)
 {
-	u32 result = 0;
-	u32 *ids   = push_array(&arena, u32, count);
-	b32 valid  = 1;
-	for (i32 i = 0; i < count; i++) {
-		ids[i]  = compile_shader(os, arena, shader_types[i], shader_texts[i], name);
-		valid  &= ids[i] != 0;
-	}
+	u32 result = program_cache_load(arena, cache_key);
+	b32 cached = result != 0;
+	if (!cached) {
+		u32 *ids  = push_array(&arena, u32, count);
+		b32 valid = 1;
+		for (i32 i = 0; i < count; i++) {
+			ids[i]  = compile_shader(os, arena, shader_types[i], shader_texts[i], name);
+			valid  &= ids[i] != 0;
+		}
 
-	if (valid) result = link_program(os, arena, ids, count);
-	for (i32 i = 0; i < count; i++) glDeleteShader(ids[i]);
+		if (valid) result = link_program(os, arena, ids, count);
+		for (i32 i = 0; i < count; i++) glDeleteShader(ids[i]);
+
+		if (result) program_cache_store(arena, result, cache_key);
+	}
 
 	if (result) {
 		Stream buf = arena_stream(arena);
-		stream_append_s8s(&buf, s8("loaded: "), name, s8("\n"));
+		stream_append_s8s(&buf, s8("loaded"), cached ? s8(" (cached): ") : s8(": "), name, s8("\n"));
 		os_write_file(os->error_handle, stream_to_s8(&buf));
 		LABEL_GL_OBJECT(GL_PROGRAM, result, name);
 	}